@@ -27,15 +27,71 @@
 #ifndef OPENVPN3_DBUS_CLIENT_BACKENDSIGNALS_HPP
 #define OPENVPN3_DBUS_CLIENT_BACKENDSIGNALS_HPP
 
+#include <atomic>
+#include <thread>
+
+/**
+ *  Sends the Log, StatusChange and AttentionRequired signals of a VPN
+ *  client backend.
+ *
+ *  All signals are sent from the thread which created this object, which
+ *  runs the GLib main loop.  Events reported from other threads, such as
+ *  the core VPN client thread, are pushed to a lock-free queue and sent
+ *  in batches from the main loop.  Events already queued are always sent
+ *  before any event reported by the main loop thread itself, so the
+ *  signal order is kept.
+ */
 class BackendSignals : public LogSender
 {
 public:
     BackendSignals(GDBusConnection *conn, LogGroup lgroup, std::string object_path)
-        : LogSender(conn, lgroup, OpenVPN3DBus_interf_backends, object_path)
+        : LogSender(conn, lgroup, OpenVPN3DBus_interf_backends, object_path),
+          last_major(0),
+          last_minor(0),
+          owner(std::this_thread::get_id()),
+          context(g_main_context_ref_thread_default()),
+          queue_head(nullptr)
     {
         SetLogLevel(default_log_level);
     }
 
+    virtual ~BackendSignals()
+    {
+        GSource *source = nullptr;
+        while ((source = g_main_context_find_source_by_user_data(context, this)))
+        {
+            g_source_destroy(source);
+        }
+        flush_events();
+        g_main_context_unref(context);
+    }
+
+
+    /**
+     * Sends a Log signal, or queues it if called outside the main loop
+     * thread
+     *
+     * @param group  LogGroup of the log message
+     * @param catg   LogCategory of the log message
+     * @param msg    The log message itself
+     */
+    void Log(const LogGroup group, const LogCategory catg, const std::string msg) override
+    {
+        if (!is_owner())
+        {
+            // Log messages the log level filters out anyway are not
+            // worth queuing
+            if (LogFilterAllow(catg))
+            {
+                push_event(new Event(Event::LOG, (guint) group, (guint) catg, msg));
+            }
+            return;
+        }
+        flush_events();
+        LogSender::Log(group, catg, msg);
+    }
+
+
     /**
      * Sends a FATAL log messages and kills itself
      *
@@ -43,6 +99,13 @@ public:
      */
     void LogFATAL(std::string msg)
     {
+        if (!is_owner())
+        {
+            // The process is stopped once the message has been sent
+            push_event(new Event(Event::FATAL, (guint) log_group,
+                                 (guint) LogCategory::FATAL, msg));
+            return;
+        }
         Log(log_group, LogCategory::FATAL, msg);
         kill(getpid(), SIGHUP);
     }
@@ -57,6 +120,13 @@ public:
      */
     void StatusChange(const StatusMajor major, const StatusMinor minor, std::string msg)
     {
+        if (!is_owner())
+        {
+            push_event(new Event(Event::STATUS, (guint) major, (guint) minor, msg));
+            return;
+        }
+        flush_events();
+
         last_major = (guint) major;
         last_minor = (guint) minor;
         last_msg = msg;
@@ -89,6 +159,14 @@ public:
                       const ClientAttentionGroup att_group,
                       std::string msg)
     {
+        if (!is_owner())
+        {
+            push_event(new Event(Event::ATTENTION, (guint) att_type,
+                                 (guint) att_group, msg));
+            return;
+        }
+        flush_events();
+
         GVariant *params = g_variant_new("(uus)", (guint) att_type, (guint) att_group, msg.c_str());
         Send("AttentionRequired", params);
     }
@@ -101,6 +179,10 @@ public:
      */
     GVariant * GetLastStatusChange()
     {
+        if (is_owner())
+        {
+            flush_events();
+        }
         if( last_msg.empty() && 0 == last_major && 0 == last_minor)
         {
             return NULL;  // Nothing have been logged, nothing to report
@@ -115,10 +197,136 @@ public:
 
 
 private:
+    /**
+     *  An event reported outside the main loop thread
+     */
+    struct Event
+    {
+        enum Type { LOG, FATAL, STATUS, ATTENTION };
+
+        Event(Type type, guint a, guint b, const std::string& msg)
+            : type(type), a(a), b(b), msg(msg), next(nullptr)
+        {
+        }
+
+        Type type;
+        guint a;
+        guint b;
+        std::string msg;
+        Event *next;
+    };
+
     const unsigned int default_log_level = 6; // LogCategory::DEBUG
     guint32 last_major;
     guint32 last_minor;
     std::string last_msg;
+    std::thread::id owner;
+    GMainContext *context;
+
+    /** Events not yet sent, the most recent first */
+    std::atomic<Event *> queue_head;
+
+
+    bool is_owner() const
+    {
+        return std::this_thread::get_id() == owner;
+    }
+
+
+    /**
+     *  Queues an event from any thread.  The main loop is only woken up
+     *  when the queue was empty, further events are picked up by the
+     *  same wake-up.
+     */
+    void push_event(Event *ev)
+    {
+        Event *head = queue_head.load(std::memory_order_relaxed);
+        do
+        {
+            ev->next = head;
+        } while (!queue_head.compare_exchange_weak(head, ev,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed));
+        if (nullptr != head)
+        {
+            return;
+        }
+
+        GSource *source = g_idle_source_new();
+        g_source_set_priority(source, G_PRIORITY_DEFAULT);
+        g_source_set_callback(source, drain_events, this, NULL);
+        g_source_attach(source, context);
+        g_source_unref(source);
+    }
+
+
+    /**
+     *  Sends all queued events, in the order they were reported.  Must
+     *  only be called from the main loop thread.
+     */
+    void flush_events()
+    {
+        Event *ev = queue_head.exchange(nullptr, std::memory_order_acquire);
+
+        // Restore the order the events were reported in
+        Event *ordered = nullptr;
+        while (ev)
+        {
+            Event *next = ev->next;
+            ev->next = ordered;
+            ordered = ev;
+            ev = next;
+        }
+
+        bool fatal = false;
+        while (ordered)
+        {
+            Event *next = ordered->next;
+            switch (ordered->type)
+            {
+            case Event::LOG:
+                LogSender::Log((LogGroup) ordered->a,
+                               (LogCategory) ordered->b, ordered->msg);
+                break;
+
+            case Event::FATAL:
+                LogSender::Log((LogGroup) ordered->a,
+                               (LogCategory) ordered->b, ordered->msg);
+                fatal = true;
+                break;
+
+            case Event::STATUS:
+                last_major = ordered->a;
+                last_minor = ordered->b;
+                last_msg = ordered->msg;
+                Send("StatusChange", g_variant_new("(uus)",
+                                                   last_major, last_minor,
+                                                   last_msg.c_str()));
+                break;
+
+            case Event::ATTENTION:
+                Send("AttentionRequired", g_variant_new("(uus)",
+                                                        ordered->a, ordered->b,
+                                                        ordered->msg.c_str()));
+                break;
+            }
+            delete ordered;
+            ordered = next;
+        }
+
+        if (fatal)
+        {
+            kill(getpid(), SIGHUP);
+        }
+    }
+
+
+    static gboolean drain_events(gpointer this_ptr)
+    {
+        BackendSignals *self = (BackendSignals *) this_ptr;
+        self->flush_events();
+        return G_SOURCE_REMOVE;
+    }
 };
 
 #endif  // OPENVPN3_DBUS_CLIENT_BACKENDSIGNALS_HPP
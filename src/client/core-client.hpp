@@ -166,7 +166,9 @@ private:
      *  Whenever an event occurs within the core library, this method is
      *  invoked as a kind of callback.  The provided information will be
      *  evaluated and sent further as D-Bus signals to the session manager
-     *  whenever appropriate.
+     *  whenever appropriate.  This runs in the core client thread, the
+     *  BackendSignals object queues the signals which are then sent from
+     *  the main loop.
      *
      * @param ev  A ClientAPI::Event object with the current event.
      */
@@ -24,18 +24,34 @@
  *         (net.openvpn.v3.backends).
  *
  *         This service starts openvpn3-service-client processes with a
- *         token provided via the StartClient D-Bus method call.  This
- *         service is supposed to be automatically started by D-Bus, with
- *         root privileges.  This ensures the client process this service
- *         starts also runs with the appropriate privileges.
+ *         token provided via the StartClient D-Bus method call.  The
+ *         processes are started with posix_spawn() and reaped from the
+ *         main loop, so concurrent StartClient calls do not wait on each
+ *         other.  This service is supposed to be automatically started
+ *         by D-Bus, with root privileges.  This ensures the client
+ *         process this service starts also runs with the appropriate
+ *         privileges.
+ *
+ *         With --sessions-per-host, each client process may host several
+ *         VPN sessions.  Such processes register themselves via the
+ *         RegisterHost method, and new sessions are added to them until
+ *         they are full before a new client process is started.
  */
 
 
+#include <csignal>
+#include <cstring>
 #include <iostream>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
 
 #include "config.h"
 #include "dbus/core.hpp"
+#include "dbus/connection-creds.hpp"
+#include "dbus/proxy.hpp"
 #include "log/dbus-log.hpp"
+#include "common/cmdargparser.hpp"
 #include "common/utils.hpp"
 
 using namespace openvpn;
@@ -129,14 +145,19 @@ public:
      *  Constructor initializing the Backend Starter to be registered on
      *  the D-Bus.
      *
-     * @param dbuscon  D-Bus this object is tied to
-     * @param busname  D-Bus bus name this service is registered on
-     * @param objpath  D-Bus object path to this object
+     * @param dbuscon            D-Bus this object is tied to
+     * @param busname            D-Bus bus name this service is registered on
+     * @param objpath            D-Bus object path to this object
+     * @param sessions_per_host  Number of VPN sessions each client process
+     *                           may host
      */
-    BackendStarterObject(GDBusConnection *dbuscon, const std::string busname, const std::string objpath)
+    BackendStarterObject(GDBusConnection *dbuscon, const std::string busname,
+                         const std::string objpath,
+                         unsigned int sessions_per_host = 1)
         : DBusObject(objpath),
           BackendStarterSignals(dbuscon, objpath),
-          dbuscon(dbuscon)
+          dbuscon(dbuscon),
+          sessions_per_host(sessions_per_host)
     {
         std::stringstream introspection_xml;
         introspection_xml << "<node name='" << objpath << "'>"
@@ -145,8 +166,13 @@ public:
                           << "          <arg type='s' name='token' direction='in'/>"
                           << "          <arg type='u' name='pid' direction='out'/>"
                           << "        </method>"
+                          << "        <method name='KillClient'>"
+                          << "          <arg type='s' name='busname' direction='in'/>"
+                          << "        </method>"
+                          << "        <method name='RegisterHost'/>"
                           << GetLogIntrospection()
                           << "    </interface>"
+                          << DBusMethodStats::GetIntrospection()
                           << "</node>";
         ParseIntrospectionXML(introspection_xml);
 
@@ -156,6 +182,10 @@ public:
     ~BackendStarterObject()
     {
         LogInfo("Shutting down");
+        for (auto& host : hosts)
+        {
+            g_bus_unwatch_name(host.watch);
+        }
         RemoveObject(dbuscon);
     }
 
@@ -199,18 +229,48 @@ public:
 
             // Retrieve the configuration path for the tunnel
             // from the request
-            gchar *token;
+            gchar *token = nullptr;
             g_variant_get (params, "(s)", &token);
-            pid_t backend_pid = start_backend_process(token);
-            if (-1 == backend_pid)
+            std::string tok(token);
+            g_free(token);
+
+            if (sessions_per_host > 1)
+            {
+                start_hosted(invoc, tok, 0);
+            }
+            else
+            {
+                start_client(invoc, tok);
+            }
+        }
+        else if ("KillClient" == method_name)
+        {
+            gchar *busname = nullptr;
+            g_variant_get (params, "(s)", &busname);
+            std::string errmsg = kill_backend_process(busname);
+            g_free(busname);
+            if (!errmsg.empty())
+            {
+                GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                              errmsg.c_str());
+                g_dbus_method_invocation_return_gerror(invoc, err);
+                g_error_free(err);
+                return;
+            }
+            g_dbus_method_invocation_return_value(invoc, NULL);
+        }
+        else if ("RegisterHost" == method_name)
+        {
+            std::string errmsg = register_host(sender);
+            if (!errmsg.empty())
             {
                 GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
-                                                              "Backend client process died");
+                                                              errmsg.c_str());
                 g_dbus_method_invocation_return_gerror(invoc, err);
                 g_error_free(err);
                 return;
             }
-            g_dbus_method_invocation_return_value(invoc, g_variant_new("(u)", backend_pid));
+            g_dbus_method_invocation_return_value(invoc, NULL);
         }
     };
 
@@ -288,57 +348,346 @@ public:
 
 
 private:
+    /**
+     *  A client process hosting several VPN sessions
+     */
+    struct BackendHost
+    {
+        std::string busname;
+        guint watch;
+    };
+
     GDBusConnection *dbuscon;
+    unsigned int sessions_per_host;
+    std::vector<BackendHost> hosts;
 
 
     /**
-     * Forks out a child thread which starts the openvpn3-service-client
-     * process with the provided backend start token.
+     *  A StartClient call waiting for the started client process to
+     *  fork into the background
+     */
+    struct PendingStart
+    {
+        BackendStarterObject *self;
+        GDBusMethodInvocation *invoc;
+        pid_t pid;
+    };
+
+
+    /**
+     *  A StartClient call waiting for a client process hosting several
+     *  sessions to add the new session
+     */
+    struct PendingHostedStart
+    {
+        BackendStarterObject *self;
+        GDBusMethodInvocation *invoc;
+        std::string token;
+        std::string busname;
+    };
+
+
+    /**
+     *  Starts a new client process for a StartClient call.  The call is
+     *  replied to once the process has forked into the background,
+     *  without blocking other callers.
      *
-     * @param token  String containing the start token identifying the session
-     *               object this process is tied to.
-     * @return Returns the process ID (pid) of the child process.
+     * @param invoc  GDBusMethodInvocation of the StartClient call
+     * @param token  Start token of the session
      */
-    pid_t start_backend_process(char * token)
+    void start_client(GDBusMethodInvocation *invoc, const std::string& token)
+    {
+        std::string errmsg;
+        pid_t backend_pid = start_backend_process(token, errmsg);
+        if (-1 == backend_pid)
+        {
+            LogError("Failed to start backend client process: " + errmsg);
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                          "Backend client process died");
+            g_dbus_method_invocation_return_gerror(invoc, err);
+            g_error_free(err);
+            return;
+        }
+
+        IdleCheck_RefInc();
+        g_child_watch_add_full(G_PRIORITY_DEFAULT, backend_pid,
+                               backend_process_exited,
+                               new PendingStart{this, invoc, backend_pid},
+                               pending_start_free);
+    }
+
+
+    /**
+     *  Adds a session to the first registered client process with room
+     *  for it, trying each host in turn.  A new client process is started
+     *  when all hosts are full.
+     *
+     * @param invoc  GDBusMethodInvocation of the StartClient call
+     * @param token  Start token of the session
+     * @param idx    Index of the first host to try
+     */
+    void start_hosted(GDBusMethodInvocation *invoc, const std::string& token,
+                      size_t idx)
+    {
+        if (idx >= hosts.size())
+        {
+            start_client(invoc, token);
+            return;
+        }
+
+        PendingHostedStart *start = new PendingHostedStart{this, invoc, token,
+                                                           hosts[idx].busname};
+        IdleCheck_RefInc();
+        try
+        {
+            DBusProxy host(dbuscon, start->busname,
+                           OpenVPN3DBus_interf_backends_manager,
+                           OpenVPN3DBus_rootp_backends_manager);
+            host.CallAsync("AddSession", g_variant_new("(s)", token.c_str()),
+                           [start, idx](GVariant *response, GError *error)
+                           {
+                               start->self->hosted_start_done(start, idx,
+                                                              response, error);
+                           });
+        }
+        catch (DBusException& excp)
+        {
+            hosted_start_done(start, idx, nullptr, nullptr);
+        }
+    }
+
+
+    /**
+     *  Completes an AddSession call to a host.  On failures, the next
+     *  host is tried.
+     */
+    void hosted_start_done(PendingHostedStart *start, size_t idx,
+                           GVariant *response, GError *error)
+    {
+        if (response && !error)
+        {
+            guint pid = 0;
+            g_variant_get(response, "(u)", &pid);
+            g_dbus_method_invocation_return_value(start->invoc,
+                                                  g_variant_new("(u)", pid));
+        }
+        else
+        {
+            // The host list may have changed while waiting
+            size_t next = idx;
+            while (next < hosts.size() && hosts[next].busname != start->busname)
+            {
+                next++;
+            }
+            start_hosted(start->invoc, start->token,
+                         (next < hosts.size() ? next + 1 : idx));
+        }
+        delete start;
+        IdleCheck_RefDec();
+    }
+
+
+    /**
+     *  Registers a client process which hosts several VPN sessions.  The
+     *  host is used until its bus name disappears, and keeps this service
+     *  running meanwhile.
+     *
+     * @param sender  D-Bus unique bus name of the client process
+     * @return Returns an empty string on success, otherwise an error message
+     */
+    std::string register_host(const std::string& sender)
+    {
+        if (sessions_per_host < 2)
+        {
+            return "Backend hosts are not enabled";
+        }
+        try
+        {
+            DBusConnectionCreds creds(dbuscon);
+            if (0 != creds.GetUID(sender))
+            {
+                return "Access denied";
+            }
+        }
+        catch (DBusException& excp)
+        {
+            return "Access denied";
+        }
+
+        for (const auto& host : hosts)
+        {
+            if (host.busname == sender)
+            {
+                return "";
+            }
+        }
+
+        BackendHost host;
+        host.busname = sender;
+        host.watch = g_bus_watch_name_on_connection(dbuscon, sender.c_str(),
+                                                    G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                    NULL, host_vanished,
+                                                    this, NULL);
+        hosts.push_back(host);
+        IdleCheck_RefInc();
+        LogVerb1("Registered backend host " + sender);
+        return "";
+    }
+
+
+    static void host_vanished(GDBusConnection *conn, const gchar *name,
+                              gpointer this_ptr)
     {
-        pid_t backend_pid = fork();
-        if (0 == backend_pid)
+        BackendStarterObject *self = (BackendStarterObject *) this_ptr;
+        for (auto it = self->hosts.begin(); it != self->hosts.end(); ++it)
         {
-            // Child
-            char * const client_args[] = {
+            if (it->busname == name)
+            {
+                g_bus_unwatch_name(it->watch);
+                self->hosts.erase(it);
+                self->IdleCheck_RefDec();
+                break;
+            }
+        }
+    }
+
+
+    /**
+     *  Starts the openvpn3-service-client process with the provided backend
+     *  start token.  The process is spawned without duplicating this
+     *  service via fork(), and this call does not wait for it.  When
+     *  sessions_per_host is above 1, the process is started as a host for
+     *  that many sessions.
+     *
+     * @param token   String containing the start token identifying the
+     *                session object this process is tied to.
+     * @param errmsg  std::string where the reason is stored on failures
+     *
+     * @return Returns the process ID (pid) of the child process, or -1 if
+     *         it could not be started.
+     */
+    pid_t start_backend_process(const std::string& token, std::string& errmsg)
+    {
+        std::string max_sessions = std::to_string(sessions_per_host);
+        std::vector<char *> client_args = {
 #ifdef DEBUG_VALGRIND
-                (char *) "/usr/bin/valgrind",
-                (char *) "--log-file=/tmp/valgrind.log",
+            (char *) "/usr/bin/valgrind",
+            (char *) "--log-file=/tmp/valgrind.log",
 #endif
-                (char *) LIBEXEC_PATH "/openvpn3-service-client",
-                token,
-                NULL };
-            execve(client_args[0], client_args, NULL);
-
-            // If execve() succeedes, the line below will not be executed at all.
-            // So if we come here, there must be an error.
-            std::cerr << "** Error starting " << client_args[0] << ": " << strerror(errno) << std::endl;
+            (char *) LIBEXEC_PATH "/openvpn3-service-client"
+        };
+        if (sessions_per_host > 1)
+        {
+            client_args.push_back((char *) "--host");
+            client_args.push_back((char *) max_sessions.c_str());
         }
-        else if( backend_pid > 0)
+        client_args.push_back((char *) token.c_str());
+        client_args.push_back(NULL);
+        char * const client_env[] = { NULL };
+
+        // The client must not inherit the signal handling of this service
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t sigs;
+        sigemptyset(&sigs);
+        posix_spawnattr_setsigmask(&attr, &sigs);
+        sigfillset(&sigs);
+        posix_spawnattr_setsigdefault(&attr, &sigs);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK
+                                        | POSIX_SPAWN_SETSIGDEF);
+
+        pid_t backend_pid = -1;
+        int r = posix_spawn(&backend_pid, client_args[0], NULL, &attr,
+                            client_args.data(), client_env);
+        posix_spawnattr_destroy(&attr);
+        if (0 != r)
         {
-            // Parent
+            errmsg = "Error starting " + std::string(client_args[0])
+                     + ": " + std::string(strerror(r));
+            return -1;
+        }
+        return backend_pid;
+    }
 
+
+    /**
+     *  Completes a StartClient call when the started client process
+     *  exits, which happens once it has forked the real backend process.
+     *  Called from the main loop, which has reaped the process.
+     */
+    static void backend_process_exited(GPid pid, gint status, gpointer data)
+    {
+        PendingStart *start = (PendingStart *) data;
+        BackendStarterObject *self = start->self;
+
+        if (WIFEXITED(status) && 0 == WEXITSTATUS(status))
+        {
+            g_dbus_method_invocation_return_value(start->invoc,
+                                                  g_variant_new("(u)", start->pid));
+        }
+        else
+        {
             std::stringstream msg;
-            // Wait for the child process to exit, as the client process will fork again
-            int rc = -1;
-            int w = waitpid(backend_pid, &rc, 0);
-            if (-1 == w)
-            {
-                msg << "Child process ("  << token
-                    << ") - pid " << backend_pid
-                    << " failed to start as expected (exit code: "
-                    << std::to_string(rc) << ")";
-                LogError(msg.str());
-                return -1;
-            }
-            return backend_pid;
+            msg << "Child process - pid " << start->pid
+                << " failed to start as expected (exit status: "
+                << std::to_string(status) << ")";
+            self->LogError(msg.str());
+
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                          "Backend client process died");
+            g_dbus_method_invocation_return_gerror(start->invoc, err);
+            g_error_free(err);
         }
-        throw std::runtime_error("Failed to fork() backend client process");
+        g_spawn_close_pid(pid);
+        self->IdleCheck_RefDec();
+    }
+
+
+    static void pending_start_free(gpointer data)
+    {
+        delete (PendingStart *) data;
+    }
+
+
+    /**
+     *  Kills a VPN client backend process which did not stop when the
+     *  session manager asked it to.  The process is looked up through the
+     *  bus name it owns, which must be a backend client bus name carrying
+     *  the PID of the same process.
+     *
+     * @param busname  D-Bus bus name of the backend client process
+     * @return Returns an empty string on success, otherwise an error message
+     */
+    std::string kill_backend_process(const std::string& busname)
+    {
+        if (0 != busname.find(OpenVPN3DBus_name_backends_be))
+        {
+            return "Not a VPN client backend bus name";
+        }
+
+        pid_t pid = -1;
+        try
+        {
+            DBusConnectionCreds creds(dbuscon);
+            pid = creds.GetPID(busname);
+        }
+        catch (DBusException& excp)
+        {
+            return "Backend client process not found";
+        }
+        if (pid <= 1
+            || busname != OpenVPN3DBus_name_backends_be + std::to_string(pid))
+        {
+            return "Backend client process not found";
+        }
+
+        if (0 != kill(pid, SIGKILL))
+        {
+            return "Could not kill the backend client process: "
+                   + std::string(strerror(errno));
+        }
+        LogInfo("Killed backend client process, pid " + std::to_string(pid));
+        return "";
     }
 };
 
@@ -352,18 +701,22 @@ public:
     /**
      * Constructor creating a D-Bus service for the Backend Starter service.
      *
-     * @param bus_type  GBusType, which defines if this service should be
-     *                  registered on the system or session bus.
+     * @param bus_type           GBusType, which defines if this service
+     *                           should be registered on the system or
+     *                           session bus.
+     * @param sessions_per_host  Number of VPN sessions each client process
+     *                           may host
      */
 
-    BackendStarterDBus(GBusType bus_type)
+    BackendStarterDBus(GBusType bus_type, unsigned int sessions_per_host = 1)
         : DBus(bus_type,
                OpenVPN3DBus_name_backends,
                OpenVPN3DBus_rootp_backends,
                OpenVPN3DBus_interf_backends),
           mainobj(nullptr),
           procsig(nullptr),
-          logfile("")
+          logfile(""),
+          sessions_per_host(sessions_per_host)
     {
     };
 
@@ -396,7 +749,7 @@ public:
     void callback_bus_acquired()
     {
         mainobj = new BackendStarterObject(GetConnection(), GetBusName(),
-                                            GetRootPath());
+                                            GetRootPath(), sessions_per_host);
         if (!logfile.empty())
         {
             mainobj->OpenLogFile(logfile);
@@ -449,13 +802,19 @@ private:
     BackendStarterObject * mainobj;
     ProcessSignalProducer * procsig;
     std::string logfile;
+    unsigned int sessions_per_host;
 };
 
 
 
-int main(int argc, char **argv)
+static int backend_starter(ParsedArgs args)
 {
-    std::cout << get_version(argv[0]) << std::endl;
+    unsigned int sessions_per_host = 1;
+    if (args.Present("sessions-per-host"))
+    {
+        int v = std::atoi(args.GetValue("sessions-per-host", 0).c_str());
+        sessions_per_host = (v > 1 ? v : 1);
+    }
 
     GMainLoop *main_loop = g_main_loop_new(NULL, FALSE);
     g_unix_signal_add(SIGINT, stop_handler, main_loop);
@@ -463,9 +822,8 @@ int main(int argc, char **argv)
 
     IdleCheck::Ptr idle_exit = new IdleCheck(main_loop,
                                              std::chrono::minutes(1));
-    idle_exit->SetPollTime(std::chrono::seconds(10));
 
-    BackendStarterDBus backstart(G_BUS_TYPE_SYSTEM);
+    BackendStarterDBus backstart(G_BUS_TYPE_SYSTEM, sessions_per_host);
     backstart.EnableIdleCheck(idle_exit);
     backstart.Setup();
 
@@ -473,7 +831,27 @@ int main(int argc, char **argv)
     g_main_loop_run(main_loop);
     g_main_loop_unref(main_loop);
     idle_exit->Disable();
-    idle_exit->Join();
 
     return 0;
 }
+
+
+int main(int argc, char **argv)
+{
+    SingleCommand argparser(argv[0], "OpenVPN 3 VPN Client starter",
+                            backend_starter);
+    argparser.AddOption("sessions-per-host", "COUNT", true,
+                        "Number of VPN sessions each VPN client process may "
+                        "host (Default: 1)");
+
+    try
+    {
+        std::cout << get_version(argv[0]) << std::endl;
+        return argparser.RunCommand(simple_basename(argv[0]), argc, argv);
+    }
+    catch (CommandException& excp)
+    {
+        std::cout << excp.what() << std::endl;
+        return 2;
+    }
+}
@@ -25,7 +25,10 @@
  *         This service is supposed to be started by the
  *         openvpn3-service-backendstart service.  One client service
  *         represents a single VPN tunnel and is managed only by the session
- *         manager service.  When starting, this service will signal the
+ *         manager service.  When started with --host, the process can
+ *         host several VPN tunnels, each with its own object path, which
+ *         the backend starter adds via the AddSession method.  When
+ *         starting, this service will signal the
  *         session manager about its presence and the session manager will
  *         respond with which configuration profile to use.  Once that is done
  *         the front-end instance (communicating with the session manager)
@@ -33,6 +36,7 @@
  *         connection.
  */
 
+#include <map>
 #include <sstream>
 
 #define SHUTDOWN_NOTIF_PROCESS_NAME "openvpn3-service-client"
@@ -40,6 +44,7 @@
 #include "common/utils.hpp"
 #include "configmgr/proxy-configmgr.hpp"
 #include "dbus/core.hpp"
+#include "dbus/connection-creds.hpp"
 #include "dbus/path.hpp"
 #include "log/dbus-log.hpp"
 #include "backend-signals.hpp"
@@ -81,33 +86,18 @@ public:
           registered(false),
           paused(false),
           vpnclient(nullptr),
-          client_thread(nullptr)
+          client_thread(nullptr),
+          last_stats(nullptr)
     {
         // Initialize the VPN Core
-        CoreVPNClient::init_process();
+        core_process_ref(true);
 
         signal.SetLogLevel(default_log_level);
 
         std::stringstream introspection_xml;
         introspection_xml << "<node name='" << objpath << "'>"
                           << "    <interface name='" << OpenVPN3DBus_interf_backends << "'>"
-                          << "        <method name='RegistrationConfirmation'>"
-                          << "            <arg type='s' name='token' direction='in'/>"
-                          << "            <arg type='o' name='config_path' direction='in'/>"
-                          << "            <arg type='b' name='response' direction='out'/>"
-                          << "        </method>"
-                          << "        <method name='Ping'>"
-                          << "            <arg type='b' name='alive' direction='out'/>"
-                          << "        </method>"
-                          << "        <method name='Ready'/>"
-                          << "        <method name='Connect'/>"
-                          << "        <method name='Pause'>"
-                          << "            <arg type='s' name='reason' direction='in'/>"
-                          << "        </method>"
-                          << "        <method name='Resume'/>"
-                          << "        <method name='Restart'/>"
-                          << "        <method name='Disconnect'/>"
-                          << "        <method name='ForceShutdown'/>"
+                          << method_table().GetIntrospection(OpenVPN3DBus_interf_backends)
                           << userinputq.IntrospectionMethods("UserInputQueueGetTypeGroup",
                                                              "UserInputQueueFetch",
                                                              "UserInputQueueCheck",
@@ -133,9 +123,12 @@ public:
         // Tell the session manager we are ready.  This
         // request will also carry the correct object path
         // in the response automatically, but the well-known
-        // bus name needs to be sent back.
-        signal.Debug("Sending RegistrationRequest('" + bus_name + "', '" + session_token + "') signal");
-        signal.Send(OpenVPN3DBus_name_sessions,
+        // bus name needs to be sent back.  On a private connection
+        // to the session manager, there is no bus name to send it to.
+        bool p2p = (NULL == g_dbus_connection_get_unique_name(conn));
+        signal.Debug("Sending RegistrationRequest('" + bus_name + "', '" + session_token + "') signal"
+                     + (p2p ? " over a private connection" : ""));
+        signal.Send((p2p ? "" : OpenVPN3DBus_name_sessions),
                     OpenVPN3DBus_interf_backends,
                     "RegistrationRequest",
                     g_variant_new("(ss)", bus_name.c_str(), session_token.c_str()));
@@ -144,7 +137,15 @@ public:
 
     ~BackendClientObject()
     {
-        CoreVPNClient::uninit_process();
+        if (0 != stats_timer)
+        {
+            g_source_remove(stats_timer);
+        }
+        if (last_stats)
+        {
+            g_variant_unref(last_stats);
+        }
+        core_process_ref(false);
     }
 
 
@@ -161,28 +162,37 @@ public:
     }
 
 
+    /**
+     *  Sets a handler which ends this session instead of stopping the
+     *  process, used when the process hosts several sessions.  The
+     *  handler is called from within a D-Bus method call on this object.
+     *
+     * @param handler  Function removing this session
+     */
+    void SetShutdownHandler(std::function<void()> handler)
+    {
+        shutdown_handler = handler;
+    }
+
+
     /**
      *  Callback method which is called each time a D-Bus method call occurs
-     *  on this BackendClientObject.
+     *  on this BackendClientObject.  The method call is passed on to the
+     *  handler registered in the method table.
      *
-     * @param conn        D-Bus connection where the method call occurred
-     * @param sender      D-Bus bus name of the sender of the method call
-     * @param obj_path    D-Bus object path of the target object.
-     * @param intf_name   D-Bus interface of the method call
-     * @param method_name D-Bus method name to be executed
-     * @param params      GVariant Glib2 object containing the arguments for
-     *                    the method call
-     * @param invoc       GDBusMethodInvocation where the response/result of
-     *                    the method call will be returned.
+     * @param call  DBusMethodCall with the method call arguments
+     *
+     * @return Returns false if the method is not found in the method table
      */
-    void callback_method_call(GDBusConnection *conn,
-                              const std::string sender,
-                              const std::string obj_path,
-                              const std::string intf_name,
-                              const std::string method_name,
-                              GVariant *params,
-                              GDBusMethodInvocation *invoc)
+    bool callback_method_dispatch(const DBusMethodCall& call)
     {
+        MethodTable::Handler handler = method_table().Lookup(call.intf_name,
+                                                             call.method_name);
+        if (nullptr == handler)
+        {
+            return false;
+        }
+
         // Ensure D-Bus method calls are serialized
         std::lock_guard<std::mutex> lg(guard);
 
@@ -206,309 +216,57 @@ public:
                 }
             }
 
-            if ("RegistrationConfirmation" == method_name)
-            {
-                // This is called by the session manager only, as an
-                // acknowledgement from the session manager that it has
-                // linked this client process to a valid session object which
-                // will be accessible for front-end users.
-                //
-                // With this call, we also get the D-Bus object path for the
-                // the VPN configuration profile to use.  This is used when
-                // retrieve the configuration profile from the configuration
-                // manager service through the fetch_configuration() call.
-                //
-                if (registered)
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject",
-                                        "Backend service is already registered");
-                }
-
-                gchar *token = NULL;
-                gchar *cfgpath = NULL;
-                g_variant_get (params, "(so)", &token, &cfgpath);
-
-                registered = (session_token == std::string(token));
-                configpath = std::string(cfgpath);
-
-                signal.Debug("Registration confirmation: "
-                             + std::string(token) + " == "
-                             + std::string(session_token) + " => "
-                             + (registered ? "true" : "false"));
-                if (registered)
-                {
-                    g_dbus_method_invocation_return_value(invoc,
-                                                          g_variant_new("(b)", (bool) registered));
-
-                    // Fetch the configuration from the config-manager.
-                    // Since the configuration may be set up for single-use
-                    // only, we must keep this config as long as we're running
-                    fetch_configuration();
-
-                    // Sets initial state, which also allows us to early
-                    // report back back if more data is required to be
-                    // sent by the front-end interface.
-                    initialize_client();
-                }
-                else
-                {
-                    GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.be-registration",
-                                                                  "Invalid registration token");
-                    g_dbus_method_invocation_return_gerror(invoc, err);
-                    g_error_free(err);
-                }
-                return;
-            }
-            else if ("Ping" == method_name)
-            {
-                // This is a more narrow Ping test than what the D-Bus
-                // infrastructure provides.  This is a ping response from this
-                // specific object.
-                //
-                // The Ping caller is expected to just receive true.
-                g_dbus_method_invocation_return_value(invoc, g_variant_new("(b)", (bool) true));
-                return;
-            }
-            else if ("Ready" == method_name)
-            {
-                // This method should just exit without any result if everything is okay.
-                // If there are issues, return an error message
-                if (!userinputq.QueueAllDone())
-                {
-                    GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.ready",
-                                                                  "Missing user credentials");
-                    g_dbus_method_invocation_return_gerror(invoc, err);
-                    g_error_free(err);
-                }
-            }
-            else if ("Connect" == method_name)
-            {
-                // This starts the connection against a VPN server
-
-                if( !registered )
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
-                }
-
-                // This re-initializes the client object.  If we have already
-                // tried to connectbut got an AUTH_FAILED, either due to wrong
-                // credentials or a dynamic challenge from the server, we
-                // need to re-establish the vpnclient object.
-                initialize_client();
-
-                if (!userinputq.QueueAllDone())
-                {
-                    GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
-                                                                  "Required user input not provided");
-                    g_dbus_method_invocation_return_gerror(invoc, err);
-                    g_error_free(err);
-                    return;
-                }
-                signal.LogInfo("Starting connection: " + to_string(obj_path));
-                connect();
-            }
-            else if ("Disconnect" == method_name)
-            {
-                // Disconnect from the server.  This will also shutdown this
-                // process.
-
-                if (!registered || !vpnclient)
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
-                }
-
-                signal.LogInfo("Stopping connection: " + to_string(obj_path));
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_DISCONNECTING);
-                vpnclient->stop();
-                if (client_thread)
-                {
-                    client_thread->join();
-                }
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_DONE);
-
-                // Shutting down our selves.
-                RemoveObject(dbusconn);
-                if (mainloop)
-                {
-                    g_main_loop_quit(mainloop);
-                }
-                else
-                {
-                    kill(getpid(), SIGTERM);
-                }
-            }
-            else if ("UserInputQueueGetTypeGroup"  == method_name)
-            {
-                // Return an array of tuples of ClientAttentionTypes and
-                // ClientAttentionGroups which needs to be satisfied before
-                // we can attempt another reconnect.  This is all handled
-                // by the RequiresQueue.
-
-                try
-                {
-                    userinputq.QueueCheckTypeGroup(invoc);
-                }
-                catch (RequiresQueueException& excp)
-                {
-                    excp.GenerateDBusError(invoc);
-                }
-                return; // QueueCheckTypeGroup() have fed invoc with a result already
-            }
-            else if ("UserInputQueueFetch"  == method_name)
-            {
-                // Retrieves a specific RequiresQueue item which the front-end
-                // needs to satisfy.
-
-                try
-                {
-                    userinputq.QueueFetch(invoc, params);
-                }
-                catch (RequiresQueueException& excp)
-                {
-                    excp.GenerateDBusError(invoc);
-                }
-                return; // QueueFetch() have fed invoc with a result already
-            }
-            else if ("UserInputQueueCheck" == method_name)
-            {
-                // Retrieve the RequiresSlot IDs for a specific
-                // ClientAttentionType/ClientAttentionGroup which needs to be
-                // satisfied by the front-end.
-
-                userinputq.QueueCheck(invoc, params);
-                return; // QueueCheck() have fed invoc with a result already
-            }
-            else if ("UserInputProvide" == method_name)
-            {
-                // This is called each time a RequiresSlot gets an update
-                // with data from the front-end.
-
-                if (!registered)
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
-                }
-
-                if (userinputq.QueueDone(params))
-                {
-                    GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
-                                                                  "Credentials not needed");
-                    g_dbus_method_invocation_return_gerror(invoc, err);
-                    g_error_free(err);
-                    return;
-                }
-                userinputq.UpdateEntry(invoc, params);
-            }
-            else if ("Pause" == method_name)
-            {
-                // Pauses and suspends an on-going and connected VPN tunnel.
-                // The reason message provided with this call is sent to the
-                // log.
-
-                if( !registered || !vpnclient )
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
-                }
-
-                if (paused)
-                {
-                    GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
-                                                                  "Connection is already paused");
-                    g_dbus_method_invocation_return_gerror(invoc, err);
-                    g_error_free(err);
-                    return;
-                }
-
-                gchar *reason_str = NULL;
-                g_variant_get (params, "(s)", &reason_str);
-                std::string reason(reason_str);
-
-                signal.LogInfo("Pausing connection: " + to_string(obj_path));
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_PAUSING,
-                                    "Reason: " + reason);
-                vpnclient->pause(reason);
-                paused = true;
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_PAUSED);
-            }
-            else if ("Resume" == method_name)
-            {
-                // Resumes an already paused VPN session
-
-                if( !registered || !vpnclient )
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
-                }
-
-                if (!paused)
-                {
-                    GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
-                                                                  "Connection is not paused");
-                    g_dbus_method_invocation_return_gerror(invoc, err);
-                    g_error_free(err);
-                    return;
-                }
-
-                signal.LogInfo("Resuming connection: " + to_string(obj_path));
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_RESUMING);
-                vpnclient->resume();
-                paused = false;
-            }
-            else if ("Restart" == method_name)
-            {
-                // Does a complete re-connect for an already running VPN
-                // session.  This will reuse all the credentials already
-                // gathered.
-
-                if (!registered || !vpnclient)
-                {
-                    THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
-                }
-                signal.LogInfo("Restarting connection: " + to_string(obj_path));
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_RECONNECTING);
-                vpnclient->reconnect(0);
-            }
-            else if ("ForceShutdown" == method_name)
-            {
-                // This is an emergency break for this process.  This
-                // kills this process without considering if we are in
-                // an already running state.  This is primarily used to
-                // clean-up stray session objects which is considered dead
-                // by the session manager.
-
-                signal.LogInfo("Forcing shutdown of backend process: " + to_string(obj_path));
-                signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_DONE);
-
-                // Shutting down our selves.
-                RemoveObject(dbusconn);
-                if (mainloop)
-                {
-                    g_main_loop_quit(mainloop);
-                }
-                else
-                {
-                    kill(getpid(), SIGTERM);
-                }
-            }
-            else
-            {
-                throw std::invalid_argument("Not implemented method");
-            }
-            g_dbus_method_invocation_return_value(invoc, NULL);
+            (this->*handler)(call);
         }
         catch (const std::exception& excp)
         {
-            std::string errmsg = "Failed executing D-Bus call '" + method_name + "': " + excp.what();
+            std::string errmsg = "Failed executing D-Bus call '"
+                                 + std::string(call.method_name) + "': " + excp.what();
             GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.backend.error.standard",
                                                           errmsg.c_str());
-            g_dbus_method_invocation_return_gerror(invoc, err);
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
             g_error_free(err);
         }
         catch (...)
         {
             GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.backend.error.unspecified",
                                                           "Unknown error");
-            g_dbus_method_invocation_return_gerror(invoc, err);
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
             g_error_free(err);
         }
+        return true;
+    }
+
+
+    /**
+     *  Called for method calls not found in the method table.  GDBus
+     *  validates the method calls against the introspection data, so
+     *  this should normally not happen.
+     *
+     * @param conn        D-Bus connection where the method call occurred
+     * @param sender      D-Bus bus name of the sender of the method call
+     * @param obj_path    D-Bus object path of the target object.
+     * @param intf_name   D-Bus interface of the method call
+     * @param method_name D-Bus method name to be executed
+     * @param params      GVariant Glib2 object containing the arguments for
+     *                    the method call
+     * @param invoc       GDBusMethodInvocation where the response/result of
+     *                    the method call will be returned.
+     */
+    void callback_method_call(GDBusConnection *conn,
+                              const std::string sender,
+                              const std::string obj_path,
+                              const std::string intf_name,
+                              const std::string method_name,
+                              GVariant *params,
+                              GDBusMethodInvocation *invoc)
+    {
+        std::string errmsg = "Failed executing D-Bus call '" + method_name
+                             + "': Not implemented method";
+        GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.backend.error.standard",
+                                                      errmsg.c_str());
+        g_dbus_method_invocation_return_gerror(invoc, err);
+        g_error_free(err);
     }
 
     /**
@@ -541,18 +299,7 @@ public:
         {
             // Returns the current statistics for a running and connected
             // VPN session
-
-            // Returns an array of a string (description) and an int64
-            // containing the statistics value.
-            GVariantBuilder *b = g_variant_builder_new(G_VARIANT_TYPE("a{sx}"));
-            for (auto& sd : vpnclient->GetStats())
-            {
-                g_variant_builder_add (b, "{sx}",
-                                       sd.key.c_str(), sd.value);
-            }
-            GVariant *ret = g_variant_builder_end(b);
-            g_variant_builder_unref(b);
-            return ret;
+            return get_statistics();
         }
         else if ("status" == property_name)
         {
@@ -592,22 +339,599 @@ public:
     }
 
 
-private:
-    const unsigned int default_log_level = 6; // LogCategory::DEBUG messages
-    GDBusConnection *dbusconn;
-    GMainLoop *mainloop;
-    BackendSignals signal;
-    std::string session_token;
-    bool registered;
-    bool paused;
-    std::string configpath;
-    CoreVPNClient::Ptr vpnclient;
-    std::thread * client_thread;
-    ClientAPI::Config vpnconfig;
-    ClientAPI::EvalConfig cfgeval;
-    ClientAPI::ProvideCreds creds;
-    RequiresQueue userinputq;
-    std::mutex guard;
+private:
+    const unsigned int default_log_level = 6; // LogCategory::DEBUG messages
+    const unsigned int statistics_interval = 5; // seconds between statistics updates
+    GDBusConnection *dbusconn;
+    GMainLoop *mainloop;
+    BackendSignals signal;
+    std::string session_token;
+    bool registered;
+    bool paused;
+    std::string configpath;
+    CoreVPNClient::Ptr vpnclient;
+    std::thread * client_thread;
+    ClientAPI::Config vpnconfig;
+    ClientAPI::EvalConfig cfgeval;
+    ClientAPI::ProvideCreds creds;
+    RequiresQueue userinputq;
+    std::mutex guard;
+    guint stats_timer = 0;
+    GVariant *last_stats;
+    std::function<void()> shutdown_handler;
+    std::mutex thread_guard;
+    bool thread_running = false;
+    bool stop_on_thread_exit = false;
+
+
+    typedef DBusMethodTable<BackendClientObject> MethodTable;
+
+
+    /**
+     *  The D-Bus methods of a BackendClientObject with their handlers and
+     *  introspection data.  The handlers are called with the method call
+     *  serialization lock held; exceptions thrown are returned to the
+     *  caller as D-Bus errors by callback_method_dispatch().
+     */
+    static const MethodTable& method_table()
+    {
+        static const MethodTable table = build_method_table();
+        return table;
+    }
+
+
+    static MethodTable build_method_table()
+    {
+        const std::string intf(OpenVPN3DBus_interf_backends);
+        MethodTable table;
+        table.Add(intf, "RegistrationConfirmation",
+                  "            <arg type='s' name='token' direction='in'/>"
+                  "            <arg type='o' name='config_path' direction='in'/>"
+                  "            <arg type='b' name='response' direction='out'/>",
+                  &BackendClientObject::method_registration_confirmation)
+             .Add(intf, "Ping",
+                  "            <arg type='b' name='alive' direction='out'/>",
+                  &BackendClientObject::method_ping)
+             .Add(intf, "Ready", "", &BackendClientObject::method_ready)
+             .Add(intf, "Connect", "", &BackendClientObject::method_connect)
+             .Add(intf, "Pause",
+                  "            <arg type='s' name='reason' direction='in'/>",
+                  &BackendClientObject::method_pause)
+             .Add(intf, "Resume", "", &BackendClientObject::method_resume)
+             .Add(intf, "Restart", "", &BackendClientObject::method_restart)
+             .Add(intf, "Disconnect", "", &BackendClientObject::method_disconnect)
+             .Add(intf, "ForceShutdown", "", &BackendClientObject::method_force_shutdown);
+
+        // The introspection of these comes from RequiresQueue
+        table.Add(intf, "UserInputQueueGetTypeGroup",
+                  &BackendClientObject::method_user_input_get_type_group)
+             .Add(intf, "UserInputQueueFetch",
+                  &BackendClientObject::method_user_input_fetch)
+             .Add(intf, "UserInputQueueCheck",
+                  &BackendClientObject::method_user_input_check)
+             .Add(intf, "UserInputProvide",
+                  &BackendClientObject::method_user_input_provide);
+        return table;
+    }
+
+
+    /**
+     *  This is called by the session manager only, as an
+     *  acknowledgement from the session manager that it has
+     *  linked this client process to a valid session object which
+     *  will be accessible for front-end users.
+     *
+     *  With this call, we also get the D-Bus object path for the
+     *  the VPN configuration profile to use.  This is used when
+     *  retrieve the configuration profile from the configuration
+     *  manager service through the fetch_configuration() call.
+     */
+    void method_registration_confirmation(const DBusMethodCall& call)
+    {
+        if (registered)
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject",
+                                "Backend service is already registered");
+        }
+
+        gchar *token = NULL;
+        gchar *cfgpath = NULL;
+        g_variant_get (call.params, "(so)", &token, &cfgpath);
+
+        registered = (session_token == std::string(token));
+        configpath = std::string(cfgpath);
+
+        signal.Debug("Registration confirmation: "
+                     + std::string(token) + " == "
+                     + std::string(session_token) + " => "
+                     + (registered ? "true" : "false"));
+        g_free(token);
+        g_free(cfgpath);
+
+        if (!registered)
+        {
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.be-registration",
+                                                          "Invalid registration token");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return;
+        }
+
+        // From now on, only the session manager which
+        // registered this backend receives the Log,
+        // StatusChange and AttentionRequired signals.  It
+        // proxies them further to the front-ends and the
+        // log listeners registered with it.  On a private
+        // connection, there is no sender and the session
+        // manager is the only receiver anyway.
+        if (nullptr != call.sender && '\0' != call.sender[0])
+        {
+            signal.AddTargetBusName(call.sender);
+            signal.SetTargetedDelivery(true);
+        }
+        start_statistics_updates();
+
+        g_dbus_method_invocation_return_value(call.invoc,
+                                              g_variant_new("(b)", (bool) registered));
+
+        // Fetch the configuration from the config-manager.
+        // Since the configuration may be set up for single-use
+        // only, we must keep this config as long as we're running
+        fetch_configuration();
+
+        // Sets initial state, which also allows us to early
+        // report back back if more data is required to be
+        // sent by the front-end interface.
+        initialize_client();
+    }
+
+
+    /**
+     *  This is a more narrow Ping test than what the D-Bus
+     *  infrastructure provides.  This is a ping response from this
+     *  specific object.
+     *
+     *  The Ping caller is expected to just receive true.
+     */
+    void method_ping(const DBusMethodCall& call)
+    {
+        g_dbus_method_invocation_return_value(call.invoc, g_variant_new("(b)", (bool) true));
+    }
+
+
+    /**
+     *  This method should just exit without any result if everything is
+     *  okay.  If there are issues, return an error message
+     */
+    void method_ready(const DBusMethodCall& call)
+    {
+        if (!userinputq.QueueAllDone())
+        {
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.ready",
+                                                          "Missing user credentials");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return;
+        }
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  This starts the connection against a VPN server
+     */
+    void method_connect(const DBusMethodCall& call)
+    {
+        if( !registered )
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
+        }
+
+        // This re-initializes the client object.  If we have already
+        // tried to connectbut got an AUTH_FAILED, either due to wrong
+        // credentials or a dynamic challenge from the server, we
+        // need to re-establish the vpnclient object.
+        initialize_client();
+
+        if (!userinputq.QueueAllDone())
+        {
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                          "Required user input not provided");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return;
+        }
+        signal.LogInfo("Starting connection: " + std::string(call.obj_path));
+        connect();
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  Disconnect from the server.  This will also shutdown this
+     *  process.
+     */
+    void method_disconnect(const DBusMethodCall& call)
+    {
+        if (!registered || !vpnclient)
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
+        }
+
+        signal.LogInfo("Stopping connection: " + std::string(call.obj_path));
+        signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_DISCONNECTING);
+        stop_connection();
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  Return an array of tuples of ClientAttentionTypes and
+     *  ClientAttentionGroups which needs to be satisfied before
+     *  we can attempt another reconnect.  This is all handled
+     *  by the RequiresQueue.
+     */
+    void method_user_input_get_type_group(const DBusMethodCall& call)
+    {
+        try
+        {
+            userinputq.QueueCheckTypeGroup(call.invoc);
+        }
+        catch (RequiresQueueException& excp)
+        {
+            excp.GenerateDBusError(call.invoc);
+        }
+    }
+
+
+    /**
+     *  Retrieves a specific RequiresQueue item which the front-end
+     *  needs to satisfy.
+     */
+    void method_user_input_fetch(const DBusMethodCall& call)
+    {
+        try
+        {
+            userinputq.QueueFetch(call.invoc, call.params);
+        }
+        catch (RequiresQueueException& excp)
+        {
+            excp.GenerateDBusError(call.invoc);
+        }
+    }
+
+
+    /**
+     *  Retrieve the RequiresSlot IDs for a specific
+     *  ClientAttentionType/ClientAttentionGroup which needs to be
+     *  satisfied by the front-end.
+     */
+    void method_user_input_check(const DBusMethodCall& call)
+    {
+        userinputq.QueueCheck(call.invoc, call.params);
+    }
+
+
+    /**
+     *  This is called each time a RequiresSlot gets an update
+     *  with data from the front-end.
+     */
+    void method_user_input_provide(const DBusMethodCall& call)
+    {
+        if (!registered)
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
+        }
+
+        if (userinputq.QueueDone(call.params))
+        {
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                          "Credentials not needed");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return;
+        }
+        // UpdateEntry() feeds invoc with a result
+        userinputq.UpdateEntry(call.invoc, call.params);
+    }
+
+
+    /**
+     *  Pauses and suspends an on-going and connected VPN tunnel.
+     *  The reason message provided with this call is sent to the
+     *  log.
+     */
+    void method_pause(const DBusMethodCall& call)
+    {
+        if( !registered || !vpnclient )
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
+        }
+
+        if (paused)
+        {
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                          "Connection is already paused");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return;
+        }
+
+        gchar *reason_str = NULL;
+        g_variant_get (call.params, "(s)", &reason_str);
+        std::string reason(reason_str);
+        g_free(reason_str);
+
+        signal.LogInfo("Pausing connection: " + std::string(call.obj_path));
+        signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_PAUSING,
+                            "Reason: " + reason);
+        vpnclient->pause(reason);
+        paused = true;
+        signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_PAUSED);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  Resumes an already paused VPN session
+     */
+    void method_resume(const DBusMethodCall& call)
+    {
+        if( !registered || !vpnclient )
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
+        }
+
+        if (!paused)
+        {
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.error.backend",
+                                                          "Connection is not paused");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return;
+        }
+
+        signal.LogInfo("Resuming connection: " + std::string(call.obj_path));
+        signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_RESUMING);
+        vpnclient->resume();
+        paused = false;
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  Does a complete re-connect for an already running VPN
+     *  session.  This will reuse all the credentials already
+     *  gathered.
+     */
+    void method_restart(const DBusMethodCall& call)
+    {
+        if (!registered || !vpnclient)
+        {
+            THROW_DBUSEXCEPTION("BackendServiceObject", "Backend service is not initialized");
+        }
+        signal.LogInfo("Restarting connection: " + std::string(call.obj_path));
+        signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_RECONNECTING);
+        vpnclient->reconnect(0);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  This is an emergency break for this process.  This
+     *  kills this process without considering if we are in
+     *  an already running state.  This is primarily used to
+     *  clean-up stray session objects which is considered dead
+     *  by the session manager.
+     */
+    void method_force_shutdown(const DBusMethodCall& call)
+    {
+        signal.LogInfo("Forcing shutdown of backend process: " + std::string(call.obj_path));
+
+        // When other sessions are hosted by this process, the
+        // VPN client thread must be stopped as the process
+        // continues running
+        if (shutdown_handler)
+        {
+            stop_connection();
+        }
+        else
+        {
+            connection_stopped();
+        }
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  The VPN Core is initialized once per process and uninitialized
+     *  when the last session in the process is gone.
+     *
+     * @param acquire  Set to true when a session is created, false when
+     *                 it is destroyed
+     */
+    static void core_process_ref(bool acquire)
+    {
+        static std::mutex core_guard;
+        static unsigned int core_refs = 0;
+
+        std::lock_guard<std::mutex> lg(core_guard);
+        if (acquire)
+        {
+            if (0 == core_refs++)
+            {
+                CoreVPNClient::init_process();
+            }
+        }
+        else if (core_refs > 0 && 0 == --core_refs)
+        {
+            CoreVPNClient::uninit_process();
+        }
+    }
+
+
+    /**
+     *  Stops the VPN client thread and ends the session.  A process
+     *  running a single session waits for the client thread to stop.
+     *  A process hosting several sessions must not block its main loop;
+     *  the session is then ended from the main loop once the client
+     *  thread has stopped.
+     */
+    void stop_connection()
+    {
+        if (vpnclient)
+        {
+            vpnclient->stop();
+        }
+        if (shutdown_handler)
+        {
+            std::lock_guard<std::mutex> lg(thread_guard);
+            if (thread_running)
+            {
+                stop_on_thread_exit = true;
+                return;
+            }
+        }
+        if (client_thread && client_thread->joinable())
+        {
+            client_thread->join();
+        }
+        connection_stopped();
+    }
+
+
+    /**
+     *  Announces the VPN connection has stopped and ends the session
+     */
+    void connection_stopped()
+    {
+        signal.StatusChange(StatusMajor::CONNECTION, StatusMinor::CONN_DONE);
+
+        // Shutting down our selves.
+        shutdown_session();
+    }
+
+
+    /**
+     *  Ends the session from the main loop once the client thread has
+     *  stopped, when stop_connection() did not wait for it.
+     */
+    static gboolean connection_thread_stopped(gpointer data)
+    {
+        BackendClientObject *self = ((Ptr *) data)->get();
+        if (self->client_thread && self->client_thread->joinable())
+        {
+            // The thread function has already returned
+            self->client_thread->join();
+        }
+        self->connection_stopped();
+        return G_SOURCE_REMOVE;
+    }
+
+
+    static void ptr_free(gpointer data)
+    {
+        delete (Ptr *) data;
+    }
+
+
+    /**
+     *  Removes this object from the D-Bus and ends the session.  Unless
+     *  a shutdown handler has been set, the process is stopped.
+     */
+    void shutdown_session()
+    {
+        RemoveObject(dbusconn);
+        if (shutdown_handler)
+        {
+            shutdown_handler();
+        }
+        else if (mainloop)
+        {
+            g_main_loop_quit(mainloop);
+        }
+        else
+        {
+            kill(getpid(), SIGTERM);
+        }
+    }
+
+
+    /**
+     *  Retrieves the connection statistics of the VPN session
+     *
+     * @return Returns a GVariant array of a string (description) and an
+     *         int64 containing the statistics value.
+     */
+    GVariant * get_statistics()
+    {
+        GVariantBuilder *b = g_variant_builder_new(G_VARIANT_TYPE("a{sx}"));
+        for (auto& sd : vpnclient->GetStats())
+        {
+            g_variant_builder_add (b, "{sx}",
+                                   sd.key.c_str(), sd.value);
+        }
+        GVariant *ret = g_variant_builder_end(b);
+        g_variant_builder_unref(b);
+        return ret;
+    }
+
+
+    /**
+     *  Starts announcing the connection statistics periodically to the
+     *  session manager, which passes them on to the front-ends.
+     */
+    void start_statistics_updates()
+    {
+        if (0 == stats_timer)
+        {
+            stats_timer = g_timeout_add_seconds(statistics_interval,
+                                                _cb_statistics_update,
+                                                this);
+        }
+    }
+
+
+    /**
+     *  Sends a PropertiesChanged signal with the connection statistics to
+     *  the session manager, if they have changed since the last update.
+     *  This is limited to once every statistics_interval seconds.
+     */
+    static gboolean _cb_statistics_update(gpointer this_ptr)
+    {
+        BackendClientObject *obj = (BackendClientObject *) this_ptr;
+        std::lock_guard<std::mutex> lg(obj->guard);
+        if (!obj->registered || !obj->vpnclient)
+        {
+            return G_SOURCE_CONTINUE;
+        }
+
+        GVariant *stats = g_variant_ref_sink(obj->get_statistics());
+        if (obj->last_stats && g_variant_equal(obj->last_stats, stats))
+        {
+            g_variant_unref(stats);
+            return G_SOURCE_CONTINUE;
+        }
+        if (obj->last_stats)
+        {
+            g_variant_unref(obj->last_stats);
+        }
+        obj->last_stats = stats;
+
+        // Signals are only delivered to the session manager, see the
+        // RegistrationConfirmation method
+        try
+        {
+            obj->signal.SendPropertyChanged(OpenVPN3DBus_interf_backends,
+                                            "statistics", stats);
+        }
+        catch (DBusException& excp)
+        {
+            obj->signal.Debug("Failed to send statistics update: "
+                              + excp.getRawError());
+        }
+        return G_SOURCE_CONTINUE;
+    }
 
 
     /**
@@ -640,6 +964,14 @@ private:
         {
             signal.LogFATAL(excp.what());
         }
+
+        std::lock_guard<std::mutex> lg(thread_guard);
+        thread_running = false;
+        if (stop_on_thread_exit)
+        {
+            g_idle_add_full(G_PRIORITY_DEFAULT, connection_thread_stopped,
+                            new Ptr(this), ptr_free);
+        }
    }
 
 
@@ -718,6 +1050,10 @@ private:
             }
 
             // Start client thread
+            {
+                std::lock_guard<std::mutex> lg(thread_guard);
+                thread_running = true;
+            }
             client_thread = new std::thread([self=Ptr(this)]()
                                                 {
                                                     self->run_connection_thread();
@@ -840,9 +1176,152 @@ private:
 
 
 
+/**
+ *  Root object of a backend process, at a fixed object path.  It
+ *  provides the D-Bus method call statistics of the process.
+ *
+ *  When the process hosts several VPN sessions, the backend starter
+ *  adds new sessions to the process through this object, instead of
+ *  starting a new process for each session.
+ */
+class BackendHostObject : public DBusObject
+{
+public:
+    /**
+     *  Called to add a session to the process.  Throws a DBusException
+     *  if the session could not be added.
+     *
+     *  @param token  Session registration token
+     */
+    typedef std::function<void(const std::string& token)> AddSessionHandler;
+
+
+    /**
+     * @param conn     D-Bus connection this object is tied to
+     * @param handler  AddSessionHandler adding new sessions.  If not set,
+     *                 the process runs a single session and the AddSession
+     *                 method is not available.
+     */
+    BackendHostObject(GDBusConnection *conn, AddSessionHandler handler = nullptr)
+        : DBusObject(OpenVPN3DBus_rootp_backends_manager),
+          dbusconn(conn),
+          add_session(handler)
+    {
+        std::stringstream introspection_xml;
+        introspection_xml << "<node name='" << OpenVPN3DBus_rootp_backends_manager << "'>";
+        if (add_session)
+        {
+            introspection_xml << "    <interface name='" << OpenVPN3DBus_interf_backends_manager << "'>"
+                              << "        <method name='AddSession'>"
+                              << "            <arg type='s' name='token' direction='in'/>"
+                              << "            <arg type='u' name='pid' direction='out'/>"
+                              << "        </method>"
+                              << "    </interface>";
+        }
+        introspection_xml << DBusMethodStats::GetIntrospection()
+                          << "</node>";
+        ParseIntrospectionXML(introspection_xml);
+    }
+
+
+    /**
+     *  Callback method which is called each time a D-Bus method call occurs
+     *  on this BackendHostObject.  Only root, which the backend starter
+     *  runs as, may add sessions.
+     *
+     * @param conn        D-Bus connection where the method call occurred
+     * @param sender      D-Bus bus name of the sender of the method call
+     * @param obj_path    D-Bus object path of the target object.
+     * @param intf_name   D-Bus interface of the method call
+     * @param method_name D-Bus method name to be executed
+     * @param params      GVariant Glib2 object containing the arguments for
+     *                    the method call
+     * @param invoc       GDBusMethodInvocation where the response/result of
+     *                    the method call will be returned.
+     */
+    void callback_method_call(GDBusConnection *conn,
+                              const std::string sender,
+                              const std::string obj_path,
+                              const std::string intf_name,
+                              const std::string method_name,
+                              GVariant *params,
+                              GDBusMethodInvocation *invoc)
+    {
+        if ("AddSession" != method_name || !add_session)
+        {
+            g_dbus_method_invocation_return_dbus_error(invoc,
+                                                       "org.freedesktop.DBus.Error.UnknownMethod",
+                                                       "Unknown method");
+            return;
+        }
+
+        try
+        {
+            DBusConnectionCreds creds(dbusconn);
+            if (0 != creds.GetUID(sender))
+            {
+                THROW_DBUSEXCEPTION("BackendHostObject", "Access denied");
+            }
+
+            gchar *token = nullptr;
+            g_variant_get(params, "(s)", &token);
+            std::string tok(token);
+            g_free(token);
+
+            add_session(tok);
+            g_dbus_method_invocation_return_value(invoc,
+                                                  g_variant_new("(u)", (guint) getpid()));
+        }
+        catch (DBusException& excp)
+        {
+            g_dbus_method_invocation_return_dbus_error(invoc,
+                                                       "net.openvpn.v3.error.backend",
+                                                       excp.getRawError().c_str());
+        }
+    }
+
+
+    GVariant * callback_get_property(GDBusConnection *conn,
+                                     const std::string sender,
+                                     const std::string obj_path,
+                                     const std::string intf_name,
+                                     const std::string property_name,
+                                     GError **error)
+    {
+        g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Unknown property");
+        return NULL;
+    }
+
+
+    GVariantBuilder * callback_set_property(GDBusConnection *conn,
+                                            const std::string sender,
+                                            const std::string obj_path,
+                                            const std::string intf_name,
+                                            const std::string property_name,
+                                            GVariant *value,
+                                            GError **error)
+    {
+        THROW_DBUSEXCEPTION("BackendHostObject", "set property not implemented");
+    }
+
+
+private:
+    GDBusConnection *dbusconn;
+    AddSessionHandler add_session;
+};
+
+
+
 /**
  *  Main Backend Client D-Bus service.  This registers this client process
  *  as a separate and unique D-Bus service
+ *
+ *  Normally, the process runs a single VPN session and stops when the
+ *  session ends.  With a max_sessions value above 1, the process hosts up
+ *  to that many sessions, all sharing its D-Bus connection and bus name.
+ *  Each session has its own object path and VPN client thread.  The
+ *  process then registers with the backend starter, which adds sessions
+ *  via the BackendHostObject, and stops when its last session has ended.
  */
 class BackendClientDBus : public DBus
 {
@@ -850,31 +1329,40 @@ public:
     /**
      *  Initializes the BackendClientDBus object
      *
-     * @param start_pid  The PID value we were started with, used for logging
-     * @param bus_type   GBusType, which defines if this service should be
-     *                   registered on the system or session bus.
-     * @param sesstoken  String containing the session token provided via the
-     *                   command line.  This is used when signalling back
-     *                   to the session manager.
-     */
-    BackendClientDBus(pid_t start_pid, GBusType bus_type, std::string sesstoken)
+     * @param start_pid     The PID value we were started with, used for
+     *                      logging
+     * @param bus_type      GBusType, which defines if this service should be
+     *                      registered on the system or session bus.
+     * @param sesstoken     String containing the session token provided via
+     *                      the command line.  This is used when signalling
+     *                      back to the session manager.
+     * @param max_sessions  Maximum number of sessions this process hosts
+     */
+    BackendClientDBus(pid_t start_pid, GBusType bus_type, std::string sesstoken,
+                      unsigned int max_sessions = 1)
         : DBus(bus_type,
                OpenVPN3DBus_name_backends_be + to_string(getpid()),
                OpenVPN3DBus_rootp_sessions,
                OpenVPN3DBus_interf_sessions),
           start_pid(start_pid),
           session_token(sesstoken),
-          procsig(nullptr),
-          be_obj(nullptr),
-          signal(nullptr)
+          max_sessions(max_sessions),
+          mainloop(nullptr),
+          signal(nullptr),
+          backendstart_watch(0)
     {
     };
 
     ~BackendClientDBus()
     {
-        procsig->ProcessChange(StatusMinor::PROC_STOPPED);
-        delete procsig;
-        //delete be_obj;
+        if (0 != backendstart_watch)
+        {
+            g_bus_unwatch_name(backendstart_watch);
+        }
+        for (auto& sess : sessions)
+        {
+            close_session(sess.second);
+        }
     }
 
 
@@ -887,9 +1375,13 @@ public:
      */
     void SetMainLoop(GMainLoop *ml)
     {
-        if (be_obj)
+        mainloop = ml;
+        for (auto& sess : sessions)
         {
-            be_obj->SetMainLoop(ml);
+            if (sess.second.be_obj)
+            {
+                sess.second.be_obj->SetMainLoop(ml);
+            }
         }
     }
 
@@ -912,22 +1404,50 @@ public:
      */
     void callback_bus_acquired()
     {
-        // Create a new OpenVPN3 client session object
-        object_path = generate_path_uuid(OpenVPN3DBus_rootp_backends_sessions, 'z');
-        be_obj.reset(new BackendClientObject(GetConnection(), GetBusName(), object_path, session_token));
-        be_obj->RegisterObject(GetConnection());
-
-        // Setup a signal object of the backend
-        signal = new BackendSignals(GetConnection(), LogGroup::BACKENDPROC, object_path);
+        // Setup a signal object of the backend.  A process hosting
+        // several sessions logs on the path of the host object.
+        std::string first_path = add_session(session_token);
+        signal = new BackendSignals(GetConnection(), LogGroup::BACKENDPROC,
+                                    (max_sessions > 1
+                                     ? OpenVPN3DBus_rootp_backends_manager
+                                     : first_path));
         signal->SetLogLevel(default_log_level);
         signal->LogVerb2("Backend client process started as pid " + std::to_string(start_pid)
                          + " re-initiated as pid " + std::to_string(getpid()));
         signal->Debug("BackendClientDBus registered on '" + GetBusName()
-                       + "': " + object_path);
+                       + "': " + first_path);
 
-        procsig = new ProcessSignalProducer(GetConnection(), OpenVPN3DBus_interf_backends,
-                                            object_path, "VPN-Client");
-        procsig->ProcessChange(StatusMinor::PROC_STARTED);
+        if (max_sessions > 1)
+        {
+            host_obj.reset(new BackendHostObject(GetConnection(),
+                                                 [this](const std::string& token)
+                                                 {
+                                                     if (sessions.size() >= max_sessions)
+                                                     {
+                                                         THROW_DBUSEXCEPTION("BackendClientDBus",
+                                                                             "Backend host is full");
+                                                     }
+                                                     add_session(token);
+                                                 }));
+
+            // Register with the backend starter whenever it is running,
+            // also after it has been restarted
+            backendstart_watch = g_bus_watch_name_on_connection(GetConnection(),
+                                                                OpenVPN3DBus_name_backends.c_str(),
+                                                                G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                                backendstart_appeared,
+                                                                NULL,
+                                                                this,
+                                                                NULL);
+            signal->LogVerb1("Hosting up to " + std::to_string(max_sessions)
+                             + " VPN sessions");
+        }
+        else
+        {
+            // Only provides the method call statistics
+            host_obj.reset(new BackendHostObject(GetConnection()));
+        }
+        host_obj->RegisterObject(GetConnection());
     }
 
 
@@ -963,21 +1483,343 @@ public:
 
 
 private:
+    /**
+     *  A VPN session run by this process
+     */
+    struct ClientSession
+    {
+        std::string object_path;
+        GDBusConnection *p2p_conn;
+        BackendClientObject::Ptr be_obj;
+        ProcessSignalProducer *procsig;
+    };
+
     const unsigned int default_log_level = 6; // LogCategory::DEBUG messages
     pid_t start_pid;
     std::string session_token;
-    std::string object_path;
-    ProcessSignalProducer * procsig;
-    BackendClientObject::Ptr be_obj;
+    unsigned int max_sessions;
+    GMainLoop *mainloop;
+    std::map<std::string, ClientSession> sessions;
+    std::unique_ptr<BackendHostObject> host_obj;
     BackendSignals *signal;
+    guint backendstart_watch;
+
+
+    /**
+     *  A session added by add_session() while its connection to the
+     *  session manager is being set up
+     */
+    struct PendingSession
+    {
+        BackendClientDBus *self;
+        std::string path;
+        std::string token;
+        GDBusConnection *conn;
+        pid_t peer_pid;
+        std::string error;
+    };
+
+
+    /**
+     *  Adds a new VPN session, which registers with the session manager
+     *  using the given token.  The private connection to the session
+     *  manager is set up asynchronously, as other sessions hosted by this
+     *  process must not be blocked.  The session object is created once
+     *  that has completed.
+     *
+     * @param token  Session registration token
+     *
+     * @return Returns the D-Bus object path of the new session
+     */
+    std::string add_session(const std::string& token)
+    {
+        ClientSession sess;
+        sess.object_path = generate_path_uuid(OpenVPN3DBus_rootp_backends_sessions, 'z');
+        sess.p2p_conn = nullptr;
+        sess.procsig = nullptr;
+        sessions[sess.object_path] = sess;
+
+        // The session manager is preferably reached over a private
+        // connection, otherwise the bus is used
+        PendingSession *ps = new PendingSession{this, sess.object_path, token,
+                                                nullptr, -1, ""};
+        g_dbus_connection_new_for_address(OpenVPN3DBus_p2p_sessions.c_str(),
+                                          G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT,
+                                          NULL,  // GDBusAuthObserver
+                                          NULL,  // GCancellable
+                                          p2p_connected,
+                                          ps);
+        return sess.object_path;
+    }
+
+
+    /**
+     *  Creates the session object of a session added by add_session(),
+     *  once the connection to the session manager has been settled.
+     *
+     * @param ps  PendingSession of the session.  The private connection
+     *            it carries, if any, is taken over.
+     */
+    void start_session(PendingSession *ps)
+    {
+        auto it = sessions.find(ps->path);
+        if (sessions.end() == it)
+        {
+            close_p2p(ps->conn);
+            return;
+        }
+
+        ClientSession& sess = it->second;
+        sess.p2p_conn = ps->conn;
+        // The signals of the session are only seen by the session manager
+        // on a private connection.  Log listeners, like
+        // openvpn3-service-logger --vpn-backend, get them from the
+        // session manager.
+        GDBusConnection *be_conn = (sess.p2p_conn ? sess.p2p_conn : GetConnection());
+        if (!sess.p2p_conn && signal)
+        {
+            signal->Debug("No private connection to the session manager: "
+                          + ps->error);
+        }
+
+        try
+        {
+            sess.be_obj.reset(new BackendClientObject(be_conn, GetBusName(),
+                                                      sess.object_path, ps->token));
+            sess.be_obj->RegisterObject(be_conn);
+            sess.be_obj->SetMainLoop(mainloop);
+            if (max_sessions > 1)
+            {
+                std::string path = sess.object_path;
+                sess.be_obj->SetShutdownHandler([this, path]()
+                                                {
+                                                    remove_session(path);
+                                                });
+            }
+
+            sess.procsig = new ProcessSignalProducer(GetConnection(), OpenVPN3DBus_interf_backends,
+                                                     sess.object_path, "VPN-Client");
+            sess.procsig->ProcessChange(StatusMinor::PROC_STARTED);
+        }
+        catch (DBusException& excp)
+        {
+            if (signal)
+            {
+                signal->LogError("Could not start session " + ps->path
+                                 + ": " + excp.getRawError());
+            }
+            remove_session(ps->path);
+        }
+    }
+
+
+    /**
+     *  Removes a session which has ended, once the D-Bus method call
+     *  ending it has completed.  The process stops when the last session
+     *  is gone.
+     *
+     * @param path  D-Bus object path of the session
+     */
+    void remove_session(const std::string& path)
+    {
+        RemoveSession *rs = new RemoveSession{this, path};
+        g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, remove_session_cb, rs,
+                        [](gpointer data)
+                        {
+                            delete (RemoveSession *) data;
+                        });
+    }
+
+
+    /**
+     *  Announces a session has stopped and releases its resources
+     */
+    void close_session(ClientSession& sess)
+    {
+        if (sess.procsig)
+        {
+            sess.procsig->ProcessChange(StatusMinor::PROC_STOPPED);
+            delete sess.procsig;
+        }
+        sess.be_obj.reset();
+        close_p2p(sess.p2p_conn);
+        sess.p2p_conn = nullptr;
+    }
+
+
+    static void close_p2p(GDBusConnection *conn)
+    {
+        if (conn)
+        {
+            g_dbus_connection_close(conn, NULL, NULL, NULL);
+            g_object_unref(conn);
+        }
+    }
+
+
+    struct RemoveSession
+    {
+        BackendClientDBus *self;
+        std::string path;
+    };
+
+
+    static gboolean remove_session_cb(gpointer data)
+    {
+        RemoveSession *rs = (RemoveSession *) data;
+        BackendClientDBus *self = rs->self;
+
+        auto it = self->sessions.find(rs->path);
+        if (self->sessions.end() != it)
+        {
+            self->close_session(it->second);
+            self->sessions.erase(it);
+        }
+        if (self->sessions.empty())
+        {
+            if (self->mainloop)
+            {
+                g_main_loop_quit(self->mainloop);
+            }
+            else
+            {
+                kill(getpid(), SIGTERM);
+            }
+        }
+        return G_SOURCE_REMOVE;
+    }
+
+
+    static void backendstart_appeared(GDBusConnection *conn,
+                                      const gchar *name,
+                                      const gchar *name_owner,
+                                      gpointer this_ptr)
+    {
+        BackendClientDBus *self = (BackendClientDBus *) this_ptr;
+        try
+        {
+            DBusProxy prx(conn, OpenVPN3DBus_name_backends,
+                          OpenVPN3DBus_interf_backends,
+                          OpenVPN3DBus_rootp_backends);
+            prx.Call("RegisterHost", true);
+        }
+        catch (DBusException& excp)
+        {
+            self->signal->LogError("Could not register with the backend starter: "
+                                   + excp.getRawError());
+        }
+    }
+
+
+    /**
+     *  Called when the private connection to the session manager has been
+     *  opened, or failed.  The peer listening on the session manager's
+     *  private address is only trusted if it is the process owning the
+     *  session manager's bus name, which is looked up next.
+     */
+    static void p2p_connected(GObject *source, GAsyncResult *res,
+                              gpointer data)
+    {
+        PendingSession *ps = (PendingSession *) data;
+
+        GError *err = NULL;
+        ps->conn = g_dbus_connection_new_for_address_finish(res, &err);
+        if (NULL == ps->conn)
+        {
+            ps->error = std::string(err ? err->message : "(unknown)");
+            if (err)
+            {
+                g_error_free(err);
+            }
+            ps->self->start_session(ps);
+            delete ps;
+            return;
+        }
+
+        GIOStream *stream = g_dbus_connection_get_stream(ps->conn);
+        if (G_IS_SOCKET_CONNECTION(stream))
+        {
+            GSocket *sock = g_socket_connection_get_socket(G_SOCKET_CONNECTION(stream));
+            GCredentials *creds = g_socket_get_credentials(sock, NULL);
+            if (creds)
+            {
+                ps->peer_pid = g_credentials_get_unix_pid(creds, NULL);
+                g_object_unref(creds);
+            }
+        }
+
+        g_dbus_connection_call(ps->self->GetConnection(),
+                               "org.freedesktop.DBus",
+                               "/org/freedesktop/DBus",
+                               "org.freedesktop.DBus",
+                               "GetConnectionUnixProcessID",
+                               g_variant_new("(s)", OpenVPN3DBus_name_sessions.c_str()),
+                               G_VARIANT_TYPE("(u)"),
+                               G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                               -1,
+                               NULL,  // GCancellable
+                               p2p_peer_checked,
+                               ps);
+    }
+
+
+    /**
+     *  Called with the PID of the session manager, to verify the peer
+     *  of the private connection.  The session is started either way,
+     *  over the bus if the peer could not be verified.
+     */
+    static void p2p_peer_checked(GObject *source, GAsyncResult *res,
+                                 gpointer data)
+    {
+        PendingSession *ps = (PendingSession *) data;
+
+        GError *err = NULL;
+        GVariant *ret = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source),
+                                                      res, &err);
+        if (NULL == ret)
+        {
+            ps->error = std::string(err ? err->message : "(unknown)");
+            if (err)
+            {
+                g_error_free(err);
+            }
+        }
+        else
+        {
+            guint32 pid = 0;
+            g_variant_get(ret, "(u)", &pid);
+            g_variant_unref(ret);
+            if (ps->peer_pid < 1 || (pid_t) pid != ps->peer_pid)
+            {
+                ps->error = "Peer is not the session manager";
+            }
+        }
+
+        if (!ps->error.empty())
+        {
+            close_p2p(ps->conn);
+            ps->conn = nullptr;
+        }
+        ps->self->start_session(ps);
+        delete ps;
+    }
 };
 
 
 int main(int argc, char **argv)
 {
-    if (argc !=2)
+    // A process hosting several sessions is started with
+    // --host <max sessions> before the token
+    unsigned int max_sessions = 1;
+    int tokenarg = 1;
+    if (4 == argc && 0 == strcmp("--host", argv[1]))
+    {
+        max_sessions = std::max(1, std::atoi(argv[2]));
+        tokenarg = 3;
+    }
+    else if (argc != 2)
     {
-        std::cout << "** ERROR ** Invalid usage: " << argv[0] << " <session registration token>" << std::endl;
+        std::cout << "** ERROR ** Invalid usage: " << argv[0] << " [--host <max sessions>] <session registration token>" << std::endl;
         std::cout << std::endl;
         std::cout << "            This program is not intended to be called manually from the command line" << std::endl;
         return 1;
@@ -996,7 +1838,9 @@ int main(int argc, char **argv)
     {
         std::cout << get_version(argv[0]) << std::endl;
 
-        BackendClientDBus backend_service(start_pid, G_BUS_TYPE_SYSTEM, std::string(argv[1]));
+        BackendClientDBus backend_service(start_pid, G_BUS_TYPE_SYSTEM,
+                                          std::string(argv[tokenarg]),
+                                          max_sessions);
         backend_service.Setup();
 
         // Main loop
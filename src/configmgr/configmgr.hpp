@@ -29,6 +29,9 @@
 #include "dbus/core.hpp"
 #include "dbus/connection-creds.hpp"
 #include "dbus/exceptions.hpp"
+#include "dbus/memfd-payload.hpp"
+#include "dbus/objectmanager.hpp"
+#include "dbus/object-subtree.hpp"
 #include "log/dbus-log.hpp"
 #include "ovpn3cli/lookup.hpp"
 
@@ -144,12 +147,7 @@ public:
                                 "Specified alias is invalid");
         }
 
-        std::string introsp_xml ="<node name='" + new_obj_path + "'>"
-            "    <interface name='" + OpenVPN3DBus_interf_configuration + "'>"
-            "        <property  type='o' name='config_path' access='read'/>"
-            "    </interface>"
-            "</node>";
-        ParseIntrospectionXML(introsp_xml);
+        SetIntrospection(introspection_data());
     }
 
 
@@ -266,6 +264,23 @@ public:
 private:
     std::string alias;
     std::string cfgpath;
+
+
+    /**
+     *  Parses the introspection document shared by all ConfigurationAlias
+     *  objects.  This is only done once, on first use.
+     *
+     * @return Returns a GDBusNodeInfo pointer to the introspection document
+     */
+    static GDBusNodeInfo * introspection_data()
+    {
+        static GDBusNodeInfo *node = ParseIntrospection("<node>"
+            "    <interface name='" + OpenVPN3DBus_interf_configuration + "'>"
+            "        <property  type='o' name='config_path' access='read'/>"
+            "    </interface>"
+            "</node>");
+        return node;
+    }
 };
 
 
@@ -295,12 +310,17 @@ public:
      *                 VPN configuration profile.
      * @param params   Pointer to a GLib2 GVariant object containing both
      *                 meta data as well as the configuration profile itself
-     *                 to use when initializing this object
+     *                 to use when initializing this object.  The profile is
+     *                 either a string (ssbb) or a handle to a sealed memfd
+     *                 in the fdlist (shbb).
+     * @param fdlist   GUnixFDList received with the ImportFd method call.
+     *                 Only used when the profile is passed as a handle.
      */
     ConfigurationObject(GDBusConnection *dbuscon,
                         std::function<void()> remove_callback,
                         std::string objpath, unsigned int default_log_level,
-                        uid_t creator, GVariant *params)
+                        uid_t creator, GVariant *params,
+                        GUnixFDList *fdlist = nullptr)
         : DBusObject(objpath),
           ConfigManagerSignals(dbuscon, objpath, default_log_level),
           DBusCredentials(dbuscon, creator),
@@ -316,12 +336,30 @@ public:
           persist_tun(false),
           alias(nullptr)
     {
-        gchar *cfgstr;
-        gchar *cfgname_c;
-        g_variant_get (params, "(ssbb)",
-                       &cfgname_c, &cfgstr,
-                       &single_use, &persistent);
-        name = std::string(cfgname_c);
+        gchar *cfgname_c = nullptr;
+        std::string cfgstr;
+        if (g_variant_is_of_type(params, G_VARIANT_TYPE("(shbb)")))
+        {
+            gint32 cfg_handle = -1;
+            g_variant_get (params, "(shbb)",
+                           &cfgname_c, &cfg_handle,
+                           &single_use, &persistent);
+            name = std::string(cfgname_c);
+            g_free(cfgname_c);
+            cfgstr = MemfdPayload::Read(fdlist, cfg_handle,
+                                        ProfileParseLimits::MAX_PROFILE_SIZE);
+        }
+        else
+        {
+            gchar *cfgstr_c = nullptr;
+            g_variant_get (params, "(ssbb)",
+                           &cfgname_c, &cfgstr_c,
+                           &single_use, &persistent);
+            name = std::string(cfgname_c);
+            cfgstr = std::string(cfgstr_c);
+            g_free(cfgname_c);
+            g_free(cfgstr_c);
+        }
 
         // Parse the options from the imported configuration
         OptionList::Limits limits("profile is too large",
@@ -345,46 +383,7 @@ public:
         //         contains files
         valid = true;
 
-        std::string introsp_xml ="<node name='" + objpath + "'>"
-            "    <interface name='net.openvpn.v3.configuration'>"
-            "        <method name='Fetch'>"
-            "            <arg direction='out' type='s' name='config'/>"
-            "        </method>"
-            "        <method name='FetchJSON'>"
-            "            <arg direction='out' type='s' name='config_json'/>"
-            "        </method>"
-            "        <method name='SetOption'>"
-            "            <arg direction='in' type='s' name='option'/>"
-            "            <arg direction='in' type='s' name='value'/>"
-            "        </method>"
-            "        <method name='AccessGrant'>"
-            "            <arg direction='in' type='u' name='uid'/>"
-            "        </method>"
-            "        <method name='AccessRevoke'>"
-            "            <arg direction='in' type='u' name='uid'/>"
-            "        </method>"
-            "        <method name='Seal'/>"
-            "        <method name='Remove'/>"
-            "        <property type='u' name='owner' access='read'/>"
-            "        <property type='au' name='acl' access='read'/>"
-            "        <property type='s' name='name' access='readwrite'/>"
-            "        <property type='t' name='import_timestamp' access='read' />"
-            "        <property type='t' name='last_used_timestamp' access='read' />"
-            "        <property type='u' name='used_count' access='read' />"
-            "        <property type='b' name='valid' access='read'/>"
-            "        <property type='b' name='readonly' access='read'/>"
-            "        <property type='b' name='single_use' access='read'/>"
-            "        <property type='b' name='persistent' access='read'/>"
-            "        <property type='b' name='locked_down' access='readwrite'/>"
-            "        <property type='b' name='public_access' access='readwrite'/>"
-            "        <property type='b' name='persist_tun' access='readwrite' />"
-            "        <property type='s' name='alias' access='readwrite'/>"
-            "    </interface>"
-            "</node>";
-        ParseIntrospectionXML(introsp_xml);
-
-        g_free(cfgname_c);
-        g_free(cfgstr);
+        SetIntrospection(introspection_data());
     }
 
 
@@ -398,7 +397,42 @@ public:
 
     /**
      *  Callback method which is called each time a D-Bus method call occurs
-     *  on this ConfigurationObject.
+     *  on this ConfigurationObject.  The method call is passed on to the
+     *  handler registered in the method table.
+     *
+     * @param call  DBusMethodCall with the method call arguments
+     *
+     * @return Returns false if the method is not found in the method table
+     */
+    bool callback_method_dispatch(const DBusMethodCall& call)
+    {
+        MethodTable::Handler handler = method_table().Lookup(call.intf_name,
+                                                             call.method_name);
+        if (nullptr == handler)
+        {
+            return false;
+        }
+
+        IdleCheck_UpdateTimestamp();
+        try
+        {
+            // Some handlers delete this object; nothing in this
+            // object may be accessed after the handler returns.
+            (this->*handler)(call);
+        }
+        catch (DBusCredentialsException& excp)
+        {
+            LogWarn(excp.err());
+            excp.SetDBusError(call.invoc);
+        }
+        return true;
+    }
+
+
+    /**
+     *  Called for method calls not found in the method table.  GDBus
+     *  validates the method calls against the introspection data, so
+     *  this should normally not happen.
      *
      * @param conn        D-Bus connection where the method call occurred
      * @param sender      D-Bus bus name of the sender of the method call
@@ -418,205 +452,10 @@ public:
                               GVariant *params,
                               GDBusMethodInvocation *invoc)
     {
-        IdleCheck_UpdateTimestamp();
-        if ("Fetch" == method_name)
-        {
-            try
-            {
-                if (!locked_down)
-                {
-                    CheckACL(sender, true);
-                }
-                else
-                {
-                    // If the configuration is locked down, restrict any
-                    // read-operations to anyone except the backend VPN client
-                    // process (root user) or the configuration profile owner
-                    CheckOwnerAccess(sender, true);
-                }
-                g_dbus_method_invocation_return_value(invoc,
-                                                      g_variant_new("(s)",
-                                                                    options.string_export().c_str()));
-
-                // If the fetching user is root, we consider this
-                // configuration to be "used"
-                if (GetUID(sender) == 0)
-                {
-                    // If this config is tagged as single-use only then we delete this
-                    // config from memory.
-                    if (single_use)
-                    {
-                        LogVerb2("Single-use configuration fetched");
-                        RemoveObject(conn);
-                        delete this;
-                        return;
-                    }
-                    used_count++;
-                    last_use_tstamp = std::time(nullptr);
-                }
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
-        else if ("FetchJSON" == method_name)
-        {
-            try
-            {
-                if (!locked_down)
-                {
-                    CheckACL(sender);
-                }
-                else
-                {
-                    // If the configuration is locked down, restrict any
-                    // read-operations to the configuration profile owner
-                    CheckOwnerAccess(sender);
-                }
-                g_dbus_method_invocation_return_value(invoc,
-                                                      g_variant_new("(s)",
-                                                                    options.json_export().c_str()));
-
-                // Do not remove single-use object with this method.
-                // FetchJSON is only used by front-ends, never backends.  So
-                // it still needs to be available when the backend calls Fetch.
-                //
-                // single-use configurations are an automation convenience,
-                // not a security feature.  Security is handled via ACLs.
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
-        else if ("SetOption" == method_name)
-        {
-            if (readonly)
-            {
-                g_dbus_method_invocation_return_dbus_error (invoc,
-                                                            "net.openvpn.v3.error.ReadOnly",
-                                                            "Configuration is sealed and readonly");
-                return;
-            }
-            try
-            {
-                CheckOwnerAccess(sender);
-                // TODO: Implement SetOption
-                g_dbus_method_invocation_return_value(invoc, NULL);
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
-        else if ("AccessGrant" == method_name)
-        {
-            if (readonly)
-            {
-                g_dbus_method_invocation_return_dbus_error (invoc,
-                                                            "net.openvpn.v3.error.ReadOnly",
-                                                            "Configuration is sealed and readonly");
-                return;
-            }
-
-            try
-            {
-                CheckOwnerAccess(sender);
-
-                uid_t uid = -1;
-                g_variant_get(params, "(u)", &uid);
-                GrantAccess(uid);
-                g_dbus_method_invocation_return_value(invoc, NULL);
-
-                LogInfo("Access granted to UID " + std::to_string(uid)
-                         + " by UID " + std::to_string(GetUID(sender)));
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
-        else if ("AccessRevoke" == method_name)
-        {
-            if (readonly)
-            {
-                g_dbus_method_invocation_return_dbus_error (invoc,
-                                                            "net.openvpn.v3.error.ReadOnly",
-                                                            "Configuration is sealed and readonly");
-                return;
-            }
-
-            try
-            {
-                CheckOwnerAccess(sender);
-
-                uid_t uid = -1;
-                g_variant_get(params, "(u)", &uid);
-                RevokeAccess(uid);
-                g_dbus_method_invocation_return_value(invoc, NULL);
-
-                LogInfo("Access revoked for UID " + std::to_string(uid)
-                         + " by UID " + std::to_string(GetUID(sender)));
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
-        else if ("Seal" == method_name)
-        {
-            try
-            {
-                CheckOwnerAccess(sender);
-
-                if (valid) {
-                    readonly = true;
-                    g_dbus_method_invocation_return_value(invoc, NULL);
-                }
-                else
-                {
-                    g_dbus_method_invocation_return_dbus_error (invoc,
-                                                                "net.openvpn.v3.error.InvalidData",
-                                                                "Configuration is not currently valid");
-                }
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
-        else if ("Remove" == method_name)
-        {
-            try
-            {
-                CheckOwnerAccess(sender);
-                std::string sender_name = lookup_username(GetUID(sender));
-                LogInfo("Configuration '" + name + "' was removed by "
-                        + sender_name);
-                RemoveObject(conn);
-                g_dbus_method_invocation_return_value(invoc, NULL);
-                delete this;
-                return;
-            }
-            catch (DBusCredentialsException& excp)
-            {
-                LogWarn(excp.err());
-                excp.SetDBusError(invoc);
-            }
-        }
+        g_dbus_method_invocation_return_dbus_error(invoc,
+                                                   "org.freedesktop.DBus.Error.UnknownMethod",
+                                                   ("No method named " + method_name
+                                                    + " is available").c_str());
     };
 
 
@@ -663,82 +502,66 @@ public:
 
 
         // Properties only available for approved users
-        try {
-            CheckACL(sender, allow_root);
-
-            GVariant *ret = NULL;
-
-            if ("single_use" == property_name)
-            {
-                ret = g_variant_new_boolean (single_use);
-            }
-            else if ("persistent" == property_name)
-            {
-                ret = g_variant_new_boolean (persistent);
-            }
-            else if ("valid" == property_name)
-            {
-                ret = g_variant_new_boolean (valid);
-            }
-            else if ("readonly" == property_name)
-            {
-                ret = g_variant_new_boolean (readonly);
-            }
-            else if ("name"  == property_name)
-            {
-                ret = g_variant_new_string (name.c_str());
-            }
-            else if( "import_timestamp" == property_name)
-            {
-                return g_variant_new_uint64 (import_tstamp);
-            }
-            else if( "last_used_timestamp" == property_name)
-            {
-                return g_variant_new_uint64 (last_use_tstamp);
-            }
-            else if( "used_count" == property_name)
-            {
-                return g_variant_new_uint32 (used_count);
-            }
-            else if ("alias" == property_name)
-            {
-                ret = g_variant_new_string(alias ? alias->GetAlias() : "");
-            }
-            else if ("locked_down" == property_name)
-            {
-                ret = g_variant_new_boolean (locked_down);
-            }
-            else if ("public_access" == property_name)
-            {
-                ret = GetPublicAccess();
-            }
-            else if ("persist_tun" == property_name)
-            {
-                ret = g_variant_new_boolean (persist_tun);
-            }
-            else if ("acl" == property_name)
-            {
-                    ret = GetAccessList();
-            }
-            else
-            {
-                g_set_error (error,
-                             G_IO_ERROR,
-                             G_IO_ERROR_FAILED,
-                             "Unknown property");
-            }
-
-            return ret;
-        }
-        catch (DBusCredentialsException& excp)
+        if (ACLDecision::DENY == EvaluateACL(sender, false, allow_root))
         {
+            DBusCredentialsException excp = AccessDenied(sender);
             LogWarn(excp.err());
             excp.SetDBusError(error, G_IO_ERROR, G_IO_ERROR_FAILED);
             return NULL;
         }
+        return get_property_value(property_name, error);
     };
 
 
+    /**
+     *   Callback used when all ConfigurationObject properties are retrieved
+     *   in a single org.freedesktop.DBus.Properties.GetAll() call.  The
+     *   access control check is only done once for all the properties.
+     *   Callers without access will only see the 'owner' property, and
+     *   'persist_tun' if the caller is root.
+     *
+     * @param conn           D-Bus connection this event occurred on
+     * @param sender         D-Bus bus name of the requester
+     * @param obj_path       D-Bus object path to the object being requested
+     * @param intf_name      D-Bus interface of the properties being accessed
+     * @param error          A GLib2 GError object if an error occurs
+     *
+     * @return  Returns a GVariant a{sv} dictionary with all the properties
+     *          the caller can access.
+     */
+    GVariant * callback_get_all_properties(GDBusConnection *conn,
+                                           const std::string sender,
+                                           const std::string obj_path,
+                                           const std::string intf_name,
+                                           GError **error)
+    {
+        IdleCheck_UpdateTimestamp();
+
+        bool granted = (ACLDecision::DENY != EvaluateACL(sender));
+        bool root_granted = false;
+        if (!granted)
+        {
+            root_granted = (ACLDecision::DENY != EvaluateACL(sender, false, true));
+            if (!root_granted)
+            {
+                LogWarn(AccessDenied(sender).err());
+            }
+        }
+
+        return build_all_properties(intf_name,
+                                    [this, granted, root_granted](const std::string& prop,
+                                                                  GError **err) -> GVariant *
+                                    {
+                                        if (!granted && "owner" != prop
+                                            && !(root_granted && "persist_tun" == prop))
+                                        {
+                                            return NULL;
+                                        }
+                                        return get_property_value(prop, err);
+                                    });
+    }
+
+
     /**
      *  Callback method which is used each time a ConfigurationObject property
      *  is being modified over D-Bus.
@@ -865,6 +688,378 @@ private:
     bool persist_tun;
     ConfigurationAlias *alias;
     OptionListJSON options;
+
+
+    typedef DBusMethodTable<ConfigurationObject> MethodTable;
+
+
+    /**
+     *  The D-Bus methods of a ConfigurationObject with their handlers and
+     *  introspection data.  Access control failures thrown by the
+     *  handlers are returned to the caller by callback_method_dispatch().
+     */
+    static const MethodTable& method_table()
+    {
+        static const MethodTable table = build_method_table();
+        return table;
+    }
+
+
+    static MethodTable build_method_table()
+    {
+        const std::string intf(OpenVPN3DBus_interf_configuration);
+        MethodTable table;
+        table.Add(intf, "Fetch",
+                  "            <arg direction='out' type='s' name='config'/>",
+                  &ConfigurationObject::method_fetch)
+             .Add(intf, "FetchJSON",
+                  "            <arg direction='out' type='s' name='config_json'/>",
+                  &ConfigurationObject::method_fetch_json)
+             .Add(intf, "FetchFd",
+                  "            <arg direction='out' type='h' name='config_fd'/>",
+                  &ConfigurationObject::method_fetch)
+             .Add(intf, "FetchJSONFd",
+                  "            <arg direction='out' type='h' name='config_json_fd'/>",
+                  &ConfigurationObject::method_fetch_json)
+             .Add(intf, "SetOption",
+                  "            <arg direction='in' type='s' name='option'/>"
+                  "            <arg direction='in' type='s' name='value'/>",
+                  &ConfigurationObject::method_set_option)
+             .Add(intf, "AccessGrant",
+                  "            <arg direction='in' type='u' name='uid'/>",
+                  &ConfigurationObject::method_access_grant)
+             .Add(intf, "AccessRevoke",
+                  "            <arg direction='in' type='u' name='uid'/>",
+                  &ConfigurationObject::method_access_revoke)
+             .Add(intf, "Seal", "", &ConfigurationObject::method_seal)
+             .Add(intf, "Remove", "", &ConfigurationObject::method_remove);
+        return table;
+    }
+
+
+    /**
+     *  Returns an error to the caller if the configuration is sealed
+     *
+     * @param invoc  GDBusMethodInvocation to return the error to
+     *
+     * @return Returns true if the configuration is read-only and an
+     *         error was returned
+     */
+    bool deny_readonly(GDBusMethodInvocation *invoc)
+    {
+        if (readonly)
+        {
+            g_dbus_method_invocation_return_dbus_error (invoc,
+                                                        "net.openvpn.v3.error.ReadOnly",
+                                                        "Configuration is sealed and readonly");
+        }
+        return readonly;
+    }
+
+
+    /**
+     *  Handles Fetch and FetchFd
+     */
+    void method_fetch(const DBusMethodCall& call)
+    {
+        if (!locked_down)
+        {
+            CheckACL(call.sender, true);
+        }
+        else
+        {
+            // If the configuration is locked down, restrict any
+            // read-operations to anyone except the backend VPN client
+            // process (root user) or the configuration profile owner
+            CheckOwnerAccess(call.sender, true);
+        }
+        return_config(call.invoc, options.string_export(),
+                      0 == g_strcmp0("FetchFd", call.method_name));
+
+        // If the fetching user is root, we consider this
+        // configuration to be "used"
+        if (GetUID(call.sender) == 0)
+        {
+            // If this config is tagged as single-use only then we delete this
+            // config from memory.
+            if (single_use)
+            {
+                LogVerb2("Single-use configuration fetched");
+                RemoveObject(call.conn);
+                delete this;
+                return;
+            }
+            used_count++;
+            last_use_tstamp = std::time(nullptr);
+
+            GVariantBuilder changed;
+            g_variant_builder_init(&changed, G_VARIANT_TYPE("a{sv}"));
+            g_variant_builder_add(&changed, "{sv}", "used_count",
+                                  g_variant_new_uint32(used_count));
+            g_variant_builder_add(&changed, "{sv}", "last_used_timestamp",
+                                  g_variant_new_uint64(last_use_tstamp));
+            SendPropertiesChanged(OpenVPN3DBus_interf_configuration,
+                                  g_variant_builder_end(&changed));
+        }
+    }
+
+
+    /**
+     *  Handles FetchJSON and FetchJSONFd
+     */
+    void method_fetch_json(const DBusMethodCall& call)
+    {
+        if (!locked_down)
+        {
+            CheckACL(call.sender);
+        }
+        else
+        {
+            // If the configuration is locked down, restrict any
+            // read-operations to the configuration profile owner
+            CheckOwnerAccess(call.sender);
+        }
+        return_config(call.invoc, options.json_export(),
+                      0 == g_strcmp0("FetchJSONFd", call.method_name));
+
+        // Do not remove single-use object with this method.
+        // FetchJSON is only used by front-ends, never backends.  So
+        // it still needs to be available when the backend calls Fetch.
+        //
+        // single-use configurations are an automation convenience,
+        // not a security feature.  Security is handled via ACLs.
+    }
+
+
+    void method_set_option(const DBusMethodCall& call)
+    {
+        if (deny_readonly(call.invoc))
+        {
+            return;
+        }
+        CheckOwnerAccess(call.sender);
+        // TODO: Implement SetOption
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_access_grant(const DBusMethodCall& call)
+    {
+        if (deny_readonly(call.invoc))
+        {
+            return;
+        }
+        CheckOwnerAccess(call.sender);
+
+        uid_t uid = -1;
+        g_variant_get(call.params, "(u)", &uid);
+        GrantAccess(uid);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+
+        LogInfo("Access granted to UID " + std::to_string(uid)
+                 + " by UID " + std::to_string(GetUID(call.sender)));
+    }
+
+
+    void method_access_revoke(const DBusMethodCall& call)
+    {
+        if (deny_readonly(call.invoc))
+        {
+            return;
+        }
+        CheckOwnerAccess(call.sender);
+
+        uid_t uid = -1;
+        g_variant_get(call.params, "(u)", &uid);
+        RevokeAccess(uid);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+
+        LogInfo("Access revoked for UID " + std::to_string(uid)
+                 + " by UID " + std::to_string(GetUID(call.sender)));
+    }
+
+
+    void method_seal(const DBusMethodCall& call)
+    {
+        CheckOwnerAccess(call.sender);
+
+        if (valid) {
+            readonly = true;
+            g_dbus_method_invocation_return_value(call.invoc, NULL);
+        }
+        else
+        {
+            g_dbus_method_invocation_return_dbus_error (call.invoc,
+                                                        "net.openvpn.v3.error.InvalidData",
+                                                        "Configuration is not currently valid");
+        }
+    }
+
+
+    void method_remove(const DBusMethodCall& call)
+    {
+        CheckOwnerAccess(call.sender);
+        std::string sender_name = lookup_username(GetUID(call.sender));
+        LogInfo("Configuration '" + name + "' was removed by "
+                + sender_name);
+        RemoveObject(call.conn);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+        delete this;
+    }
+
+
+    /**
+     *  Retrieves the value of a ConfigurationObject property.  The caller
+     *  is responsible for the access control check.
+     *
+     * @param property_name  The property name being accessed
+     * @param error          A GLib2 GError object if an error occurs
+     *
+     * @return  Returns a GVariant Glib2 object containing the value of the
+     *          requested property or NULL on errors.
+     */
+    GVariant * get_property_value(const std::string& property_name,
+                                  GError **error)
+    {
+        GVariant *ret = NULL;
+
+        if ("owner" == property_name)
+        {
+            ret = GetOwner();
+        }
+        else if ("single_use" == property_name)
+        {
+            ret = g_variant_new_boolean (single_use);
+        }
+        else if ("persistent" == property_name)
+        {
+            ret = g_variant_new_boolean (persistent);
+        }
+        else if ("valid" == property_name)
+        {
+            ret = g_variant_new_boolean (valid);
+        }
+        else if ("readonly" == property_name)
+        {
+            ret = g_variant_new_boolean (readonly);
+        }
+        else if ("name"  == property_name)
+        {
+            ret = g_variant_new_string (name.c_str());
+        }
+        else if( "import_timestamp" == property_name)
+        {
+            return g_variant_new_uint64 (import_tstamp);
+        }
+        else if( "last_used_timestamp" == property_name)
+        {
+            return g_variant_new_uint64 (last_use_tstamp);
+        }
+        else if( "used_count" == property_name)
+        {
+            return g_variant_new_uint32 (used_count);
+        }
+        else if ("alias" == property_name)
+        {
+            ret = g_variant_new_string(alias ? alias->GetAlias() : "");
+        }
+        else if ("locked_down" == property_name)
+        {
+            ret = g_variant_new_boolean (locked_down);
+        }
+        else if ("public_access" == property_name)
+        {
+            ret = GetPublicAccess();
+        }
+        else if ("persist_tun" == property_name)
+        {
+            ret = g_variant_new_boolean (persist_tun);
+        }
+        else if ("acl" == property_name)
+        {
+            ret = GetAccessList();
+        }
+        else
+        {
+            g_set_error (error,
+                         G_IO_ERROR,
+                         G_IO_ERROR_FAILED,
+                         "Unknown property");
+        }
+
+        return ret;
+    }
+
+
+    /**
+     *  Returns the exported configuration profile to the caller, either as
+     *  a string or as a handle to a sealed memfd containing the profile.
+     *  The memfd variant avoids copying large profiles through the
+     *  D-Bus message marshalling and the D-Bus daemon.
+     *
+     * @param invoc   GDBusMethodInvocation to return the profile to
+     * @param config  std::string with the exported profile
+     * @param as_fd   If true, the profile is returned as a memfd handle
+     */
+    void return_config(GDBusMethodInvocation *invoc,
+                       const std::string& config, bool as_fd)
+    {
+        if (!as_fd)
+        {
+            g_dbus_method_invocation_return_value(invoc,
+                                                  g_variant_new("(s)",
+                                                                config.c_str()));
+            return;
+        }
+
+        try
+        {
+            MemfdPayload payload(config);
+            GUnixFDList *fdlist = payload.GetFDList();
+            g_dbus_method_invocation_return_value_with_unix_fd_list(invoc,
+                                                                    g_variant_new("(h)", 0),
+                                                                    fdlist);
+            g_object_unref(fdlist);
+        }
+        catch (DBusException& excp)
+        {
+            LogError(excp.err());
+            g_dbus_method_invocation_return_dbus_error(invoc,
+                                                       "net.openvpn.v3.error.fd-payload",
+                                                       excp.getRawError().c_str());
+        }
+    }
+
+
+    /**
+     *  Parses the introspection document shared by all
+     *  ConfigurationObjects.  This is only done once, on first use.
+     *
+     * @return Returns a GDBusNodeInfo pointer to the introspection document
+     */
+    static GDBusNodeInfo * introspection_data()
+    {
+        static GDBusNodeInfo *node = ParseIntrospection("<node>"
+            "    <interface name='net.openvpn.v3.configuration'>"
+            + method_table().GetIntrospection(OpenVPN3DBus_interf_configuration) +
+            "        <property type='u' name='owner' access='read'/>"
+            "        <property type='au' name='acl' access='read'/>"
+            "        <property type='s' name='name' access='readwrite'/>"
+            "        <property type='t' name='import_timestamp' access='read' />"
+            "        <property type='t' name='last_used_timestamp' access='read' />"
+            "        <property type='u' name='used_count' access='read' />"
+            "        <property type='b' name='valid' access='read'/>"
+            "        <property type='b' name='readonly' access='read'/>"
+            "        <property type='b' name='single_use' access='read'/>"
+            "        <property type='b' name='persistent' access='read'/>"
+            "        <property type='b' name='locked_down' access='readwrite'/>"
+            "        <property type='b' name='public_access' access='readwrite'/>"
+            "        <property type='b' name='persist_tun' access='readwrite' />"
+            "        <property type='s' name='alias' access='readwrite'/>"
+            "    </interface>"
+            "</node>");
+        return node;
+    }
 };
 
 
@@ -900,7 +1095,9 @@ public:
         : DBusObject(objpath),
           ConfigManagerSignals(dbusc, objpath, default_log_level),
           dbuscon(dbusc),
-          creds(dbusc)
+          creds(dbusc),
+          objmgr(dbusc, objpath),
+          visibility(std::make_shared<DBusVisibilityIndex>())
     {
         std::stringstream introspection_xml;
         introspection_xml << "<node name='" + objpath + "'>"
@@ -912,11 +1109,20 @@ public:
                           << "          <arg type='b' name='persistent' direction='in'/>"
                           << "          <arg type='o' name='config_path' direction='out'/>"
                           << "        </method>"
+                          << "        <method name='ImportFd'>"
+                          << "          <arg type='s' name='name' direction='in'/>"
+                          << "          <arg type='h' name='config_fd' direction='in'/>"
+                          << "          <arg type='b' name='single_use' direction='in'/>"
+                          << "          <arg type='b' name='persistent' direction='in'/>"
+                          << "          <arg type='o' name='config_path' direction='out'/>"
+                          << "        </method>"
                           << "        <method name='FetchAvailableConfigs'>"
                           << "          <arg type='ao' name='paths' direction='out'/>"
                           << "        </method>"
                           << GetLogIntrospection()
                           << "    </interface>"
+                          << DBusObjectManager::GetIntrospection()
+                          << DBusMethodStats::GetIntrospection()
                           << "</node>";
         ParseIntrospectionXML(introspection_xml);
 
@@ -941,6 +1147,20 @@ public:
     }
 
 
+    /**
+     *  Registers new configuration objects through a single D-Bus subtree
+     *  registration below the configuration manager object path, instead
+     *  of one registration per configuration object.  Configuration
+     *  aliases are not direct children of this path and are still
+     *  registered individually.
+     */
+    void EnableSubtreeRegistration()
+    {
+        config_subtree.reset(new DBusObjectSubtree(dbuscon, GetObjectPath()));
+        config_subtree->Register();
+    }
+
+
     /**
      *  Callback method called each time a method in the
      *  ConfigurationManagerObject is called over the D-Bus.
@@ -964,48 +1184,73 @@ public:
                               GDBusMethodInvocation *invoc)
     {
         IdleCheck_UpdateTimestamp();
-        if ("Import" == method_name)
+        if ("Import" == method_name || "ImportFd" == method_name)
         {
             // Import the configuration
             std::string cfgpath = generate_path_uuid(OpenVPN3DBus_rootp_configuration, 'x');
 
-            auto *cfgobj = new ConfigurationObject(dbuscon,
-                                                   [self=Ptr(this), cfgpath]()
-                                                   {
-                                                       self->remove_config_object(cfgpath);
-                                                   },
-                                                   cfgpath,
-                                                   GetLogLevel(),
-                                                   creds.GetUID(sender),
-                                                   params);
+            // ImportFd passes the profile as a sealed memfd
+            GUnixFDList *fdlist = g_dbus_message_get_unix_fd_list(
+                                        g_dbus_method_invocation_get_message(invoc));
+
+            uid_t owner = creds.GetUID(sender);
+            ConfigurationObject *cfgobj = nullptr;
+            try
+            {
+                cfgobj = new ConfigurationObject(dbuscon,
+                                                 [self=Ptr(this), cfgpath]()
+                                                 {
+                                                     self->remove_config_object(cfgpath);
+                                                 },
+                                                 cfgpath,
+                                                 GetLogLevel(),
+                                                 owner,
+                                                 params,
+                                                 fdlist);
+            }
+            catch (DBusException& excp)
+            {
+                LogWarn("Configuration import failed: " + excp.getRawError());
+                g_dbus_method_invocation_return_dbus_error(invoc,
+                                                           "net.openvpn.v3.error.InvalidData",
+                                                           excp.getRawError().c_str());
+                return;
+            }
             IdleCheck_RefInc();
             cfgobj->IdleCheck_Register(IdleCheck_Get());
-            cfgobj->RegisterObject(conn);
+            cfgobj->SetVisibilityIndex(visibility, cfgpath);
+            if (config_subtree)
+            {
+                config_subtree->Add(cfgobj);
+            }
+            else
+            {
+                cfgobj->RegisterObject(conn);
+            }
             config_objects[cfgpath] = cfgobj;
 
+            // Only the publicly readable properties are announced
+            GVariantBuilder pubprops;
+            g_variant_builder_init(&pubprops, G_VARIANT_TYPE("a{sv}"));
+            g_variant_builder_add(&pubprops, "{sv}", "owner",
+                                  g_variant_new_uint32(owner));
+            objmgr.InterfacesAdded(cfgpath, OpenVPN3DBus_interf_configuration,
+                                   g_variant_builder_end(&pubprops));
+
             Debug(std::string("ConfigurationObject registered on '")
                          + intf_name + "': " + cfgpath
-                         + " (owner uid " + std::to_string(creds.GetUID(sender)) + ")");
+                         + " (owner uid " + std::to_string(owner) + ")");
             g_dbus_method_invocation_return_value(invoc, g_variant_new("(o)", cfgpath.c_str()));
         }
         else if ("FetchAvailableConfigs" == method_name)
         {
-            // Build up an array of object paths to available config objects
+            // Build up an array of object paths to available config objects.
+            // The visibility index already knows which configuration
+            // objects the caller has access to.
             GVariantBuilder *bld = g_variant_builder_new(G_VARIANT_TYPE("ao"));
-            for (auto& item : config_objects)
+            for (auto& path : visibility->Lookup(creds.GetUID(sender)))
             {
-                try {
-                    // We check if the caller is allowed to access this
-                    // configuration object.  If not, an exception is thrown
-                    // and we will just ignore that exception and continue
-                    item.second->CheckACL(sender);
-                    g_variant_builder_add(bld, "o", item.first.c_str());
-                }
-                catch (DBusCredentialsException& excp)
-                {
-                    // Ignore credentials exceptions.  It means the
-                    // caller does not have access this configuration object
-                }
+                g_variant_builder_add(bld, "o", path.c_str());
             }
 
             // Wrap up the result into a tuple, which GDBus expects and
@@ -1019,6 +1264,16 @@ public:
             g_variant_builder_unref(bld);
             g_variant_builder_unref(ret);
         }
+        else if (DBusObjectManager_interf == intf_name
+                 && "GetManagedObjects" == method_name)
+        {
+            // Returns all configuration objects the caller has access to,
+            // including all their properties
+            g_dbus_method_invocation_return_value(invoc,
+                                                  objmgr.GetManagedObjects(conn, sender,
+                                                                           OpenVPN3DBus_interf_configuration,
+                                                                           config_objects));
+        }
     };
 
 
@@ -1090,7 +1345,10 @@ public:
 private:
     GDBusConnection *dbuscon;
     DBusConnectionCreds creds;
+    DBusObjectManager objmgr;
     std::map<std::string, ConfigurationObject *> config_objects;
+    std::unique_ptr<DBusObjectSubtree> config_subtree;
+    DBusVisibilityIndex::Ptr visibility;
 
     /**
      * Callback function used by ConfigurationObject instances to remove
@@ -1103,6 +1361,7 @@ private:
     void remove_config_object(const std::string cfgpath)
     {
         config_objects.erase(cfgpath);
+        objmgr.InterfacesRemoved(cfgpath, OpenVPN3DBus_interf_configuration);
     }
 };
 
@@ -1168,6 +1427,18 @@ public:
     }
 
 
+    /**
+     *  Enables registering all configuration objects through a single
+     *  D-Bus subtree registration.  Must be called before Setup().
+     *
+     * @param enable  Bool flag enabling subtree registration
+     */
+    void SetSubtreeRegistration(bool enable)
+    {
+        subtree_registration = enable;
+    }
+
+
     /**
      *  This callback is called when the service was successfully registered
      *  on the D-Bus.
@@ -1181,6 +1452,10 @@ public:
             cfgmgr->OpenLogFile(logfile);
         }
         cfgmgr->RegisterObject(GetConnection());
+        if (subtree_registration)
+        {
+            cfgmgr->EnableSubtreeRegistration();
+        }
 
         procsig = new ProcessSignalProducer(GetConnection(),
                                             OpenVPN3DBus_interf_configuration,
@@ -1226,6 +1501,7 @@ public:
 
 private:
     unsigned int default_log_level = 6; // LogCategory::DEBUG
+    bool subtree_registration = false;
     ConfigManagerObject::Ptr cfgmgr;
     ProcessSignalProducer * procsig;
     std::string logfile;
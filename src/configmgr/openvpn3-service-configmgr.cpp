@@ -52,13 +52,13 @@ static int config_manager(ParsedArgs args)
         log_level = std::atoi(args.GetValue("log-level", 0).c_str());
     }
     cfgmgr.SetLogLevel(log_level);
+    cfgmgr.SetSubtreeRegistration(args.Present("subtree-registration"));
 
     IdleCheck::Ptr idle_exit;
     if (idle_wait_min > 0)
     {
         idle_exit.reset(new IdleCheck(main_loop,
                                       std::chrono::minutes(idle_wait_min)));
-        idle_exit->SetPollTime(std::chrono::seconds(30));
         cfgmgr.EnableIdleCheck(idle_exit);
     }
     cfgmgr.Setup();
@@ -73,7 +73,6 @@ static int config_manager(ParsedArgs args)
     if (idle_wait_min > 0)
     {
         idle_exit->Disable();
-        idle_exit->Join();
     }
 
     return 0;
@@ -89,7 +88,10 @@ int main(int argc, char **argv)
     argparser.AddOption("idle-exit", "MINUTES", true,
                         "How long to wait before exiting if being idle. "
                         "0 disables it (Default: 3 minutes)");
-
+    argparser.AddOption("subtree-registration",
+                        "Register configuration profiles through a single "
+                        "D-Bus subtree instead of one registration per "
+                        "profile");
 
     try
     {
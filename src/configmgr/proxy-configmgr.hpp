@@ -22,7 +22,10 @@
 
 #include <vector>
 
+#include <openvpn/client/cliconstants.hpp>
+
 #include "dbus/core.hpp"
+#include "dbus/memfd-payload.hpp"
 
 using namespace openvpn;
 
@@ -34,13 +37,8 @@ public:
                     OpenVPN3DBus_interf_configuration,
                     "", true)
     {
-        std::string object_path = get_object_path(bus_type, target);
-        proxy = SetupProxy(OpenVPN3DBus_name_configuration,
-                           OpenVPN3DBus_interf_configuration,
-                           object_path);
-        property_proxy = SetupProxy(OpenVPN3DBus_name_configuration,
-                                    "org.freedesktop.DBus.Properties",
-                                    object_path);
+        SetObjectPath(get_object_path(bus_type, target));
+        proxy = SetupProxy();
     }
 
     OpenVPN3ConfigurationProxy(DBus const & dbusobj, std::string target)
@@ -49,24 +47,62 @@ public:
                     OpenVPN3DBus_interf_configuration,
                     "", true)
     {
-        std::string object_path = get_object_path(GetBusType(), target);
-        proxy = SetupProxy(OpenVPN3DBus_name_configuration,
-                           OpenVPN3DBus_interf_configuration,
-                           object_path);
-        property_proxy = SetupProxy(OpenVPN3DBus_name_configuration,
-                                    "org.freedesktop.DBus.Properties",
-                                    object_path);
+        SetObjectPath(get_object_path(GetBusType(), target));
+        proxy = SetupProxy();
     }
 
+    /**
+     *  Imports a configuration profile.  When the D-Bus connection supports
+     *  file descriptor passing, the profile is passed as a sealed memfd
+     *  instead of being copied into the D-Bus message.  If the
+     *  configuration manager does not provide ImportFd, the profile is
+     *  passed as a string.
+     *
+     * @param name         Name of the configuration profile
+     * @param config_blob  The configuration profile
+     * @param single_use   If true, the profile is removed after first use
+     * @param persistent   If true, the profile is kept across restarts
+     *
+     * @return Returns the D-Bus object path of the imported configuration
+     */
     std::string Import(std::string name, std::string config_blob,
                        bool single_use, bool persistent)
     {
-        GVariant *res = Call("Import",
-                             g_variant_new("(ssbb)",
-                                           name.c_str(),
-                                           config_blob.c_str(),
-                                           single_use,
-                                           persistent));
+        GVariant *res = NULL;
+        if (CanPassFDs())
+        {
+            MemfdPayload payload(config_blob);
+            GUnixFDList *fdlist = payload.GetFDList();
+            try
+            {
+                res = CallWithFDList("ImportFd",
+                                     g_variant_new("(shbb)",
+                                                   name.c_str(),
+                                                   0,
+                                                   single_use,
+                                                   persistent),
+                                     fdlist, NULL);
+            }
+            catch (DBusUnknownMethodException&)
+            {
+                // An older configuration manager; use Import instead
+            }
+            catch (...)
+            {
+                g_object_unref(fdlist);
+                throw;
+            }
+            g_object_unref(fdlist);
+        }
+        if (NULL == res)
+        {
+            res = Call("Import",
+                       g_variant_new("(ssbb)",
+                                     name.c_str(),
+                                     config_blob.c_str(),
+                                     single_use,
+                                     persistent));
+        }
         if (NULL == res)
         {
             THROW_DBUSEXCEPTION("OpenVPN3ConfigurationProxy",
@@ -116,6 +152,18 @@ public:
 
     std::string GetJSONConfig()
     {
+        if (CanPassFDs())
+        {
+            try
+            {
+                return fetch_fd("FetchJSONFd");
+            }
+            catch (DBusUnknownMethodException&)
+            {
+                // An older configuration manager; use FetchJSON instead
+            }
+        }
+
         GVariant *res = Call("FetchJSON");
         if (NULL == res)
         {
@@ -134,6 +182,18 @@ public:
 
     std::string GetConfig()
     {
+        if (CanPassFDs())
+        {
+            try
+            {
+                return fetch_fd("FetchFd");
+            }
+            catch (DBusUnknownMethodException&)
+            {
+                // An older configuration manager; use Fetch instead
+            }
+        }
+
         GVariant *res = Call("Fetch");
         if (NULL == res)
         {
@@ -334,6 +394,44 @@ public:
 
 
 private:
+    /**
+     *  Retrieves a configuration profile passed back as a memfd
+     *
+     * @param method  D-Bus method returning the profile as a 'h' handle
+     *
+     * @return Returns a std::string with the configuration profile
+     */
+    std::string fetch_fd(const std::string& method)
+    {
+        GUnixFDList *fdlist = NULL;
+        GVariant *res = CallWithFDList(method, NULL, NULL, &fdlist);
+
+        gint32 handle = -1;
+        g_variant_get(res, "(h)", &handle);
+        g_variant_unref(res);
+        try
+        {
+            // The exported profile, JSON in particular, may be larger
+            // than the profile originally imported
+            std::string ret = MemfdPayload::Read(fdlist, handle,
+                                                 4 * ProfileParseLimits::MAX_PROFILE_SIZE);
+            if (fdlist)
+            {
+                g_object_unref(fdlist);
+            }
+            return ret;
+        }
+        catch (...)
+        {
+            if (fdlist)
+            {
+                g_object_unref(fdlist);
+            }
+            throw;
+        }
+    }
+
+
     std::string get_object_path(const GBusType bus_type, std::string target)
     {
         if (target[0] != '/')
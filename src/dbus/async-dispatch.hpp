@@ -0,0 +1,335 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   async-dispatch.hpp
+ *
+ * @brief  Worker pool used by DBusObject to run D-Bus method call
+ *         handlers outside of the GLib main loop thread.
+ */
+
+#ifndef OPENVPN3_DBUS_ASYNC_DISPATCH_HPP
+#define OPENVPN3_DBUS_ASYNC_DISPATCH_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <openvpn/common/rc.hpp>
+
+namespace openvpn
+{
+    /**
+     *  A simple fixed size pool of worker threads.  Jobs posted to this
+     *  pool are run in the order they arrive, on the first available
+     *  worker thread.
+     *
+     *  The pool does not provide any ordering guarantees between jobs
+     *  running on different workers.  Use a DBusAsyncStrand on top of
+     *  the pool when jobs needs to be serialized.
+     */
+    class DBusAsyncWorkerPool : public RC<thread_safe_refcount>
+    {
+    public:
+        typedef RCPtr<DBusAsyncWorkerPool> Ptr;
+
+        /**
+         *  Starts a new worker pool
+         *
+         * @param workers  Number of worker threads to start.  If 0, a
+         *                 single worker is started.
+         */
+        DBusAsyncWorkerPool(unsigned int workers)
+            : running(true)
+        {
+            if (0 == workers)
+            {
+                workers = 1;
+            }
+            for (unsigned int i = 0; i < workers; i++)
+            {
+                threads.push_back(std::thread([this]()
+                                              {
+                                                  worker_loop();
+                                              }));
+            }
+        }
+
+
+        ~DBusAsyncWorkerPool()
+        {
+            Shutdown();
+        }
+
+
+        /**
+         *  Queue a new job to be run by one of the worker threads
+         *
+         * @param job  std::function to execute.  Any exceptions thrown
+         *             by this function are caught and logged.
+         */
+        void Post(std::function<void()> job)
+        {
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                if (!running)
+                {
+                    THROW_DBUSEXCEPTION("DBusAsyncWorkerPool",
+                                        "Worker pool is shut down");
+                }
+                jobs.push_back(std::move(job));
+            }
+            job_available.notify_one();
+        }
+
+
+        /**
+         *  Stops all the worker threads.  Jobs already queued are
+         *  completed before the workers exits.  This will block until
+         *  all worker threads have completed.
+         */
+        void Shutdown()
+        {
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                if (!running)
+                {
+                    return;
+                }
+                running = false;
+            }
+            job_available.notify_all();
+
+            for (auto& t : threads)
+            {
+                if (t.joinable())
+                {
+                    t.join();
+                }
+            }
+            threads.clear();
+        }
+
+
+    private:
+        bool running;
+        std::mutex guard;
+        std::condition_variable job_available;
+        std::deque<std::function<void()>> jobs;
+        std::vector<std::thread> threads;
+
+
+        void worker_loop()
+        {
+            while (true)
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lk(guard);
+                    job_available.wait(lk, [this]()
+                                           {
+                                               return !running || !jobs.empty();
+                                           });
+                    if (jobs.empty())
+                    {
+                        // Only happens when the pool is shutting down
+                        return;
+                    }
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+
+                try
+                {
+                    job();
+                }
+                catch (std::exception& excp)
+                {
+                    std::cerr << "** ERROR ** Unhandled exception in "
+                              << "D-Bus worker thread: " << excp.what()
+                              << std::endl;
+                }
+            }
+        }
+    };
+
+
+
+    /**
+     *  Serializes jobs on top of a DBusAsyncWorkerPool.  All jobs posted
+     *  to the same strand are run one by one in the order they were
+     *  posted, but possibly on different worker threads.  Different
+     *  strands runs in parallel.
+     *
+     *  Each job carries a cancel function which is called instead of the
+     *  job itself if the strand is closed before the job got a chance to
+     *  run.  This is used to send an error back to the D-Bus caller
+     *  instead of leaving it waiting for a reply which never arrives.
+     */
+    class DBusAsyncStrand : public RC<thread_safe_refcount>
+    {
+    public:
+        typedef RCPtr<DBusAsyncStrand> Ptr;
+
+        DBusAsyncStrand(DBusAsyncWorkerPool::Ptr pool)
+            : pool(pool),
+              closed(false),
+              running(false)
+        {
+        }
+
+
+        /**
+         *  Queue a job on this strand.
+         *
+         * @param job     std::function to run on a worker thread
+         * @param cancel  std::function called if the strand is closed
+         *                before the job have been run
+         *
+         * @return Returns false if the strand is closed, the job is then
+         *         not queued and neither function is called.
+         */
+        bool Post(std::function<void()> job, std::function<void()> cancel)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            if (closed)
+            {
+                return false;
+            }
+            pending.push_back(StrandJob{std::move(job), std::move(cancel)});
+            if (!running)
+            {
+                running = true;
+                Ptr self(this);
+                pool->Post([self]()
+                           {
+                               self->run_pending();
+                           });
+            }
+            return true;
+        }
+
+
+        /**
+         *  Close the strand.  No more jobs will be accepted and all jobs
+         *  not yet started are cancelled.  This never waits for a job
+         *  currently running.
+         *
+         * @param idle  Optional std::function called once no job is
+         *              running on this strand any more.  If no job is
+         *              running, it is called before Close() returns.
+         *              Otherwise it is called from the worker thread
+         *              right after the running job has completed.
+         */
+        void Close(std::function<void()> idle = nullptr)
+        {
+            std::deque<StrandJob> cancelled;
+            bool call_idle = false;
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                closed = true;
+                cancelled.swap(pending);
+                if (running)
+                {
+                    on_idle = std::move(idle);
+                }
+                else
+                {
+                    call_idle = true;
+                }
+            }
+
+            for (auto& j : cancelled)
+            {
+                if (j.cancel)
+                {
+                    j.cancel();
+                }
+            }
+            if (call_idle && idle)
+            {
+                idle();
+            }
+        }
+
+
+    private:
+        struct StrandJob
+        {
+            std::function<void()> run;
+            std::function<void()> cancel;
+        };
+
+        DBusAsyncWorkerPool::Ptr pool;
+        std::mutex guard;
+        std::deque<StrandJob> pending;
+        std::function<void()> on_idle;
+        bool closed;
+        bool running;
+
+
+        void run_pending()
+        {
+            while (true)
+            {
+                StrandJob job;
+                std::function<void()> idle;
+                bool done = false;
+                {
+                    std::lock_guard<std::mutex> lg(guard);
+                    if (closed || pending.empty())
+                    {
+                        running = false;
+                        idle = std::move(on_idle);
+                        done = true;
+                    }
+                    else
+                    {
+                        job = std::move(pending.front());
+                        pending.pop_front();
+                    }
+                }
+                if (done)
+                {
+                    if (idle)
+                    {
+                        idle();
+                    }
+                    return;
+                }
+
+                try
+                {
+                    job.run();
+                }
+                catch (std::exception& excp)
+                {
+                    std::cerr << "** ERROR ** Unhandled exception in "
+                              << "D-Bus method handler: " << excp.what()
+                              << std::endl;
+                }
+            }
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_ASYNC_DISPATCH_HPP
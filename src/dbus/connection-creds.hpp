@@ -31,9 +31,15 @@
 
 #include <vector>
 #include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <tuple>
 #include <sys/types.h>
 
 #include "proxy.hpp"
+#include "visibility-index.hpp"
 
 using namespace openvpn;
 
@@ -73,21 +79,7 @@ namespace openvpn
          */
         uid_t GetUID(std::string busname)
         {
-            try
-            {
-                GVariant *result = Call("GetConnectionUnixUser",
-                                      g_variant_new("(s)", busname.c_str()));
-                uid_t ret;
-                g_variant_get(result, "(u)", &ret);
-                g_variant_unref(result);
-                return ret;
-            }
-            catch (DBusException& excp)
-            {
-                THROW_DBUSEXCEPTION("DBusConnectionCreds",
-                                    "Failed to retrieve UID for bus name '"
-                                    + busname + "': " + excp.getRawError());
-            }
+            return lookup_credentials(busname).uid;
         }
 
 
@@ -100,21 +92,331 @@ namespace openvpn
          */
         pid_t GetPID(std::string busname)
         {
+            return lookup_credentials(busname).pid;
+        }
+
+
+    private:
+        /**
+         *  Credentials of a D-Bus caller
+         */
+        struct Credentials
+        {
+            uid_t uid;
+            pid_t pid;
+        };
+
+
+        /**
+         *  Process wide cache of caller credentials, keyed by the D-Bus
+         *  connection and the unique bus name of the caller.
+         *
+         *  Unique bus names are never reused by the D-Bus daemon, so the
+         *  credentials of such a name can not change.  Entries are removed
+         *  when the NameOwnerChanged signal reports the caller has
+         *  disconnected from the bus.  Well-known bus names may move
+         *  between processes and are never cached.
+         *
+         *  The NameOwnerChanged subscription is set up by Lookup(), before
+         *  the credentials are queried.  A caller leaving the bus before
+         *  its credentials are stored is remembered for a while, so
+         *  Store() does not cache it.
+         *
+         *  The cache holds a reference to each connection it watches.
+         *  When the connection is closed, the NameOwnerChanged
+         *  subscription and all entries for it are dropped and the
+         *  reference is released.
+         */
+        class CredentialsCache
+        {
+        public:
+            static CredentialsCache& Instance()
+            {
+                static CredentialsCache cache;
+                return cache;
+            }
+
+
+            /**
+             *  Looks up cached credentials.  On a cache miss, the
+             *  connection is watched for callers leaving the bus, before
+             *  the caller queries and stores the credentials.
+             *
+             * @return Returns true if the credentials were found
+             */
+            bool Lookup(GDBusConnection *conn, const std::string& busname,
+                        Credentials& creds)
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                auto it = entries.find(CacheKey(conn, busname));
+                if (entries.end() != it)
+                {
+                    creds = it->second;
+                    return true;
+                }
+                if (!busname.empty() && ':' == busname[0])
+                {
+                    watch(conn);
+                }
+                return false;
+            }
+
+
+            void Store(GDBusConnection *conn, const std::string& busname,
+                       const Credentials& creds)
+            {
+                if (busname.empty() || ':' != busname[0])
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lg(guard);
+                CacheKey key(conn, busname);
+                if (watched.end() == watched.find(conn)
+                    || departed.end() != departed.find(key))
+                {
+                    // Not watched as the connection is closed, or the
+                    // caller left the bus while being looked up
+                    return;
+                }
+                entries[key] = creds;
+            }
+
+
+        private:
+            typedef std::tuple<GDBusConnection *, std::string> CacheKey;
+
+            struct ConnectionWatch
+            {
+                guint subscription;
+                gulong closed_handler;
+            };
+
+            /**
+             *  Callers which left the bus are remembered until this many
+             *  more have left.  This only needs to cover the callers
+             *  leaving while their credentials are queried.
+             */
+            static const size_t MaxDeparted = 256;
+
+            std::mutex guard;
+            std::map<CacheKey, Credentials> entries;
+            std::map<GDBusConnection *, ConnectionWatch> watched;
+            std::set<CacheKey> departed;
+            std::deque<CacheKey> departed_order;
+
+
+            /**
+             *  Subscribes to NameOwnerChanged once per connection.  The
+             *  caller must hold the lock.
+             */
+            void watch(GDBusConnection *conn)
+            {
+                if (watched.end() != watched.find(conn)
+                    || g_dbus_connection_is_closed(conn))
+                {
+                    return;
+                }
+
+                // Only signals where the old owner is a unique name
+                // leaving the bus are interesting, which is filtered
+                // in the signal handler.
+                ConnectionWatch w;
+                w.subscription = g_dbus_connection_signal_subscribe(conn,
+                                                   "org.freedesktop.DBus",
+                                                   "org.freedesktop.DBus",
+                                                   "NameOwnerChanged",
+                                                   "/org/freedesktop/DBus",
+                                                   NULL,
+                                                   G_DBUS_SIGNAL_FLAGS_NONE,
+                                                   name_owner_changed,
+                                                   this,
+                                                   NULL);
+                w.closed_handler = g_signal_connect(conn, "closed",
+                                                    G_CALLBACK(connection_closed),
+                                                    this);
+                g_object_ref(conn);
+                watched[conn] = w;
+            }
+
+
+            void evict(GDBusConnection *conn, const std::string& busname)
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                CacheKey key(conn, busname);
+                entries.erase(key);
+
+                if (departed.insert(key).second)
+                {
+                    departed_order.push_back(key);
+                    if (departed_order.size() > MaxDeparted)
+                    {
+                        departed.erase(departed_order.front());
+                        departed_order.pop_front();
+                    }
+                }
+            }
+
+
+            /**
+             *  Drops everything related to a connection and releases the
+             *  reference held on it.
+             *
+             * @param conn  GDBusConnection which has been closed
+             */
+            void forget(GDBusConnection *conn)
+            {
+                {
+                    std::lock_guard<std::mutex> lg(guard);
+                    auto w = watched.find(conn);
+                    if (watched.end() == w)
+                    {
+                        return;
+                    }
+                    g_dbus_connection_signal_unsubscribe(conn, w->second.subscription);
+                    g_signal_handler_disconnect(conn, w->second.closed_handler);
+                    watched.erase(w);
+
+                    // Keys sort on the connection first, so all its
+                    // entries are adjacent.
+                    auto it = entries.lower_bound(CacheKey(conn, ""));
+                    while (entries.end() != it && std::get<0>(it->first) == conn)
+                    {
+                        it = entries.erase(it);
+                    }
+
+                    for (auto d = departed_order.begin(); d != departed_order.end();)
+                    {
+                        if (std::get<0>(*d) == conn)
+                        {
+                            departed.erase(*d);
+                            d = departed_order.erase(d);
+                        }
+                        else
+                        {
+                            ++d;
+                        }
+                    }
+                }
+                g_object_unref(conn);
+            }
+
+
+            static void connection_closed(GDBusConnection *conn,
+                                          gboolean remote_peer_vanished,
+                                          GError *error,
+                                          gpointer this_ptr)
+            {
+                CredentialsCache *cache = (CredentialsCache *) this_ptr;
+                cache->forget(conn);
+            }
+
+
+            static void name_owner_changed(GDBusConnection *conn,
+                                           const gchar *sender,
+                                           const gchar *obj_path,
+                                           const gchar *intf_name,
+                                           const gchar *signal_name,
+                                           GVariant *params,
+                                           gpointer this_ptr)
+            {
+                const gchar *name = NULL;
+                const gchar *old_owner = NULL;
+                const gchar *new_owner = NULL;
+                g_variant_get(params, "(&s&s&s)", &name, &old_owner, &new_owner);
+
+                // A unique name leaving the bus is reported with the
+                // unique name itself as both name and old owner, and an
+                // empty new owner.
+                if (':' == name[0] && '\0' == new_owner[0])
+                {
+                    CredentialsCache *cache = (CredentialsCache *) this_ptr;
+                    cache->evict(conn, std::string(name));
+                }
+            }
+        };
+
+
+        /**
+         *  Retrieves the credentials of a D-Bus caller, from the cache if
+         *  available.  Otherwise both the UID and PID are retrieved in a
+         *  single GetConnectionCredentials() call to the D-Bus daemon.
+         *
+         * @param busname  String containing the bus name for the query
+         * @return Returns a Credentials struct with the UID and PID.
+         *         In case of errors, a DBusException is thrown.
+         */
+        Credentials lookup_credentials(const std::string& busname)
+        {
+            Credentials ret;
+            if (CredentialsCache::Instance().Lookup(GetConnection(), busname, ret))
+            {
+                return ret;
+            }
+
+            bool have_uid = false;
+            bool have_pid = false;
             try
             {
-                GVariant *result = Call("GetConnectionUnixProcessID",
-                                      g_variant_new("(s)", busname.c_str()));
-                pid_t ret;
-                g_variant_get(result, "(u)", &ret);
+                GVariant *result = Call("GetConnectionCredentials",
+                                        g_variant_new("(s)", busname.c_str()));
+                GVariant *dict = g_variant_get_child_value(result, 0);
+                guint32 val = 0;
+                if (g_variant_lookup(dict, "UnixUserID", "u", &val))
+                {
+                    ret.uid = val;
+                    have_uid = true;
+                }
+                if (g_variant_lookup(dict, "ProcessID", "u", &val))
+                {
+                    ret.pid = val;
+                    have_pid = true;
+                }
+                g_variant_unref(dict);
                 g_variant_unref(result);
-                return ret;
             }
             catch (DBusException& excp)
             {
-                THROW_DBUSEXCEPTION("DBusConnectionCreds",
-                                    "Failed to retrieve process ID for bus name '"
-                                    + busname + "': " + excp.getRawError());
+                // Older D-Bus daemons lacks GetConnectionCredentials(),
+                // the values are then retrieved one by one below
             }
+
+            if (!have_uid)
+            {
+                try
+                {
+                    GVariant *result = Call("GetConnectionUnixUser",
+                                            g_variant_new("(s)", busname.c_str()));
+                    g_variant_get(result, "(u)", &ret.uid);
+                    g_variant_unref(result);
+                }
+                catch (DBusException& excp)
+                {
+                    THROW_DBUSEXCEPTION("DBusConnectionCreds",
+                                        "Failed to retrieve UID for bus name '"
+                                        + busname + "': " + excp.getRawError());
+                }
+            }
+
+            if (!have_pid)
+            {
+                try
+                {
+                    GVariant *result = Call("GetConnectionUnixProcessID",
+                                            g_variant_new("(s)", busname.c_str()));
+                    g_variant_get(result, "(u)", &ret.pid);
+                    g_variant_unref(result);
+                }
+                catch (DBusException& excp)
+                {
+                    THROW_DBUSEXCEPTION("DBusConnectionCreds",
+                                        "Failed to retrieve process ID for bus name '"
+                                        + busname + "': " + excp.getRawError());
+                }
+            }
+
+            CredentialsCache::Instance().Store(GetConnection(), busname, ret);
+            return ret;
         }
     };
 
@@ -136,24 +438,33 @@ namespace openvpn
         DBusCredentialsException(uid_t requester, std::string quarkdomain, std::string error)
             : requester(requester), quarkdomain(quarkdomain), error(error)
         {
-            std::stringstream s;
-            s << error << " (Requester UID "<< requester << ")";
-            error_uid = s.str();
         }
 
         virtual ~DBusCredentialsException() throw() {}
 
         virtual const char* what() const throw()
         {
-            std::stringstream ret;
-            ret << "[DBusCredentialsException"
-                << "] " << error;
-            return ret.str().c_str();
+            if (what_msg.empty())
+            {
+                what_msg = "[DBusCredentialsException] " + error;
+            }
+            return what_msg.c_str();
         }
 
+        /**
+         *  Retrieve the error message, including the rejected UID.  The
+         *  message is only put together when requested.
+         *
+         * @return Returns a const std::string reference to the message
+         */
         const std::string& err() const noexcept
         {
-            return std::move(error_uid);
+            if (error_uid.empty())
+            {
+                error_uid = error + " (Requester UID "
+                            + std::to_string(requester) + ")";
+            }
+            return error_uid;
         }
 
         const std::string getUserError() const noexcept
@@ -201,7 +512,8 @@ private:
         uid_t requester;
         std::string quarkdomain;
         std::string error;
-        std::string error_uid;
+        mutable std::string error_uid;
+        mutable std::string what_msg;
     };
 
 
@@ -211,10 +523,29 @@ private:
      *  users allowed to get access.  If SetPublicAccess(true) is called,
      *  then the ACL check is skipped and everyone have access.  An owner
      *  will always have access, regardless of the ACL lists contents.
+     *
+     *  The granted UIDs are kept as a sorted set.  EvaluateACL() returns
+     *  the access decision without throwing on denial, which is what
+     *  callers checking many objects or properties should use.
+     *  CheckACL() and CheckOwnerAccess() throw a DBusCredentialsException
+     *  on denial, for method call handlers replying with a D-Bus error.
+     *  The ACL may be used and modified from several threads.
      */
     class DBusCredentials : public DBusConnectionCreds
     {
     public:
+        /**
+         *  Result of an access control check
+         */
+        enum class ACLDecision
+        {
+            DENY,     /**< Access denied */
+            ALLOW,    /**< Granted via the ACL or public access */
+            OWNER,    /**< Caller is the object owner */
+            ROOT      /**< Caller is root, and root access was allowed */
+        };
+
+
         /**
          *   Initializes the ACL check object
          *
@@ -230,6 +561,34 @@ private:
         }
 
 
+        virtual ~DBusCredentials()
+        {
+            if (visibility)
+            {
+                visibility->Remove(visibility_path);
+            }
+        }
+
+
+        /**
+         *  Attaches this object to a visibility index, which will be kept
+         *  up-to-date with the owner, ACL and public access attribute of
+         *  this object until it is destroyed.
+         *
+         * @param index  DBusVisibilityIndex::Ptr to the index to update
+         * @param path   std::string with the D-Bus object path this
+         *               object is listed as in the index
+         */
+        void SetVisibilityIndex(DBusVisibilityIndex::Ptr index,
+                                const std::string& path)
+        {
+            std::lock_guard<std::mutex> lg(acl_guard);
+            visibility = index;
+            visibility_path = path;
+            update_visibility();
+        }
+
+
         /**
          *  Returns this objects owner's UID
          *
@@ -251,7 +610,9 @@ private:
          */
         void SetPublicAccess(bool public_access)
         {
+            std::lock_guard<std::mutex> lg(acl_guard);
             acl_public = public_access;
+            update_visibility();
         }
 
 
@@ -262,13 +623,14 @@ private:
          */
         GVariant * GetPublicAccess()
         {
+            std::lock_guard<std::mutex> lg(acl_guard);
             return g_variant_new_boolean(acl_public);
         }
 
 
         /**
-         *  Retrieve the ACL list of UIDs granted access.  The owner UID
-         *  is not enlisted.
+         *  Retrieve the ACL list of UIDs granted access, in ascending
+         *  order.  The owner UID is not enlisted.
          *
          * @return  Returns a GVariant object containing an array of uid_t
          */
@@ -276,10 +638,12 @@ private:
         {
             GVariant *ret = NULL;
             GVariantBuilder *bld = g_variant_builder_new(G_VARIANT_TYPE("au"));
+            std::unique_lock<std::mutex> lk(acl_guard);
             for (auto& e : acl_list)
             {
                 g_variant_builder_add(bld, "u", e);
             }
+            lk.unlock();
             ret = g_variant_builder_end(bld);
             g_variant_builder_unref(bld);
 
@@ -294,17 +658,17 @@ private:
          */
         void GrantAccess(uid_t uid)
         {
-            for (auto& acl_uid : acl_list)
+            std::lock_guard<std::mutex> lg(acl_guard);
+            auto it = std::lower_bound(acl_list.begin(), acl_list.end(), uid);
+            if (acl_list.end() != it && *it == uid)
             {
-                if (acl_uid == uid)
-                {
-                    throw DBusCredentialsException(owner,
-                                                   "net.openvpn.v3.error.acl.duplicate",
-                                                   "UID already granted access");
-                }
+                throw DBusCredentialsException(owner,
+                                               "net.openvpn.v3.error.acl.duplicate",
+                                               "UID already granted access");
             }
 
-            acl_list.push_back(uid);
+            acl_list.insert(it, uid);
+            update_visibility();
         }
 
 
@@ -315,18 +679,72 @@ private:
          */
         void RevokeAccess(uid_t uid)
         {
-            for (auto& acl_uid : acl_list)
+            std::lock_guard<std::mutex> lg(acl_guard);
+            auto it = std::lower_bound(acl_list.begin(), acl_list.end(), uid);
+            if (acl_list.end() == it || *it != uid)
+            {
+                throw DBusCredentialsException(owner,
+                                               "net.openvpn.v3.error.acl.nogrant",
+                                               "UID is not listed in access list");
+            }
+
+            acl_list.erase(it);
+            update_visibility();
+        }
+
+
+        /**
+         *  Evaluates the access of a D-Bus caller, without throwing an
+         *  exception if access is denied.
+         *
+         *  If the public access attribute is set to true, access is
+         *  granted unless this is an owner-only check.  Owner-only checks
+         *  only grant access to the object owner, or root if allowed.
+         *
+         * @param sender      String containing the callers D-Bus bus name
+         * @param owner_only  Only allow the owner of the object?
+         * @param allow_root  Allow root (uid=0) regardless of ACL?
+         *
+         * @return Returns the ACLDecision.  A DBusException is thrown if
+         *         the UID of the caller could not be retrieved.
+         */
+        ACLDecision EvaluateACL(const std::string& sender,
+                                bool owner_only = false,
+                                bool allow_root = false)
+        {
             {
-                if (acl_uid == uid)
+                std::lock_guard<std::mutex> lg(acl_guard);
+                if (acl_public && !owner_only)
                 {
-                    acl_list.erase(std::remove(acl_list.begin(), acl_list.end(), uid), acl_list.end());
-                    return;
+                    return ACLDecision::ALLOW;
                 }
             }
 
-            throw DBusCredentialsException(owner,
-                                           "net.openvpn.v3.error.acl.nogrant",
-                                           "UID is not listed in access list");
+            // The UID lookup is a D-Bus call; don't hold the lock for it
+            uid_t uid = GetUID(sender);
+            std::lock_guard<std::mutex> lg(acl_guard);
+            return evaluate_acl(uid, owner_only, allow_root);
+        }
+
+
+        /**
+         *  Creates the exception describing an access denial of a
+         *  D-Bus caller, as thrown by CheckACL() and CheckOwnerAccess().
+         *  Useful for callers of EvaluateACL() which needs to send a
+         *  D-Bus error reply or log the denial.
+         *
+         * @param sender      String containing the callers D-Bus bus name
+         * @param owner_only  Was this an owner-only check?
+         *
+         * @return Returns a DBusCredentialsException
+         */
+        DBusCredentialsException AccessDenied(const std::string& sender,
+                                              bool owner_only = false)
+        {
+            return DBusCredentialsException(GetUID(sender),
+                                            "net.openvpn.v3.error.acl.denied",
+                                            (owner_only ? "Owner access denied"
+                                                        : "Access denied"));
         }
 
 
@@ -372,64 +790,74 @@ private:
 
     private:
         uid_t owner;
+        std::mutex acl_guard;
         bool acl_public;
         std::vector<uid_t> acl_list;
+        DBusVisibilityIndex::Ptr visibility;
+        std::string visibility_path;
 
 
         /**
-         *  Core authorization method.  It will retrieve the users UID based
-         *  on the D-Bus senders bus name and verify that UID value against
-         *  the ACL, the object owners UID, or even root (uid=0) if allowed.
-         *
-         *  If the public access attribute is set to true, authorization is
-         *  skipped - but only for non-owner-only queries.  Owner-only checks
-         *  will only succeed if the D-Bus caller is the object owner or root
-         *  (if allowed)
-         *
-         *  In case of authorization failure, a DBusCredentialsException
-         *  is thrown.
+         *  Updates the visibility index with the current access
+         *  information, if this object is attached to an index.
+         *  Must be called with acl_guard held.
+         */
+        void update_visibility()
+        {
+            if (visibility)
+            {
+                visibility->Update(visibility_path, owner, acl_list, acl_public);
+            }
+        }
+
+
+        /**
+         *  Throwing variant of EvaluateACL().  In case of authorization
+         *  failure, a DBusCredentialsException is thrown.
          *
          * @param sender      String containing the callers D-Bus bus name
          * @param owner_only  Only allow the owner of the object?
          * @param allow_root  Allow root (uid=0) regardless of ACL?
          */
-        void check_acl(const std::string sender, bool owner_only, bool allow_root)
+        void check_acl(const std::string& sender, bool owner_only, bool allow_root)
         {
-            if (acl_public && !owner_only)
+            if (ACLDecision::DENY == EvaluateACL(sender, owner_only, allow_root))
             {
-                return;
+                throw AccessDenied(sender, owner_only);
             }
+        }
 
-            uid_t sender_uid = GetUID(sender);
 
-            if (sender_uid == owner)
+        /**
+         *  Evaluates the access of a UID against the object owner, root
+         *  and the ACL.  The public access attribute is not considered.
+         *  Must be called with acl_guard held.
+         *
+         * @param uid         uid_t of the caller
+         * @param owner_only  Only allow the owner of the object?
+         * @param allow_root  Allow root (uid=0) regardless of ACL?
+         *
+         * @return Returns the ACLDecision
+         */
+        ACLDecision evaluate_acl(uid_t uid, bool owner_only, bool allow_root) const
+        {
+            if (uid == owner)
             {
-                return;
+                return ACLDecision::OWNER;
             }
-
-            if (allow_root && sender_uid == 0)
+            if (allow_root && 0 == uid)
             {
-                return;
+                return ACLDecision::ROOT;
             }
-
             if (owner_only)
             {
-                throw DBusCredentialsException(sender_uid,
-                                               "net.openvpn.v3.error.acl.denied",
-                                               "Owner access denied"
-                                               );
+                return ACLDecision::DENY;
             }
-
-            for (auto& acl_uid : acl_list)
+            if (std::binary_search(acl_list.begin(), acl_list.end(), uid))
             {
-                if (acl_uid == sender_uid)
-                {
-                    return;
-                }
+                return ACLDecision::ALLOW;
             }
-            throw DBusCredentialsException(sender_uid,
-                                           "net.openvpn.v3.error.acl.denied",
-                                           "Access denied");
+            return ACLDecision::DENY;
         }
     };
 };
@@ -42,6 +42,12 @@ const std::string OpenVPN3DBus_name_sessions = "net.openvpn.v3.sessions";
 const std::string OpenVPN3DBus_rootp_sessions = "/net/openvpn/v3/sessions";
 const std::string OpenVPN3DBus_interf_sessions = "net.openvpn.v3.sessions";
 
+/* Private peer-to-peer D-Bus address of the session manager, used by the
+ * VPN client backends to communicate with the session manager without
+ * passing the D-Bus daemon
+ */
+const std::string OpenVPN3DBus_p2p_sessions = "unix:abstract=net.openvpn.v3.sessions";
+
 /* Backend manager interface -> session manager's interface to start and
  * communicate with VPN client backends
  */
@@ -81,7 +87,7 @@ const std::array<const std::string, StatusMajorCount> StatusMajor_str = {
         "Process"
 };
 
-const uint8_t StatusMinorCount = 30;
+const uint8_t StatusMinorCount = 31;
 enum class  StatusMinor : std::uint_fast16_t {
         UNSET,                       /**< An invalid result code, used for initialization */
 
@@ -118,6 +124,7 @@ enum class  StatusMinor : std::uint_fast16_t {
         PROC_STARTED,                /**< Successfully started a new process */
         PROC_STOPPED,                /**< A process of ours stopped as expected */
         PROC_KILLED,                 /**< A process of ours stopped unexpectedly */
+        PROC_STARTING,               /**< A new process is being started */
 };
 
 const std::array<const std::string, StatusMinorCount> StatusMinor_str = {
@@ -155,7 +162,8 @@ const std::array<const std::string, StatusMinorCount> StatusMinor_str = {
 
         "Process started",
         "Process stopped",
-        "Process killed"
+        "Process killed",
+        "Process starting"
 };
 
 
@@ -89,6 +89,21 @@ namespace openvpn
 
 #define THROW_DBUSEXCEPTION(classname, fault_data) throw DBusException(classname, fault_data, __FILE__, __LINE__, __FUNCTION__)
 
+
+    /**
+     *  Thrown when a called D-Bus method is not provided by the remote
+     *  object.  This is typically an older version of a service, which
+     *  allows callers to fall back to an older method.
+     */
+    class DBusUnknownMethodException : public DBusException
+    {
+    public:
+        DBusUnknownMethodException(const std::string classn, const std::string& err, const char *filen, const unsigned int linenum, const char *fn) noexcept
+        : DBusException(classn, err, filen, linenum, fn)
+        {
+        }
+    };
+
     /**
      *  Specian exception classes used by set/get properties calls.
      *  exceptions will be translated into a D-Bus error which the
@@ -20,14 +20,27 @@
 #ifndef OPENVPN3_DBUS_IDLECHECK_HPP
 #define OPENVPN3_DBUS_IDLECHECK_HPP
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
-#include <memory>
-#include <thread>
+#include <mutex>
 
 #include <openvpn/common/rc.hpp>
 
 using namespace openvpn;
 
+/**
+ *  Stops the main loop when the process has been idle for a while.
+ *
+ *  The check is driven by a GLib timeout source on the main loop's
+ *  context, armed to fire when the idle time would run out.  When it
+ *  fires and an operation has happened since it was armed, it is re-armed
+ *  for the remaining idle time.  While references are held, no timeout is
+ *  armed at all; it is armed again when the last reference is released.
+ *
+ *  UpdateTimestamp(), RefCountInc() and RefCountDec() can be called from
+ *  any thread.  g_main_loop_quit() is always called from the main loop.
+ */
 class IdleCheck : public RC<thread_safe_refcount>
 {
 public:
@@ -35,106 +48,155 @@ public:
 
     IdleCheck(GMainLoop *mainloop, std::chrono::duration<double> idle_time)
         : mainloop(mainloop),
-          idle_time(idle_time),
-          poll_time(idle_time),
+          idle_time(std::chrono::duration_cast<std::chrono::steady_clock::duration>(idle_time)),
           enabled(false),
-          running(false),
+          timeout_src(nullptr),
           refcount(0)
     {
             UpdateTimestamp();
     }
 
 
-    void UpdateTimestamp()
+    ~IdleCheck()
     {
-        last_operation = std::chrono::system_clock::now();
+        Disable();
     }
 
 
-    void SetPollTime(std::chrono::duration<double> pollt)
+    void UpdateTimestamp()
     {
-        poll_time = pollt;
+        last_operation = std::chrono::steady_clock::now().time_since_epoch().count();
     }
 
 
     void Enable()
     {
-        if (running)
-        {
-            return;
-        }
-
+        std::lock_guard<std::mutex> lg(guard);
         if (enabled)
         {
             return;
         }
-
         enabled = true;
-        idle_checker.reset(new std::thread([self=Ptr(this)]()
-                           {
-                               self->_cb_idlechecker__loop();
-                           }));
+        arm();
     }
 
 
     void Disable()
     {
+        std::lock_guard<std::mutex> lg(guard);
         enabled = false;
+        disarm();
     }
 
 
     void RefCountInc()
     {
+        // The timeout source is left as is; it will not be re-armed
+        // when it fires while references are held.
         refcount++;
     }
 
 
     void RefCountDec()
     {
-        refcount--;
+        if (0 == --refcount)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            if (enabled)
+            {
+                arm();
+            }
+        }
     }
 
 
-    void Join()
+private:
+    GMainLoop *mainloop;
+    std::chrono::steady_clock::duration idle_time;
+    bool enabled;
+    GSource *timeout_src;
+    std::mutex guard;
+    std::atomic<unsigned int> refcount;
+    std::atomic<std::chrono::steady_clock::rep> last_operation;
+
+
+    /**
+     *  Arms the timeout source to fire when the idle time runs out,
+     *  replacing any already armed source.  The caller must hold the lock.
+     */
+    void arm()
     {
-        idle_checker->join();
+        disarm();
+
+        std::chrono::steady_clock::time_point last(
+                std::chrono::steady_clock::duration(last_operation.load()));
+        auto remaining = (last + idle_time) - std::chrono::steady_clock::now();
+        guint delay = 0;
+        if (remaining.count() > 0)
+        {
+            // Round up, to not wake up just before the deadline
+            delay = std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count() + 1;
+        }
+
+        timeout_src = g_timeout_source_new(delay);
+        g_source_set_callback(timeout_src, _cb_idle_timeout, this, NULL);
+        g_source_attach(timeout_src, g_main_loop_get_context(mainloop));
     }
 
 
-    void _cb_idlechecker__loop()
+    /**
+     *  Removes the armed timeout source, if any.  The caller must hold
+     *  the lock.
+     */
+    void disarm()
     {
-        running = true;
-        while( enabled )
+        if (timeout_src)
         {
-            // FIXME: Consider to swap sleep_for() with
-            // std::condition_variable::wait_for() which can
-            // unlock on cv.notify_one() call.
-            std::this_thread::sleep_for(poll_time);
-            auto now = std::chrono::system_clock::now();
-            if (0 == refcount && (last_operation + idle_time) < now)
-            {
-                // We timed out, start the main loop shutdown
-#ifdef SHUTDOWN_NOTIF_PROCESS_NAME
-            std::cout << SHUTDOWN_NOTIF_PROCESS_NAME
-                      << " starting idle shutdown "
-                      << "(pid: " << std::to_string(getpid()) << ")"
-                      << std::endl;
-#endif
-                g_main_loop_quit(mainloop);
-                enabled = false;
-            }
+            g_source_destroy(timeout_src);
+            g_source_unref(timeout_src);
+            timeout_src = nullptr;
         }
-        running = false;
     }
 
-private:
-    GMainLoop *mainloop;
-    std::chrono::duration<double> idle_time;
-    std::chrono::duration<double> poll_time;
-    bool enabled;
-    bool running;
-    uint16_t refcount;
-    std::chrono::time_point<std::chrono::system_clock> last_operation;
-    std::unique_ptr<std::thread> idle_checker;
+
+    static gboolean _cb_idle_timeout(gpointer this_ptr)
+    {
+        IdleCheck *self = (IdleCheck *) this_ptr;
+        std::lock_guard<std::mutex> lg(self->guard);
+
+        if (g_main_current_source() != self->timeout_src)
+        {
+            // Re-armed from another thread while this source fired
+            return G_SOURCE_REMOVE;
+        }
+
+        // This source is done; a new one is armed if needed
+        g_source_unref(self->timeout_src);
+        self->timeout_src = nullptr;
+
+        if (!self->enabled || self->refcount > 0)
+        {
+            return G_SOURCE_REMOVE;
+        }
+
+        std::chrono::steady_clock::time_point last(
+                std::chrono::steady_clock::duration(self->last_operation.load()));
+        if ((last + self->idle_time) > std::chrono::steady_clock::now())
+        {
+            self->arm();
+            return G_SOURCE_REMOVE;
+        }
+
+        // We timed out, start the main loop shutdown
+#ifdef SHUTDOWN_NOTIF_PROCESS_NAME
+        std::cout << SHUTDOWN_NOTIF_PROCESS_NAME
+                  << " starting idle shutdown "
+                  << "(pid: " << std::to_string(getpid()) << ")"
+                  << std::endl;
+#endif
+        self->enabled = false;
+        g_main_loop_quit(self->mainloop);
+        return G_SOURCE_REMOVE;
+    }
 };
 #endif // OPENVPN3_DBUS_IDLECHECK_HPP
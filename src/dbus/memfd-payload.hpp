@@ -0,0 +1,239 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   memfd-payload.hpp
+ *
+ * @brief  Passing large payloads over D-Bus as sealed memfd file
+ *         descriptors instead of string arguments.
+ */
+
+#ifndef OPENVPN3_DBUS_MEMFD_PAYLOAD_HPP
+#define OPENVPN3_DBUS_MEMFD_PAYLOAD_HPP
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <gio/gunixfdlist.h>
+
+#ifndef MFD_CLOEXEC
+#include <linux/memfd.h>
+#endif
+
+// Older C libraries lacks the file sealing definitions
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SEAL   0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW   0x0004
+#define F_SEAL_WRITE  0x0008
+#endif
+
+#include "dbus/exceptions.hpp"
+
+namespace openvpn
+{
+    /**
+     *  Creates a memfd file descriptor containing a payload, which is
+     *  sealed against any further modifications.  The receiver of the
+     *  file descriptor can then map it without any risk of the content
+     *  changing or the file shrinking underneath it.
+     *
+     *  The payload passes the D-Bus daemon as a file descriptor only, the
+     *  content itself is not copied by D-Bus nor GVariant.
+     */
+    class MemfdPayload
+    {
+    public:
+        /**
+         *  Creates a sealed memfd with the given payload
+         *
+         * @param data  std::string with the payload
+         */
+        MemfdPayload(const std::string& data)
+            : fd(-1)
+        {
+            fd = syscall(SYS_memfd_create, "openvpn3-payload",
+                         MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            if (fd < 0)
+            {
+                THROW_DBUSEXCEPTION("MemfdPayload",
+                                    "Could not create memfd: "
+                                    + std::string(strerror(errno)));
+            }
+
+            size_t written = 0;
+            while (written < data.size())
+            {
+                ssize_t r = write(fd, data.data() + written,
+                                  data.size() - written);
+                if (r < 0)
+                {
+                    if (EINTR == errno)
+                    {
+                        continue;
+                    }
+                    fail("Could not write payload");
+                }
+                written += r;
+            }
+
+            if (0 != fcntl(fd, F_ADD_SEALS,
+                           F_SEAL_SHRINK | F_SEAL_GROW
+                           | F_SEAL_WRITE | F_SEAL_SEAL))
+            {
+                fail("Could not seal payload");
+            }
+        }
+
+
+        ~MemfdPayload()
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+
+
+        /**
+         *  Creates a GUnixFDList containing a duplicate of the memfd,
+         *  to be sent along with a D-Bus message.  The payload is
+         *  referenced as handle 0 in the message arguments.
+         *
+         * @return Returns a new GUnixFDList, which the caller must release
+         *         with g_object_unref()
+         */
+        GUnixFDList * GetFDList() const
+        {
+            GError *error = NULL;
+            GUnixFDList *fdlist = g_unix_fd_list_new();
+            if (g_unix_fd_list_append(fdlist, fd, &error) < 0)
+            {
+                std::string errmsg(error ? error->message : "(unknown)");
+                if (error)
+                {
+                    g_error_free(error);
+                }
+                g_object_unref(fdlist);
+                THROW_DBUSEXCEPTION("MemfdPayload",
+                                    "Could not pass payload: " + errmsg);
+            }
+            return fdlist;
+        }
+
+
+        /**
+         *  Reads a payload from a file descriptor received over D-Bus.
+         *  The file descriptor must be a sealed memfd, as created by this
+         *  class.  The content is mapped directly from the memfd.
+         *
+         * @param fdlist    GUnixFDList received with the D-Bus message
+         * @param handle    Handle index of the payload, from the 'h'
+         *                  argument in the D-Bus message
+         * @param max_size  Maximum payload size accepted
+         *
+         * @return Returns a std::string with the payload
+         */
+        static std::string Read(GUnixFDList *fdlist, gint32 handle,
+                                size_t max_size)
+        {
+            if (NULL == fdlist || handle < 0
+                || handle >= g_unix_fd_list_get_length(fdlist))
+            {
+                THROW_DBUSEXCEPTION("MemfdPayload",
+                                    "No payload file descriptor received");
+            }
+
+            GError *error = NULL;
+            int payload_fd = g_unix_fd_list_get(fdlist, handle, &error);
+            if (payload_fd < 0)
+            {
+                std::string errmsg(error ? error->message : "(unknown)");
+                if (error)
+                {
+                    g_error_free(error);
+                }
+                THROW_DBUSEXCEPTION("MemfdPayload",
+                                    "Invalid payload file descriptor: "
+                                    + errmsg);
+            }
+
+            // Without these seals, the sender could change or truncate
+            // the content while it is mapped.
+            int seals = fcntl(payload_fd, F_GET_SEALS);
+            int required = F_SEAL_SHRINK | F_SEAL_WRITE;
+            struct stat st;
+            if (seals < 0 || (seals & required) != required
+                || 0 != fstat(payload_fd, &st))
+            {
+                close(payload_fd);
+                THROW_DBUSEXCEPTION("MemfdPayload",
+                                    "Payload is not a sealed memfd");
+            }
+            if ((size_t) st.st_size > max_size)
+            {
+                close(payload_fd);
+                THROW_DBUSEXCEPTION("MemfdPayload", "Payload is too large");
+            }
+            if (0 == st.st_size)
+            {
+                close(payload_fd);
+                return "";
+            }
+
+            void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                              payload_fd, 0);
+            close(payload_fd);
+            if (MAP_FAILED == data)
+            {
+                THROW_DBUSEXCEPTION("MemfdPayload",
+                                    "Could not map payload: "
+                                    + std::string(strerror(errno)));
+            }
+            std::string ret((const char *) data, st.st_size);
+            munmap(data, st.st_size);
+            return ret;
+        }
+
+
+    private:
+        int fd;
+
+        MemfdPayload(const MemfdPayload&) = delete;
+        MemfdPayload& operator=(const MemfdPayload&) = delete;
+
+
+        void fail(const std::string& msg)
+        {
+            std::string errmsg = msg + ": " + std::string(strerror(errno));
+            close(fd);
+            fd = -1;
+            THROW_DBUSEXCEPTION("MemfdPayload", errmsg);
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_MEMFD_PAYLOAD_HPP
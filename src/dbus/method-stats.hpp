@@ -0,0 +1,533 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   method-stats.hpp
+ *
+ * @brief  Per D-Bus method call counters and latency histograms for
+ *         all D-Bus objects in a process
+ */
+
+#ifndef OPENVPN3_DBUS_METHOD_STATS_HPP
+#define OPENVPN3_DBUS_METHOD_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace openvpn
+{
+    const std::string DBusMethodStats_interf = "net.openvpn.v3.debug";
+
+
+    /**
+     *  Collects call counts, error counts and latency histograms for each
+     *  D-Bus method handled by the DBusObjects of this process.
+     *
+     *  The latency of a method call is measured from the method call being
+     *  dispatched until the reply is sent, which also covers calls handled
+     *  by the async worker pool or replied to later on.  Replies are seen
+     *  by a filter on each D-Bus connection, which is also where error
+     *  replies are counted.  Calls not expecting a reply are only counted.
+     *
+     *  The calls waiting for a reply are kept per connection, each with
+     *  its own lock.  The counters of a method are atomics, so recording
+     *  a call does not need any process-wide lock.
+     *
+     *  The latency histograms use power-of-two buckets in microseconds.
+     *  Bucket 0 counts calls below 1us, bucket N counts calls below 2^N us
+     *  and the last bucket counts everything slower.
+     *
+     *  The statistics are exposed through the net.openvpn.v3.debug
+     *  interface.  A D-Bus object adds GetIntrospection() to its own
+     *  introspection document to provide it; DBusObject takes care of the
+     *  method calls.  The log service does not handle any method calls
+     *  and does not provide this interface.
+     */
+    class DBusMethodStats
+    {
+    public:
+        static const unsigned int BucketCount = 26;
+
+
+        static DBusMethodStats& Instance()
+        {
+            static DBusMethodStats stats;
+            return stats;
+        }
+
+
+        /**
+         *  Introspection data for the debug interface, to be added to the
+         *  node of a service's root object.
+         *
+         * @return Returns a std::string with the <interface/> XML element
+         */
+        static std::string GetIntrospection()
+        {
+            return "    <interface name='" + DBusMethodStats_interf + "'>"
+                   "        <method name='GetMethodStats'>"
+                   "            <arg type='at' name='bucket_limits_usec' direction='out'/>"
+                   "            <arg type='a(ssttttat)' name='methods' direction='out'/>"
+                   "        </method>"
+                   "    </interface>";
+        }
+
+
+        /**
+         *  Registers the start of a method call.  The call is completed
+         *  when the reply is sent.
+         *
+         * @param conn         D-Bus connection the call arrived on
+         * @param intf_name    D-Bus interface of the method call
+         * @param method_name  D-Bus method name
+         * @param invoc        GDBusMethodInvocation of the method call
+         */
+        void CallStarted(GDBusConnection *conn,
+                         const gchar *intf_name,
+                         const gchar *method_name,
+                         GDBusMethodInvocation *invoc)
+        {
+            MethodEntry *m = lookup(intf_name, method_name);
+            if (nullptr == m)
+            {
+                return;
+            }
+
+            GDBusMessage *msg = g_dbus_method_invocation_get_message(invoc);
+            if (g_dbus_message_get_flags(msg) & G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED)
+            {
+                m->calls++;
+                return;
+            }
+
+            ConnectionCalls *cc = attach(conn);
+            auto now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lg(cc->guard);
+            if (cc->inflight.size() >= MaxInflight)
+            {
+                cc->expire(now);
+            }
+            if (cc->inflight.size() >= MaxInflight)
+            {
+                m->calls++;
+                return;
+            }
+
+            // The message is kept, as the key refers to its sender
+            g_object_ref(msg);
+            cc->inflight[CallKey{g_dbus_message_get_serial(msg),
+                                 g_dbus_message_get_sender(msg)}]
+                = InflightCall{m, now, msg};
+        }
+
+
+        /**
+         *  Records a call which was completed synchronously, such as
+         *  property updates which GDBus replies to by itself.
+         *
+         * @param intf_name    D-Bus interface of the method call
+         * @param method_name  D-Bus method name
+         * @param duration     Time spent handling the call
+         * @param error        Set to true if the call failed
+         */
+        void Record(const gchar *intf_name, const gchar *method_name,
+                    std::chrono::steady_clock::duration duration, bool error)
+        {
+            MethodEntry *m = lookup(intf_name, method_name);
+            if (nullptr != m)
+            {
+                m->Record(duration, error);
+            }
+        }
+
+
+        /**
+         *  Retrieve all the collected statistics, as returned by the
+         *  GetMethodStats D-Bus method.
+         *
+         * @return Returns a GVariant of the type (ata(ssttttat))
+         */
+        GVariant * GetStats()
+        {
+            GVariantBuilder limits;
+            g_variant_builder_init(&limits, G_VARIANT_TYPE("at"));
+            for (unsigned int i = 0; i < BucketCount - 1; i++)
+            {
+                g_variant_builder_add(&limits, "t", (guint64) 1 << i);
+            }
+            g_variant_builder_add(&limits, "t", G_MAXUINT64);
+
+            GVariantBuilder list;
+            g_variant_builder_init(&list, G_VARIANT_TYPE("a(ssttttat)"));
+
+            for (const auto& slot : methods)
+            {
+                MethodEntry *m = slot.load();
+                if (nullptr == m)
+                {
+                    continue;
+                }
+
+                GVariantBuilder hist;
+                g_variant_builder_init(&hist, G_VARIANT_TYPE("at"));
+                for (const auto& b : m->histogram)
+                {
+                    g_variant_builder_add(&hist, "t", (guint64) b.load());
+                }
+                g_variant_builder_add(&list, "(ssttttat)",
+                                      g_quark_to_string(m->key >> 32),
+                                      g_quark_to_string(m->key & 0xffffffff),
+                                      (guint64) m->calls.load(),
+                                      (guint64) m->errors.load(),
+                                      (guint64) m->total_usec.load(),
+                                      (guint64) m->max_usec.load(),
+                                      &hist);
+            }
+            return g_variant_new("(@at@a(ssttttat))",
+                                 g_variant_builder_end(&limits),
+                                 g_variant_builder_end(&list));
+        }
+
+
+        /**
+         *  Handles a method call on the debug interface
+         *
+         * @param method_name  D-Bus method name
+         * @param invoc        GDBusMethodInvocation to reply to
+         */
+        void HandleMethodCall(const gchar *method_name,
+                              GDBusMethodInvocation *invoc)
+        {
+            if (0 == g_strcmp0("GetMethodStats", method_name))
+            {
+                g_dbus_method_invocation_return_value(invoc, GetStats());
+                return;
+            }
+            g_dbus_method_invocation_return_dbus_error(invoc,
+                                                       "org.freedesktop.DBus.Error.UnknownMethod",
+                                                       "Unknown method");
+        }
+
+
+    private:
+        /**
+         *  Calls not yet replied to are limited per connection, so a
+         *  handler never replying does not make this grow without bounds.
+         *  When the limit is reached, calls older than MaxInflightAge are
+         *  given up on and counted as failed calls.  Calls beyond the
+         *  limit are only counted.
+         */
+        static const size_t MaxInflight = 4096;
+        static const unsigned int MaxInflightAge = 300; // seconds
+
+        /**
+         *  Size of the method table.  This is far more than the methods
+         *  any service provides.
+         */
+        static const size_t MaxMethods = 1024;
+
+        /**
+         *  Statistics of a single D-Bus method.  Entries are never removed,
+         *  so they can be updated without holding any lock.
+         */
+        struct MethodEntry
+        {
+            MethodEntry(guint64 key)
+                : key(key), calls(0), errors(0), total_usec(0), max_usec(0)
+            {
+                for (auto& b : histogram)
+                {
+                    b = 0;
+                }
+            }
+
+            void Record(std::chrono::steady_clock::duration duration,
+                        bool error)
+            {
+                guint64 usec = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+                unsigned int bucket = 0;
+                for (guint64 v = usec; v > 0 && bucket < BucketCount - 1; v >>= 1)
+                {
+                    bucket++;
+                }
+
+                calls++;
+                if (error)
+                {
+                    errors++;
+                }
+                total_usec += usec;
+                guint64 max = max_usec.load();
+                while (usec > max && !max_usec.compare_exchange_weak(max, usec))
+                {
+                }
+                histogram[bucket]++;
+            }
+
+            const guint64 key;
+            std::atomic<guint64> calls;
+            std::atomic<guint64> errors;
+            std::atomic<guint64> total_usec;
+            std::atomic<guint64> max_usec;
+            std::array<std::atomic<guint64>, BucketCount> histogram;
+        };
+
+        /**
+         *  Serial and sender of a method call.  The sender string is owned
+         *  by the method call message, or by the reply when looking up.
+         */
+        struct CallKey
+        {
+            guint32 serial;
+            const gchar *sender;
+
+            bool operator==(const CallKey& other) const
+            {
+                return serial == other.serial
+                       && 0 == g_strcmp0(sender, other.sender);
+            }
+        };
+
+        struct CallKeyHash
+        {
+            size_t operator()(const CallKey& k) const
+            {
+                return k.serial ^ (NULL != k.sender ? g_str_hash(k.sender) : 0);
+            }
+        };
+
+        struct InflightCall
+        {
+            MethodEntry *method;
+            std::chrono::steady_clock::time_point start;
+            GDBusMessage *msg;
+        };
+
+        /**
+         *  The calls waiting for a reply on a single connection.  This is
+         *  attached to the connection and freed together with it.
+         */
+        struct ConnectionCalls
+        {
+            ~ConnectionCalls()
+            {
+                for (auto& c : inflight)
+                {
+                    g_object_unref(c.second.msg);
+                }
+            }
+
+            /**
+             *  Gives up on the calls older than MaxInflightAge.  The
+             *  caller must hold the lock.
+             */
+            void expire(std::chrono::steady_clock::time_point now)
+            {
+                if (now < next_expire)
+                {
+                    return;
+                }
+                next_expire = now + std::chrono::seconds(1);
+                auto limit = now - std::chrono::seconds(MaxInflightAge);
+                for (auto it = inflight.begin(); it != inflight.end();)
+                {
+                    if (it->second.start < limit)
+                    {
+                        it = complete(it, now, true);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+            }
+
+            /**
+             *  Records a call as completed and forgets it.  The caller
+             *  must hold the lock.
+             */
+            std::unordered_map<CallKey, InflightCall, CallKeyHash>::iterator
+            complete(std::unordered_map<CallKey, InflightCall, CallKeyHash>::iterator it,
+                     std::chrono::steady_clock::time_point now, bool error)
+            {
+                it->second.method->Record(now - it->second.start, error);
+                g_object_unref(it->second.msg);
+                return inflight.erase(it);
+            }
+
+            std::mutex guard;
+            std::unordered_map<CallKey, InflightCall, CallKeyHash> inflight;
+            std::chrono::steady_clock::time_point next_expire;
+        };
+
+        std::array<std::atomic<MethodEntry *>, MaxMethods> methods;
+        std::mutex attach_guard;
+
+
+        DBusMethodStats()
+        {
+            for (auto& m : methods)
+            {
+                m = nullptr;
+            }
+        }
+
+        DBusMethodStats(const DBusMethodStats&) = delete;
+        DBusMethodStats& operator=(const DBusMethodStats&) = delete;
+
+
+        /**
+         *  Finds or adds the statistics entry of a method, without
+         *  locking.  The method table uses open addressing on the
+         *  interface and method quarks.
+         *
+         * @return Returns the MethodEntry, or nullptr if the table is full
+         */
+        MethodEntry * lookup(const gchar *intf_name, const gchar *method_name)
+        {
+            guint64 key = ((guint64) g_quark_from_string(intf_name) << 32)
+                          | (guint64) g_quark_from_string(method_name);
+
+            MethodEntry *added = nullptr;
+            size_t start = (size_t) ((key >> 32) * 31 + (key & 0xffffffff));
+            for (size_t i = 0; i < MaxMethods; i++)
+            {
+                std::atomic<MethodEntry *>& slot = methods[(start + i) % MaxMethods];
+                MethodEntry *m = slot.load();
+                if (nullptr == m)
+                {
+                    if (nullptr == added)
+                    {
+                        added = new MethodEntry(key);
+                    }
+                    if (slot.compare_exchange_strong(m, added))
+                    {
+                        return added;
+                    }
+                    // Another thread took this slot; m is its entry
+                }
+                if (m->key == key)
+                {
+                    delete added;
+                    return m;
+                }
+            }
+            delete added;
+            return nullptr;
+        }
+
+
+        /**
+         *  Prepares tracking the method calls on a connection, once.
+         *  The reply filter is installed the first time a connection is
+         *  seen.
+         *
+         * @return Returns the ConnectionCalls of the connection
+         */
+        ConnectionCalls * attach(GDBusConnection *conn)
+        {
+            static const gchar *attached_key = "openvpn3-method-stats";
+            ConnectionCalls *cc = (ConnectionCalls *) g_object_get_data(G_OBJECT(conn),
+                                                                         attached_key);
+            if (nullptr != cc)
+            {
+                return cc;
+            }
+
+            std::lock_guard<std::mutex> lg(attach_guard);
+            cc = (ConnectionCalls *) g_object_get_data(G_OBJECT(conn), attached_key);
+            if (nullptr == cc)
+            {
+                cc = new ConnectionCalls;
+                g_object_set_data_full(G_OBJECT(conn), attached_key, cc,
+                                       connection_calls_free);
+                g_dbus_connection_add_filter(conn, reply_filter, cc, NULL);
+                g_signal_connect(conn, "closed", G_CALLBACK(connection_closed), cc);
+            }
+            return cc;
+        }
+
+
+        static void connection_calls_free(gpointer data)
+        {
+            delete (ConnectionCalls *) data;
+        }
+
+
+        /**
+         *  Completes method calls when their reply is sent.  This is called
+         *  for all messages on the connection, from the GDBus worker thread.
+         */
+        static GDBusMessage * reply_filter(GDBusConnection *conn,
+                                           GDBusMessage *msg,
+                                           gboolean incoming,
+                                           gpointer data)
+        {
+            if (incoming)
+            {
+                return msg;
+            }
+
+            GDBusMessageType type = g_dbus_message_get_message_type(msg);
+            if (G_DBUS_MESSAGE_TYPE_METHOD_RETURN != type
+                && G_DBUS_MESSAGE_TYPE_ERROR != type)
+            {
+                return msg;
+            }
+
+            ConnectionCalls *cc = (ConnectionCalls *) data;
+            CallKey k{g_dbus_message_get_reply_serial(msg),
+                      g_dbus_message_get_destination(msg)};
+
+            std::lock_guard<std::mutex> lg(cc->guard);
+            auto it = cc->inflight.find(k);
+            if (cc->inflight.end() != it)
+            {
+                cc->complete(it, std::chrono::steady_clock::now(),
+                             G_DBUS_MESSAGE_TYPE_ERROR == type);
+            }
+            return msg;
+        }
+
+
+        /**
+         *  Forgets the calls on a closed connection, which will never be
+         *  replied to.  They are counted as failed calls.
+         */
+        static void connection_closed(GDBusConnection *conn,
+                                      gboolean remote_peer_vanished,
+                                      GError *error,
+                                      gpointer data)
+        {
+            ConnectionCalls *cc = (ConnectionCalls *) data;
+            std::lock_guard<std::mutex> lg(cc->guard);
+            auto now = std::chrono::steady_clock::now();
+            for (auto it = cc->inflight.begin(); it != cc->inflight.end();)
+            {
+                it = cc->complete(it, now, true);
+            }
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_METHOD_STATS_HPP
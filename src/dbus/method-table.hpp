@@ -0,0 +1,198 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   method-table.hpp
+ *
+ * @brief  Table based dispatching of D-Bus method calls to member
+ *         functions of a DBusObject implementation.
+ */
+
+#ifndef OPENVPN3_DBUS_METHOD_TABLE_HPP
+#define OPENVPN3_DBUS_METHOD_TABLE_HPP
+
+#include <string>
+#include <unordered_map>
+
+namespace openvpn
+{
+    /**
+     *  The arguments of a D-Bus method call, as received from GDBus.
+     *  None of the strings are copied; they are only valid while the
+     *  method call is being handled.
+     */
+    struct DBusMethodCall
+    {
+        GDBusConnection *conn;
+        const gchar *sender;
+        const gchar *obj_path;
+        const gchar *intf_name;
+        const gchar *method_name;
+        GVariant *params;
+        GDBusMethodInvocation *invoc;
+    };
+
+
+    /**
+     *  Maps D-Bus methods to member functions of a class.  The interface
+     *  and method names are interned as GQuarks, so looking up a handler
+     *  does not allocate and only needs a single hash table lookup.
+     *
+     *  The introspection data of each method is declared together with
+     *  its handler.  GetIntrospection() generates the <method/> elements
+     *  for an interface, which keeps the handlers and the introspection
+     *  document in sync.
+     *
+     *  A table is typically built once per class and kept in a function
+     *  local static variable.
+     */
+    template <class T>
+    class DBusMethodTable
+    {
+    public:
+        typedef void (T::*Handler)(const DBusMethodCall& call);
+
+
+        /**
+         *  Adds a method handler and its introspection data
+         *
+         * @param intf_name    D-Bus interface of the method
+         * @param method_name  D-Bus method name
+         * @param args_xml     The <arg/> elements of the method.  May be
+         *                     empty for methods without arguments.
+         * @param handler      Member function handling the method call.
+         *                     It must send a reply to the method
+         *                     invocation or throw an exception.
+         *
+         * @return Returns a reference to this table, for chaining calls
+         */
+        DBusMethodTable& Add(const std::string& intf_name,
+                             const std::string& method_name,
+                             const std::string& args_xml,
+                             Handler handler)
+        {
+            Add(intf_name, method_name, handler);
+
+            std::string& xml = introspection[g_quark_from_string(intf_name.c_str())];
+            xml += "        <method name='" + method_name + "'";
+            if (args_xml.empty())
+            {
+                xml += "/>";
+            }
+            else
+            {
+                xml += ">" + args_xml + "</method>";
+            }
+            return *this;
+        }
+
+
+        /**
+         *  Adds a method handler where the introspection data is provided
+         *  elsewhere, such as methods from standard D-Bus interfaces or
+         *  helper classes generating their own introspection data.
+         *
+         * @param intf_name    D-Bus interface of the method
+         * @param method_name  D-Bus method name
+         * @param handler      Member function handling the method call
+         *
+         * @return Returns a reference to this table, for chaining calls
+         */
+        DBusMethodTable& Add(const std::string& intf_name,
+                             const std::string& method_name,
+                             Handler handler)
+        {
+            handlers[make_key(g_quark_from_string(intf_name.c_str()),
+                              g_quark_from_string(method_name.c_str()))] = handler;
+            return *this;
+        }
+
+
+        /**
+         *  Retrieve the introspection data of all methods added with
+         *  introspection data for an interface.
+         *
+         * @param intf_name  D-Bus interface to retrieve the methods for
+         *
+         * @return Returns a std::string with <method/> XML elements
+         */
+        std::string GetIntrospection(const std::string& intf_name) const
+        {
+            auto it = introspection.find(g_quark_from_string(intf_name.c_str()));
+            return (introspection.end() != it ? it->second : "");
+        }
+
+
+        /**
+         *  Calls the handler of a method call, if found
+         *
+         * @param obj   Object to call the handler on
+         * @param call  DBusMethodCall with the method call arguments
+         *
+         * @return Returns true if a handler was called, otherwise false
+         */
+        bool Dispatch(T *obj, const DBusMethodCall& call) const
+        {
+            Handler h = Lookup(call.intf_name, call.method_name);
+            if (nullptr == h)
+            {
+                return false;
+            }
+            (obj->*h)(call);
+            return true;
+        }
+
+
+        /**
+         *  Looks up the handler of a method
+         *
+         * @param intf_name    D-Bus interface of the method
+         * @param method_name  D-Bus method name
+         *
+         * @return Returns the member function handling the method or
+         *         nullptr if the method is unknown
+         */
+        Handler Lookup(const gchar *intf_name, const gchar *method_name) const
+        {
+            // Names never added to any table are not interned, which
+            // g_quark_try_string() reports as 0
+            GQuark intf_q = g_quark_try_string(intf_name);
+            GQuark meth_q = g_quark_try_string(method_name);
+            if (0 == intf_q || 0 == meth_q)
+            {
+                return nullptr;
+            }
+
+            auto it = handlers.find(make_key(intf_q, meth_q));
+            return (handlers.end() != it ? it->second : nullptr);
+        }
+
+
+    private:
+        std::unordered_map<guint64, Handler> handlers;
+        std::unordered_map<GQuark, std::string> introspection;
+
+
+        static guint64 make_key(GQuark intf_q, GQuark meth_q)
+        {
+            return ((guint64) intf_q << 32) | (guint64) meth_q;
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_METHOD_TABLE_HPP
@@ -0,0 +1,344 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   object-subtree.hpp
+ *
+ * @brief  Registers DBusObjects below a common object path through a
+ *         single GDBus subtree registration.
+ */
+
+#ifndef OPENVPN3_DBUS_OBJECT_SUBTREE_HPP
+#define OPENVPN3_DBUS_OBJECT_SUBTREE_HPP
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "dbus/object.hpp"
+
+namespace openvpn
+{
+    /**
+     *  Serves all the direct child objects of an object path through a
+     *  single g_dbus_connection_register_subtree() registration, instead
+     *  of one GDBus registration per object and interface.
+     *
+     *  The objects are kept in a hash index on their node name and are
+     *  resolved when a D-Bus call arrives.  GDBus is told to dispatch to
+     *  nodes not being enumerated, so the full list of nodes is only
+     *  built when a client introspects the subtree root.
+     *
+     *  The object path of the subtree root itself can still be used by a
+     *  normally registered DBusObject, such as a manager object.
+     */
+    class DBusObjectSubtree
+    {
+    public:
+        /**
+         * @param conn       D-Bus connection to register the subtree on
+         * @param root_path  D-Bus object path of the subtree root
+         */
+        DBusObjectSubtree(GDBusConnection *conn, const std::string root_path)
+            : conn(conn),
+              root_path(root_path),
+              subtree_id(0)
+        {
+        }
+
+
+        ~DBusObjectSubtree()
+        {
+            Unregister();
+        }
+
+
+        /**
+         *  Registers the subtree on the D-Bus connection
+         */
+        void Register()
+        {
+            if (subtree_id > 0)
+            {
+                return;
+            }
+
+            GError *error = NULL;
+            subtree_id = g_dbus_connection_register_subtree(conn,
+                                                            root_path.c_str(),
+                                                            &subtree_vtable,
+                                                            G_DBUS_SUBTREE_FLAGS_DISPATCH_TO_UNENUMERATED_NODES,
+                                                            this,
+                                                            NULL,  // destruct function
+                                                            &error);
+            if (0 == subtree_id)
+            {
+                std::string errmsg(error ? error->message : "(unknown)");
+                if (error)
+                {
+                    g_error_free(error);
+                }
+                THROW_DBUSEXCEPTION("DBusObjectSubtree",
+                                    "Failed to register subtree "
+                                    + root_path + ": " + errmsg);
+            }
+        }
+
+
+        /**
+         *  Unregisters the subtree.  Objects still in the index are
+         *  no longer reachable over D-Bus.
+         */
+        void Unregister()
+        {
+            if (subtree_id > 0)
+            {
+                g_dbus_connection_unregister_subtree(conn, subtree_id);
+                subtree_id = 0;
+            }
+        }
+
+
+        /**
+         *  Makes a DBusObject available in the subtree.  This replaces
+         *  DBusObject::RegisterObject(); the object is removed from the
+         *  subtree again by DBusObject::RemoveObject().
+         *
+         * @param obj  DBusObject to add.  The object path must be a
+         *             direct child of the subtree root.
+         */
+        void Add(DBusObject *obj)
+        {
+            if (obj->registered)
+            {
+                THROW_DBUSEXCEPTION("DBusObjectSubtree",
+                                    "Object is already registered in D-Bus");
+            }
+            if (NULL == obj->introspection)
+            {
+                THROW_DBUSEXCEPTION("DBusObjectSubtree",
+                                    "No introspection document parsed");
+            }
+
+            std::string node = get_node_name(obj->GetObjectPath());
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                if (index.end() != index.find(node))
+                {
+                    THROW_DBUSEXCEPTION("DBusObjectSubtree",
+                                        "Object path already in use: "
+                                        + obj->GetObjectPath());
+                }
+                index[node] = obj;
+            }
+
+            obj->registered = true;
+            obj->subtree_remove = [this, node]()
+                                  {
+                                      std::lock_guard<std::mutex> lg(guard);
+                                      index.erase(node);
+                                  };
+        }
+
+
+    private:
+        GDBusConnection *conn;
+        std::string root_path;
+        guint subtree_id;
+        std::mutex guard;
+        std::unordered_map<std::string, DBusObject *> index;
+
+
+        /**
+         *  Extracts the node name of an object path, relative to the
+         *  subtree root
+         */
+        std::string get_node_name(const std::string& obj_path)
+        {
+            std::string prefix = root_path + "/";
+            if (0 != obj_path.compare(0, prefix.size(), prefix)
+                || obj_path.size() == prefix.size()
+                || std::string::npos != obj_path.find('/', prefix.size()))
+            {
+                THROW_DBUSEXCEPTION("DBusObjectSubtree",
+                                    "Object path " + obj_path
+                                    + " is not a direct child of "
+                                    + root_path);
+            }
+            return obj_path.substr(prefix.size());
+        }
+
+
+        DBusObject * lookup(const gchar *node)
+        {
+            if (NULL == node)
+            {
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lg(guard);
+            auto it = index.find(std::string(node));
+            return (index.end() != it ? it->second : nullptr);
+        }
+
+
+        /**
+         *  Resolves the DBusObject a call is targeting from its object
+         *  path.  The object is looked up again when the call is run, as
+         *  it may have been removed after GDBus dispatched the call.
+         */
+        DBusObject * lookup_path(const gchar *obj_path)
+        {
+            const gchar *node = strrchr(obj_path, '/');
+            return (node ? lookup(node + 1) : nullptr);
+        }
+
+
+        static gchar ** subtree_enumerate(GDBusConnection *conn,
+                                          const gchar *sender,
+                                          const gchar *obj_path,
+                                          gpointer this_ptr)
+        {
+            DBusObjectSubtree *st = (DBusObjectSubtree *) this_ptr;
+            std::lock_guard<std::mutex> lg(st->guard);
+
+            gchar **nodes = g_new0(gchar *, st->index.size() + 1);
+            gsize i = 0;
+            for (const auto& item : st->index)
+            {
+                nodes[i++] = g_strdup(item.first.c_str());
+            }
+            return nodes;
+        }
+
+
+        static GDBusInterfaceInfo ** subtree_introspect(GDBusConnection *conn,
+                                                        const gchar *sender,
+                                                        const gchar *obj_path,
+                                                        const gchar *node,
+                                                        gpointer this_ptr)
+        {
+            DBusObjectSubtree *st = (DBusObjectSubtree *) this_ptr;
+            DBusObject *obj = st->lookup(node);
+            if (nullptr == obj)
+            {
+                return NULL;
+            }
+
+            GPtrArray *ifaces = g_ptr_array_new();
+            for (GDBusInterfaceInfo **intf = obj->introspection->interfaces;
+                 NULL != *intf; intf++)
+            {
+                g_ptr_array_add(ifaces, g_dbus_interface_info_ref(*intf));
+            }
+            g_ptr_array_add(ifaces, NULL);
+            return (GDBusInterfaceInfo **) g_ptr_array_free(ifaces, FALSE);
+        }
+
+
+        static const GDBusInterfaceVTable * subtree_dispatch(GDBusConnection *conn,
+                                                             const gchar *sender,
+                                                             const gchar *obj_path,
+                                                             const gchar *intf_name,
+                                                             const gchar *node,
+                                                             gpointer *out_user_data,
+                                                             gpointer this_ptr)
+        {
+            DBusObjectSubtree *st = (DBusObjectSubtree *) this_ptr;
+            DBusObject *obj = st->lookup(node);
+            if (nullptr == obj
+                || NULL == g_dbus_node_info_lookup_interface(obj->introspection,
+                                                             intf_name))
+            {
+                return NULL;
+            }
+            *out_user_data = st;
+            return &st->interface_vtable;
+        }
+
+
+        static void subtree_method_call(GDBusConnection *conn,
+                                        const gchar *sender,
+                                        const gchar *obj_path,
+                                        const gchar *intf_name,
+                                        const gchar *meth_name,
+                                        GVariant *params,
+                                        GDBusMethodInvocation *invoc,
+                                        gpointer this_ptr)
+        {
+            DBusObjectSubtree *st = (DBusObjectSubtree *) this_ptr;
+            DBusObject *obj = st->lookup_path(obj_path);
+            if (nullptr == obj)
+            {
+                g_dbus_method_invocation_return_dbus_error(invoc,
+                                                           "org.freedesktop.DBus.Error.UnknownObject",
+                                                           (std::string("Object removed: ")
+                                                            + obj_path).c_str());
+                return;
+            }
+            DBusObject::dbusobject_callback_method_call(conn, sender, obj_path,
+                                                        intf_name, meth_name,
+                                                        params, invoc, obj);
+        }
+
+
+        static gboolean subtree_set_property(GDBusConnection *conn,
+                                             const gchar *sender,
+                                             const gchar *obj_path,
+                                             const gchar *intf_name,
+                                             const gchar *property_name,
+                                             GVariant *value,
+                                             GError **error,
+                                             gpointer this_ptr)
+        {
+            DBusObjectSubtree *st = (DBusObjectSubtree *) this_ptr;
+            DBusObject *obj = st->lookup_path(obj_path);
+            if (nullptr == obj)
+            {
+                g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_OBJECT,
+                            "Object removed: %s", obj_path);
+                return FALSE;
+            }
+            return DBusObject::dbusobject_callback_set_property(conn, sender,
+                                                                obj_path,
+                                                                intf_name,
+                                                                property_name,
+                                                                value, error,
+                                                                obj);
+        }
+
+
+        const GDBusSubtreeVTable subtree_vtable = {
+            subtree_enumerate,
+            subtree_introspect,
+            subtree_dispatch
+        };
+
+        /**
+         *  As in DBusObject, get_property is left NULL so property reads
+         *  arrive as org.freedesktop.DBus.Properties method calls.
+         */
+        const GDBusInterfaceVTable interface_vtable = {
+            subtree_method_call,
+            NULL,
+            subtree_set_property
+        };
+    };
+};
+#endif // OPENVPN3_DBUS_OBJECT_SUBTREE_HPP
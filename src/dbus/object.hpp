@@ -20,10 +20,18 @@
 #ifndef OPENVPN3_DBUS_OBJECT_HPP
 #define OPENVPN3_DBUS_OBJECT_HPP
 
+#include <functional>
+#include <vector>
+
 #include "idlecheck.hpp"
+#include "async-dispatch.hpp"
+#include "method-table.hpp"
+#include "method-stats.hpp"
 
 namespace openvpn
 {
+    class DBusObjectSubtree;
+
     /**
      *  DBusObject is the object which carries data, methods
      *  and signals to be provided over the D-Bus.
@@ -102,25 +110,81 @@ namespace openvpn
                 THROW_DBUSEXCEPTION("DBusObject", "No introspection document parsed");
             }
 
-            GError *error = NULL;
-            object_id = g_dbus_connection_register_object(dbuscon,
-                                                          object_path.c_str(),
-                                                          introspection->interfaces[0],
-                                                          &dbusobj_interface_vtable,
-                                                          this,
-                                                          NULL, // destruct function
-                                                          &error);
-            if (object_id < 1)
-            {
-                std::stringstream err;
-                err << "RegisterObject(" + object_path + ") failed: ";
-                err << (error != NULL ? error->message : "(unknown)");
-                THROW_DBUSEXCEPTION("DBusObject", err.str());
+            // Register all the interfaces declared in the introspection
+            // document on the same object path.  The first interface is
+            // the main interface of the object.
+            for (GDBusInterfaceInfo **intf = introspection->interfaces;
+                 NULL != *intf; intf++)
+            {
+                GError *error = NULL;
+                guint id = g_dbus_connection_register_object(dbuscon,
+                                                             object_path.c_str(),
+                                                             *intf,
+                                                             &dbusobj_interface_vtable,
+                                                             this,
+                                                             NULL, // destruct function
+                                                             &error);
+                if (id < 1)
+                {
+                    std::stringstream err;
+                    err << "RegisterObject(" + object_path + ", "
+                        << (*intf)->name << ") failed: ";
+                    err << (error != NULL ? error->message : "(unknown)");
+
+                    // Roll back the interfaces already registered
+                    for (auto& i : extra_object_ids)
+                    {
+                        g_dbus_connection_unregister_object(dbuscon, i);
+                    }
+                    extra_object_ids.clear();
+                    if (object_id > 0)
+                    {
+                        g_dbus_connection_unregister_object(dbuscon, object_id);
+                        object_id = 0;
+                    }
+                    THROW_DBUSEXCEPTION("DBusObject", err.str());
+                }
+
+                if (0 == object_id)
+                {
+                    object_id = id;
+                }
+                else
+                {
+                    extra_object_ids.push_back(id);
+                }
             }
             registered = true;
         }
 
 
+        /**
+         *  Enables asynchronous dispatching of D-Bus method calls for this
+         *  object.  Method calls accepted by callback_async_dispatch() will
+         *  be run on a worker thread from the given pool instead of
+         *  directly in the GLib main loop.  The GDBusMethodInvocation is
+         *  then completed from the worker thread.
+         *
+         *  All asynchronous method calls to the same object are
+         *  serialized; they are run one at the time in the order they
+         *  arrived.  Property reads arrive as method calls on the
+         *  org.freedesktop.DBus.Properties interface and can be dispatched
+         *  asynchronously as well.  Property writes are always handled in
+         *  the main loop, so implementations must ensure data shared with
+         *  callback_set_property() is safe to access concurrently.
+         *
+         * @param pool  DBusAsyncWorkerPool::Ptr to the worker pool to use
+         */
+        void EnableAsyncDispatch(DBusAsyncWorkerPool::Ptr pool)
+        {
+            if (async_strand)
+            {
+                THROW_DBUSEXCEPTION("DBusObject", "Asynchronous dispatch already enabled");
+            }
+            async_strand.reset(new DBusAsyncStrand(pool));
+        }
+
+
         /**
          *  Sets/registers an IdleChecker object for this DBusObject
          *
@@ -132,7 +196,23 @@ namespace openvpn
         }
 
 
-        void RemoveObject(GDBusConnection *dbuscon)
+        /**
+         *  Removes this object from the D-Bus.
+         *
+         *  With asynchronous dispatching enabled, a method call may still
+         *  be running on a worker thread when this returns.  Such objects
+         *  must not be destroyed before the idle function has been
+         *  called.
+         *
+         * @param dbuscon  D-Bus connection the object is registered on
+         * @param idle     Optional std::function called once no
+         *                 asynchronous method call is running on this
+         *                 object.  It is called either before this
+         *                 method returns or from the worker thread which
+         *                 completed the last method call.
+         */
+        void RemoveObject(GDBusConnection *dbuscon,
+                          std::function<void()> idle = nullptr)
         {
             if (!registered)
             {
@@ -141,7 +221,33 @@ namespace openvpn
             registered = false;
 
             // Remove the object from the D-Bus
-            g_dbus_connection_unregister_object(dbuscon, object_id);
+            if (subtree_remove)
+            {
+                // Registered via a DBusObjectSubtree
+                subtree_remove();
+                subtree_remove = nullptr;
+            }
+            else
+            {
+                for (auto& i : extra_object_ids)
+                {
+                    g_dbus_connection_unregister_object(dbuscon, i);
+                }
+                extra_object_ids.clear();
+                g_dbus_connection_unregister_object(dbuscon, object_id);
+                object_id = 0;
+            }
+
+            // Reject asynchronous method calls not yet started, without
+            // waiting for one in progress
+            if (async_strand)
+            {
+                async_strand->Close(idle);
+            }
+            else if (idle)
+            {
+                idle();
+            }
 
             // Allow the implementor to add more cleaning up
             callback_destructor();
@@ -152,6 +258,23 @@ namespace openvpn
         }
 
 
+        /**
+         *  Called each time a D-Bus client calls an object method, before
+         *  callback_method_call().  This is used by implementations
+         *  dispatching their methods through a DBusMethodTable, which
+         *  avoids copying the call arguments into std::string objects.
+         *
+         * @param call  DBusMethodCall with the method call arguments
+         *
+         * @return Returns true if the method call was handled.  If false,
+         *         the call is passed on to callback_method_call().
+         */
+        virtual bool callback_method_dispatch(const DBusMethodCall& call)
+        {
+            return false;
+        }
+
+
         /**
          *  Called each time a D-Bus client calls an object method
          */
@@ -164,6 +287,25 @@ namespace openvpn
                                           GDBusMethodInvocation *invoc) = 0;
 
 
+        /**
+         *  Decides if a method call should be dispatched asynchronously
+         *  when EnableAsyncDispatch() have been called.  By default, all
+         *  method calls are dispatched asynchronously.  Implementations
+         *  may override this to keep cheap or main loop dependent methods
+         *  synchronous.
+         *
+         * @param intf_name  D-Bus interface of the method call
+         * @param meth_name  D-Bus method name being called
+         *
+         * @return Returns true if the method call can run on a worker thread
+         */
+        virtual bool callback_async_dispatch(const std::string& intf_name,
+                                             const std::string& meth_name)
+        {
+            return true;
+        }
+
+
         /**
          *  Called each time a D-Bus client attempts to read a D-Bus object property
          */
@@ -175,6 +317,37 @@ namespace openvpn
                                                  GError **error) = 0;
 
 
+        /**
+         *  Called when a D-Bus client retrieves all properties of an
+         *  interface in a single org.freedesktop.DBus.Properties.GetAll()
+         *  call.
+         *
+         *  The default implementation calls callback_get_property() for
+         *  each readable property.  Implementations doing access control
+         *  per property should override this, do the access check once
+         *  and use build_all_properties() to collect the values.
+         *
+         * @return Returns a GVariant a{sv} dictionary with all the
+         *         properties the caller can read.  On errors, NULL is
+         *         returned and the error is set via the GError pointer.
+         */
+        virtual GVariant * callback_get_all_properties(GDBusConnection *conn,
+                                                       const std::string sender,
+                                                       const std::string obj_path,
+                                                       const std::string intf_name,
+                                                       GError **error)
+        {
+            return build_all_properties(intf_name,
+                                        [&](const std::string& prop, GError **err)
+                                        {
+                                            return callback_get_property(conn, sender,
+                                                                         obj_path,
+                                                                         intf_name,
+                                                                         prop, err);
+                                        });
+        }
+
+
         /**
          *  Called each time a D-Bus client attempts to modify a D-Bus object property.
          *  This method is "private" and is the one called by the GDBus library.  This
@@ -193,7 +366,7 @@ namespace openvpn
             try
             {
                 GVariantBuilder *ret = callback_set_property(conn,
-                                                             std::string(sender),
+                                                             std::string(sender ? sender : ""),
                                                              std::string(obj_path),
                                                              std::string(intf_name),
                                                              std::string(property_name),
@@ -366,13 +539,7 @@ namespace openvpn
                 THROW_DBUSEXCEPTION("DBusObject", "Object is already registered in D-Bus. "
                                     "Cannot modify the introspection document.");
             }
-
-            GError *error = nullptr;
-            introspection = g_dbus_node_info_new_for_xml(xmlstr.c_str(), &error);
-            if (NULL == introspection || NULL != error)
-            {
-                THROW_DBUSEXCEPTION("DBusObject", "Failed to parse introspection XML:" + std::string(error->message));
-            }
+            introspection = ParseIntrospection(xmlstr);
         }
 
 
@@ -389,6 +556,105 @@ namespace openvpn
         }
 
 
+        /**
+         *  Parses an introspection XML document without tying it to any
+         *  object.  This is used by classes sharing a single parsed
+         *  introspection document between all their objects, typically
+         *  kept in a function local static variable.
+         *
+         *  @param xmlstr  std::string containing the introspection XML document
+         *
+         *  @return Returns a GDBusNodeInfo pointer with the parsed document.
+         *          On errors, DBusException is thrown.
+         */
+        static GDBusNodeInfo * ParseIntrospection(const std::string& xmlstr)
+        {
+            GError *error = nullptr;
+            GDBusNodeInfo *node = g_dbus_node_info_new_for_xml(xmlstr.c_str(), &error);
+            if (NULL == node || NULL != error)
+            {
+                std::string errmsg(error ? error->message : "(unknown error)");
+                if (error)
+                {
+                    g_error_free(error);
+                }
+                THROW_DBUSEXCEPTION("DBusObject", "Failed to parse introspection XML:" + errmsg);
+            }
+            return node;
+        }
+
+
+        /**
+         *  Uses an already parsed introspection document, as returned by
+         *  ParseIntrospection(), describing this object.  A new reference
+         *  to the document is taken, so the same document can be shared
+         *  by many objects.
+         *
+         *  @param node  GDBusNodeInfo pointer to the introspection document
+         */
+        void SetIntrospection(GDBusNodeInfo *node)
+        {
+            if (registered)
+            {
+                THROW_DBUSEXCEPTION("DBusObject", "Object is already registered in D-Bus. "
+                                    "Cannot modify the introspection document.");
+            }
+            introspection = g_dbus_node_info_ref(node);
+        }
+
+
+        /**
+         *  Builds the a{sv} dictionary returned by GetAll(), based on the
+         *  readable properties declared in the introspection document.
+         *  Properties where the getter fails are left out, the same way
+         *  GDBus does it for its own GetAll() implementation.
+         *
+         * @param intf_name  D-Bus interface to collect properties from
+         * @param getter     Function retrieving a single property value
+         *
+         * @return Returns a floating GVariant a{sv} dictionary
+         */
+        GVariant * build_all_properties(const std::string& intf_name,
+                                        std::function<GVariant *(const std::string&, GError **)> getter)
+        {
+            GVariantBuilder bld;
+            g_variant_builder_init(&bld, G_VARIANT_TYPE("a{sv}"));
+
+            GDBusInterfaceInfo *intf = NULL;
+            if (NULL != introspection)
+            {
+                intf = g_dbus_node_info_lookup_interface(introspection,
+                                                         intf_name.c_str());
+            }
+            if (NULL == intf || NULL == intf->properties)
+            {
+                return g_variant_builder_end(&bld);
+            }
+
+            for (GDBusPropertyInfo **p = intf->properties; NULL != *p; p++)
+            {
+                if (!((*p)->flags & G_DBUS_PROPERTY_INFO_FLAGS_READABLE))
+                {
+                    continue;
+                }
+
+                GError *err = NULL;
+                GVariant *value = getter(std::string((*p)->name), &err);
+                if (NULL != value)
+                {
+                    g_variant_take_ref(value);
+                    g_variant_builder_add(&bld, "{sv}", (*p)->name, value);
+                    g_variant_unref(value);
+                }
+                if (NULL != err)
+                {
+                    g_error_free(err);
+                }
+            }
+            return g_variant_builder_end(&bld);
+        }
+
+
         /**
          *  Updates the IdleCheck timer's timestamp to indicate this object have been accessed.
          *  If the IdleCheck object times out, the process is stopped.
@@ -431,18 +697,28 @@ namespace openvpn
 
 
     private:
+        friend class DBusObjectSubtree;
+
         bool registered;
         std::string object_path;
         guint object_id;
+        std::vector<guint> extra_object_ids;
         IdleCheck *idle_checker;
         GDBusNodeInfo *introspection;
+        DBusAsyncStrand::Ptr async_strand;
+        std::function<void()> subtree_remove;
 
         /**
          *  Callback loook-up table for D-Bus
+         *
+         *  The get_property slot is intentionally NULL.  This makes GDBus
+         *  route org.freedesktop.DBus.Properties.Get() and GetAll() calls
+         *  through the method call handler, where GetAll() can be served
+         *  by a single callback_get_all_properties() call.
          */
         GDBusInterfaceVTable dbusobj_interface_vtable = {
             dbusobject_callback_method_call,
-            dbusobject_callback_get_property,
+            NULL,
             dbusobject_callback_set_property
         };
 
@@ -456,31 +732,198 @@ namespace openvpn
                                                      GDBusMethodInvocation *invoc,
                                                      gpointer this_ptr)
         {
+            DBusMethodStats::Instance().CallStarted(conn, intf_name,
+                                                    meth_name, invoc);
+
             class DBusObject *obj = (class DBusObject *) this_ptr;
-            obj->callback_method_call(conn,
-                                      std::string(sender),
-                                      std::string(obj_path),
-                                      std::string(intf_name),
-                                      std::string(meth_name),
-                                      params, invoc);
+            if (obj->async_strand
+                && obj->callback_async_dispatch(intf_name, meth_name))
+            {
+                obj->dispatch_async(conn, sender, obj_path,
+                                    intf_name, meth_name, params, invoc);
+                return;
+            }
+            obj->handle_method_call(conn, sender, obj_path, intf_name,
+                                    meth_name, params, invoc);
         }
 
 
-        static GVariant * dbusobject_callback_get_property(GDBusConnection *conn,
-                                                           const gchar *sender,
-                                                           const gchar *obj_path,
-                                                           const gchar *intf_name,
-                                                           const gchar *property_name,
-                                                           GError **error,
-                                                           gpointer this_ptr)
+        /**
+         *  Dispatches a method call either to the property handlers or
+         *  to the implementation's method handlers
+         */
+        void handle_method_call(GDBusConnection *conn,
+                                const gchar *sender,
+                                const gchar *obj_path,
+                                const gchar *intf_name,
+                                const gchar *meth_name,
+                                GVariant *params,
+                                GDBusMethodInvocation *invoc)
         {
-            class DBusObject *obj = (class DBusObject *) this_ptr;
-            return obj->callback_get_property(conn,
-                                              std::string(sender),
-                                              std::string(obj_path),
-                                              std::string(intf_name),
-                                              std::string(property_name),
-                                              error);
+            // Calls on peer-to-peer connections have no sender
+            if (NULL == sender)
+            {
+                sender = "";
+            }
+
+            if (0 == g_strcmp0("org.freedesktop.DBus.Properties", intf_name))
+            {
+                handle_property_get(conn, sender, obj_path, meth_name,
+                                    params, invoc);
+                return;
+            }
+
+            if (0 == g_strcmp0(DBusMethodStats_interf.c_str(), intf_name))
+            {
+                DBusMethodStats::Instance().HandleMethodCall(meth_name, invoc);
+                return;
+            }
+
+            DBusMethodCall call = {conn, sender, obj_path, intf_name,
+                                   meth_name, params, invoc};
+            if (callback_method_dispatch(call))
+            {
+                return;
+            }
+            callback_method_call(conn, std::string(sender),
+                                 std::string(obj_path),
+                                 std::string(intf_name),
+                                 std::string(meth_name),
+                                 params, invoc);
+        }
+
+
+        /**
+         *  Handles the org.freedesktop.DBus.Properties Get() and GetAll()
+         *  methods.  GDBus have already validated that the interface and
+         *  property exists and that the property is readable.
+         */
+        void handle_property_get(GDBusConnection *conn,
+                                 const gchar *sender,
+                                 const gchar *obj_path,
+                                 const gchar *meth_name,
+                                 GVariant *params,
+                                 GDBusMethodInvocation *invoc)
+        {
+            GError *error = NULL;
+            GVariant *value = NULL;
+            const gchar *intf = NULL;
+
+            bool get = (0 == g_strcmp0("Get", meth_name));
+            if (get)
+            {
+                const gchar *prop = NULL;
+                g_variant_get(params, "(&s&s)", &intf, &prop);
+                value = callback_get_property(conn, sender, obj_path,
+                                              std::string(intf),
+                                              std::string(prop),
+                                              &error);
+            }
+            else if (0 == g_strcmp0("GetAll", meth_name))
+            {
+                g_variant_get(params, "(&s)", &intf);
+                value = callback_get_all_properties(conn, sender, obj_path,
+                                                    std::string(intf),
+                                                    &error);
+            }
+
+            if (NULL == value)
+            {
+                if (error)
+                {
+                    g_dbus_method_invocation_return_gerror(invoc, error);
+                    g_error_free(error);
+                }
+                else
+                {
+                    g_dbus_method_invocation_return_dbus_error(invoc,
+                                                               "org.freedesktop.DBus.Error.Failed",
+                                                               "Could not retrieve property");
+                }
+                return;
+            }
+
+            g_variant_take_ref(value);
+            if (get)
+            {
+                g_dbus_method_invocation_return_value(invoc,
+                                                      g_variant_new("(v)", value));
+            }
+            else
+            {
+                g_dbus_method_invocation_return_value(invoc,
+                                                      g_variant_new("(@a{sv})", value));
+            }
+            g_variant_unref(value);
+        }
+
+
+        /**
+         *  Queues a method call on the worker pool.  The D-Bus connection
+         *  and the call arguments are referenced until the worker have
+         *  completed the call.  The method invocation itself is owned by
+         *  the handler until it has been replied to.
+         *
+         *  If the object is removed before the call got a chance to run,
+         *  the caller receives an UnknownObject error.
+         */
+        void dispatch_async(GDBusConnection *conn,
+                            const gchar *sender,
+                            const gchar *obj_path,
+                            const gchar *intf_name,
+                            const gchar *meth_name,
+                            GVariant *params,
+                            GDBusMethodInvocation *invoc)
+        {
+            g_object_ref(conn);
+            g_variant_ref(params);
+
+            auto release = [conn, params]()
+                           {
+                               g_variant_unref(params);
+                               g_object_unref(conn);
+                           };
+
+            // Calls on peer-to-peer connections have no sender
+            std::string sender_s(sender ? sender : "");
+            std::string obj_path_s(obj_path);
+            std::string intf_name_s(intf_name);
+            std::string meth_name_s(meth_name);
+
+            auto job = [this, conn, params, invoc, release,
+                        sender_s, obj_path_s, intf_name_s, meth_name_s]()
+                       {
+                           try
+                           {
+                               // The object may be deleted by this call;
+                               // do not touch any members afterwards.
+                               handle_method_call(conn, sender_s.c_str(),
+                                                  obj_path_s.c_str(),
+                                                  intf_name_s.c_str(),
+                                                  meth_name_s.c_str(),
+                                                  params, invoc);
+                           }
+                           catch (...)
+                           {
+                               release();
+                               throw;
+                           }
+                           release();
+                       };
+
+            auto cancel = [invoc, release, obj_path_s]()
+                          {
+                              g_dbus_method_invocation_return_dbus_error(
+                                        invoc,
+                                        "org.freedesktop.DBus.Error.UnknownObject",
+                                        std::string("Object removed: " + obj_path_s).c_str());
+                              release();
+                          };
+
+            if (!async_strand->Post(job, cancel))
+            {
+                cancel();
+            }
         }
 
 
@@ -494,10 +937,19 @@ namespace openvpn
                                                          gpointer this_ptr)
         {
             class DBusObject *obj = (class DBusObject *) this_ptr;
-            return obj->_dbus_set_property_internal(conn, sender,
-                                                    obj_path, intf_name,
-                                                    property_name, value,
-                                                    error);
+            auto start = std::chrono::steady_clock::now();
+            gboolean ret = obj->_dbus_set_property_internal(conn, sender,
+                                                            obj_path, intf_name,
+                                                            property_name, value,
+                                                            error);
+
+            // GDBus replies to property updates by itself, so the call
+            // is recorded here instead of when the reply is sent
+            DBusMethodStats::Instance().Record("org.freedesktop.DBus.Properties",
+                                               "Set",
+                                               std::chrono::steady_clock::now() - start,
+                                               !ret);
+            return ret;
         }
     };
 };
@@ -0,0 +1,202 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   objectmanager.hpp
+ *
+ * @brief  Helper implementing the org.freedesktop.DBus.ObjectManager
+ *         interface for the manager objects.
+ */
+
+#ifndef OPENVPN3_DBUS_OBJECTMANAGER_HPP
+#define OPENVPN3_DBUS_OBJECTMANAGER_HPP
+
+#include <map>
+#include <string>
+
+#include "dbus/core.hpp"
+#include "dbus/connection-creds.hpp"
+
+namespace openvpn
+{
+    const std::string DBusObjectManager_interf = "org.freedesktop.DBus.ObjectManager";
+
+
+    /**
+     *  Provides the building blocks for the standard
+     *  org.freedesktop.DBus.ObjectManager interface.  A manager object
+     *  adds the introspection data from GetIntrospection() to its own
+     *  introspection document, answers GetManagedObjects() calls with
+     *  the result of GetManagedObjects() and reports new and removed child
+     *  objects via InterfacesAdded() and InterfacesRemoved().
+     *
+     *  Child objects may contain sensitive information, so only objects
+     *  the caller has access to are included in GetManagedObjects().
+     *  The InterfacesAdded signal is broadcast, so it only carries the
+     *  properties which are readable by everyone; D-Bus clients need to
+     *  retrieve the rest via org.freedesktop.DBus.Properties.GetAll().
+     */
+    class DBusObjectManager
+    {
+    public:
+        /**
+         * @param dbuscon       D-Bus connection signals are sent on
+         * @param manager_path  D-Bus object path of the manager object
+         */
+        DBusObjectManager(GDBusConnection *dbuscon,
+                          const std::string manager_path)
+            : signals(dbuscon, "", DBusObjectManager_interf, manager_path)
+        {
+        }
+
+
+        /**
+         *  Introspection data for the ObjectManager interface, to be
+         *  added to the node of the manager object.
+         *
+         * @return Returns a std::string with the <interface/> XML element
+         */
+        static std::string GetIntrospection()
+        {
+            return "    <interface name='" + DBusObjectManager_interf + "'>"
+                   "        <method name='GetManagedObjects'>"
+                   "            <arg type='a{oa{sa{sv}}}' name='objects' direction='out'/>"
+                   "        </method>"
+                   "        <signal name='InterfacesAdded'>"
+                   "            <arg type='o' name='object_path'/>"
+                   "            <arg type='a{sa{sv}}' name='interfaces_and_properties'/>"
+                   "        </signal>"
+                   "        <signal name='InterfacesRemoved'>"
+                   "            <arg type='o' name='object_path'/>"
+                   "            <arg type='as' name='interfaces'/>"
+                   "        </signal>"
+                   "    </interface>";
+        }
+
+
+        /**
+         *  Builds the GetManagedObjects() response for a caller.  Only
+         *  objects passing the EvaluateACL() test for the caller are included,
+         *  each with all its properties as returned by
+         *  callback_get_all_properties().  The caller typically holds the
+         *  lock protecting the objects map, so callback_get_all_properties()
+         *  must not do any blocking D-Bus calls.
+         *
+         * @param conn     D-Bus connection the call arrived on
+         * @param sender   D-Bus bus name of the caller
+         * @param intf     D-Bus interface of the child objects
+         * @param objects  std::map of object paths to the child objects
+         *
+         * @return Returns a GVariant (a{oa{sa{sv}}}) tuple, ready to be
+         *         passed to g_dbus_method_invocation_return_value()
+         */
+        template <class T>
+        GVariant * GetManagedObjects(GDBusConnection *conn,
+                                     const std::string& sender,
+                                     const std::string& intf,
+                                     const std::map<std::string, T *>& objects)
+        {
+            GVariantBuilder bld;
+            g_variant_builder_init(&bld, G_VARIANT_TYPE("a{oa{sa{sv}}}"));
+
+            for (auto& item : objects)
+            {
+                if (DBusCredentials::ACLDecision::DENY
+                    == item.second->EvaluateACL(sender))
+                {
+                    // Caller does not have access to this object
+                    continue;
+                }
+
+                GError *err = NULL;
+                GVariant *props = item.second->callback_get_all_properties(conn,
+                                                                           sender,
+                                                                           item.first,
+                                                                           intf,
+                                                                           &err);
+                if (NULL == props)
+                {
+                    if (err)
+                    {
+                        g_error_free(err);
+                    }
+                    continue;
+                }
+                add_object(&bld, item.first, intf, props);
+            }
+            return g_variant_new("(a{oa{sa{sv}}})", &bld);
+        }
+
+
+        /**
+         *  Announces a new child object
+         *
+         * @param obj_path  D-Bus object path of the new object
+         * @param intf      D-Bus interface of the new object
+         * @param props     GVariant a{sv} with the properties readable by
+         *                  everyone.  If NULL, an empty set is sent.
+         */
+        void InterfacesAdded(const std::string& obj_path,
+                             const std::string& intf,
+                             GVariant *props)
+        {
+            GVariantBuilder ifaces;
+            g_variant_builder_init(&ifaces, G_VARIANT_TYPE("a{sa{sv}}"));
+            g_variant_builder_add(&ifaces, "{s@a{sv}}", intf.c_str(),
+                                  (props ? props
+                                   : g_variant_new_array(G_VARIANT_TYPE("{sv}"),
+                                                         NULL, 0)));
+            signals.Send("InterfacesAdded",
+                         g_variant_new("(oa{sa{sv}})", obj_path.c_str(),
+                                       &ifaces));
+        }
+
+
+        /**
+         *  Announces a removed child object
+         *
+         * @param obj_path  D-Bus object path of the removed object
+         * @param intf      D-Bus interface of the removed object
+         */
+        void InterfacesRemoved(const std::string& obj_path,
+                               const std::string& intf)
+        {
+            GVariantBuilder ifaces;
+            g_variant_builder_init(&ifaces, G_VARIANT_TYPE("as"));
+            g_variant_builder_add(&ifaces, "s", intf.c_str());
+            signals.Send("InterfacesRemoved",
+                         g_variant_new("(oas)", obj_path.c_str(), &ifaces));
+        }
+
+
+    private:
+        DBusSignalProducer signals;
+
+        void add_object(GVariantBuilder *bld, const std::string& obj_path,
+                        const std::string& intf, GVariant *props)
+        {
+            GVariantBuilder ifaces;
+            g_variant_builder_init(&ifaces, G_VARIANT_TYPE("a{sa{sv}}"));
+            g_variant_builder_add(&ifaces, "{s@a{sv}}", intf.c_str(), props);
+            g_variant_builder_add(bld, "{oa{sa{sv}}}", obj_path.c_str(),
+                                  &ifaces);
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_OBJECTMANAGER_HPP
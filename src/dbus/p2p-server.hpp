@@ -0,0 +1,361 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   p2p-server.hpp
+ *
+ * @brief  Private peer-to-peer D-Bus connections, bypassing the D-Bus
+ *         daemon, which are handed over to a receiver based on a
+ *         registration token.
+ */
+
+#ifndef OPENVPN3_DBUS_P2P_SERVER_HPP
+#define OPENVPN3_DBUS_P2P_SERVER_HPP
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "dbus/exceptions.hpp"
+
+namespace openvpn
+{
+    /**
+     *  Accepts private D-Bus connections on a unix socket.  No bus daemon
+     *  is involved, so method calls and signals on these connections are
+     *  only seen by the two peers.
+     *
+     *  Only peers running as root or as the same user as this process are
+     *  accepted.  A new connection is kept pending until the peer sends
+     *  a registration signal carrying a token.  The connection is then
+     *  handed over to the handler registered for that token via
+     *  AddToken().  Connections with an unknown token are closed.
+     *
+     *  All the callbacks are run in the main loop of the thread calling
+     *  Start().
+     */
+    class DBusP2PServer
+    {
+    public:
+        /**
+         *  Called when a peer have registered with a known token.  The
+         *  handler takes over the reference of the connection and is
+         *  responsible for closing it.
+         *
+         *  @param conn      The private D-Bus connection to the peer
+         *  @param obj_path  D-Bus object path the registration signal
+         *                   was sent from
+         *  @param params    The registration signal arguments
+         */
+        typedef std::function<void(GDBusConnection *conn,
+                                   const std::string& obj_path,
+                                   GVariant *params)> Handler;
+
+
+        /**
+         * @param address      D-Bus address to listen on
+         * @param intf_name    D-Bus interface of the registration signal
+         * @param signal_name  Name of the registration signal
+         * @param token_arg    Index of the string argument of the signal
+         *                     carrying the token
+         */
+        DBusP2PServer(const std::string& address,
+                      const std::string& intf_name,
+                      const std::string& signal_name,
+                      unsigned int token_arg)
+            : address(address),
+              intf_name(intf_name),
+              signal_name(signal_name),
+              token_arg(token_arg),
+              server(nullptr),
+              observer(nullptr)
+        {
+        }
+
+
+        ~DBusP2PServer()
+        {
+            Stop();
+        }
+
+
+        /**
+         *  Starts listening for new connections
+         */
+        void Start()
+        {
+            if (server)
+            {
+                return;
+            }
+
+            observer = g_dbus_auth_observer_new();
+            g_signal_connect(observer, "allow-mechanism",
+                             G_CALLBACK(p2p_allow_mechanism), NULL);
+            g_signal_connect(observer, "authorize-authenticated-peer",
+                             G_CALLBACK(p2p_authorize_peer), NULL);
+
+            gchar *guid = g_dbus_generate_guid();
+            GError *error = NULL;
+            server = g_dbus_server_new_sync(address.c_str(),
+                                            G_DBUS_SERVER_FLAGS_NONE,
+                                            guid,
+                                            observer,
+                                            NULL,  // GCancellable
+                                            &error);
+            g_free(guid);
+            if (NULL == server)
+            {
+                std::string errmsg(error ? error->message : "(unknown)");
+                if (error)
+                {
+                    g_error_free(error);
+                }
+                g_object_unref(observer);
+                observer = nullptr;
+                THROW_DBUSEXCEPTION("DBusP2PServer",
+                                    "Could not listen on " + address
+                                    + ": " + errmsg);
+            }
+            g_signal_connect(server, "new-connection",
+                             G_CALLBACK(p2p_new_connection), this);
+            g_dbus_server_start(server);
+        }
+
+
+        /**
+         *  Stops listening and closes all pending connections.
+         *  Connections already handed over are not affected.
+         */
+        void Stop()
+        {
+            if (server)
+            {
+                g_dbus_server_stop(server);
+                g_signal_handlers_disconnect_by_data(server, this);
+                g_object_unref(server);
+                server = nullptr;
+            }
+            if (observer)
+            {
+                g_object_unref(observer);
+                observer = nullptr;
+            }
+
+            std::map<GDBusConnection *, guint> closing;
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                closing.swap(pending);
+            }
+            for (auto& p : closing)
+            {
+                drop_connection(p.first, p.second);
+            }
+        }
+
+
+        /**
+         *  Retrieve the address peers connect to
+         */
+        std::string GetClientAddress() const
+        {
+            return (server ? std::string(g_dbus_server_get_client_address(server))
+                           : address);
+        }
+
+
+        /**
+         *  Registers a handler for peers registering with a token
+         *
+         * @param token    Token the peer is expected to send
+         * @param handler  Handler to call with the new connection
+         */
+        void AddToken(const std::string& token, Handler handler)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            handlers[token] = handler;
+        }
+
+
+        /**
+         *  Removes a token handler.  Unknown tokens are ignored.
+         *
+         * @param token  Token to remove
+         */
+        void RemoveToken(const std::string& token)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            handlers.erase(token);
+        }
+
+
+    private:
+        std::string address;
+        std::string intf_name;
+        std::string signal_name;
+        unsigned int token_arg;
+        GDBusServer *server;
+        GDBusAuthObserver *observer;
+        std::mutex guard;
+        std::map<std::string, Handler> handlers;
+        std::map<GDBusConnection *, guint> pending;
+
+
+        /**
+         *  Unsubscribes the registration signal of a pending connection,
+         *  closes it and releases our reference.
+         */
+        void drop_connection(GDBusConnection *conn, guint subscr_id)
+        {
+            g_signal_handlers_disconnect_by_data(conn, this);
+            g_dbus_connection_signal_unsubscribe(conn, subscr_id);
+            g_dbus_connection_close(conn, NULL, NULL, NULL);
+            g_object_unref(conn);
+        }
+
+
+        static gboolean p2p_allow_mechanism(GDBusAuthObserver *observer,
+                                            const gchar *mechanism,
+                                            gpointer data)
+        {
+            // Only accept authentication based on the socket credentials
+            return (0 == g_strcmp0("EXTERNAL", mechanism));
+        }
+
+
+        static gboolean p2p_authorize_peer(GDBusAuthObserver *observer,
+                                           GIOStream *stream,
+                                           GCredentials *credentials,
+                                           gpointer data)
+        {
+            if (NULL == credentials)
+            {
+                return FALSE;
+            }
+            uid_t uid = g_credentials_get_unix_user(credentials, NULL);
+            return (0 == uid || geteuid() == uid);
+        }
+
+
+        static gboolean p2p_new_connection(GDBusServer *server,
+                                           GDBusConnection *conn,
+                                           gpointer this_ptr)
+        {
+            DBusP2PServer *srv = (DBusP2PServer *) this_ptr;
+
+            g_object_ref(conn);
+            guint subscr_id = g_dbus_connection_signal_subscribe(conn,
+                                                                 NULL,
+                                                                 srv->intf_name.c_str(),
+                                                                 srv->signal_name.c_str(),
+                                                                 NULL,
+                                                                 NULL,
+                                                                 G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                 p2p_registration,
+                                                                 srv,
+                                                                 NULL);
+            g_signal_connect(conn, "closed", G_CALLBACK(p2p_closed), srv);
+
+            std::lock_guard<std::mutex> lg(srv->guard);
+            srv->pending[conn] = subscr_id;
+            return TRUE;
+        }
+
+
+        static void p2p_closed(GDBusConnection *conn,
+                               gboolean remote_peer_vanished,
+                               GError *error,
+                               gpointer this_ptr)
+        {
+            DBusP2PServer *srv = (DBusP2PServer *) this_ptr;
+            g_signal_handlers_disconnect_by_data(conn, srv);
+
+            guint subscr_id = 0;
+            {
+                std::lock_guard<std::mutex> lg(srv->guard);
+                auto it = srv->pending.find(conn);
+                if (srv->pending.end() == it)
+                {
+                    return;
+                }
+                subscr_id = it->second;
+                srv->pending.erase(it);
+            }
+            g_dbus_connection_signal_unsubscribe(conn, subscr_id);
+            g_object_unref(conn);
+        }
+
+
+        static void p2p_registration(GDBusConnection *conn,
+                                     const gchar *sender,
+                                     const gchar *obj_path,
+                                     const gchar *intf_name,
+                                     const gchar *sign_name,
+                                     GVariant *params,
+                                     gpointer this_ptr)
+        {
+            DBusP2PServer *srv = (DBusP2PServer *) this_ptr;
+
+            std::string token;
+            if (g_variant_n_children(params) > srv->token_arg)
+            {
+                GVariant *tok = g_variant_get_child_value(params, srv->token_arg);
+                if (g_variant_is_of_type(tok, G_VARIANT_TYPE_STRING))
+                {
+                    token = std::string(g_variant_get_string(tok, NULL));
+                }
+                g_variant_unref(tok);
+            }
+
+            guint subscr_id = 0;
+            Handler handler;
+            {
+                std::lock_guard<std::mutex> lg(srv->guard);
+                auto pit = srv->pending.find(conn);
+                if (srv->pending.end() == pit)
+                {
+                    return;
+                }
+                subscr_id = pit->second;
+                srv->pending.erase(pit);
+
+                auto hit = srv->handlers.find(token);
+                if (srv->handlers.end() != hit)
+                {
+                    handler = hit->second;
+                    srv->handlers.erase(hit);
+                }
+            }
+            if (!handler)
+            {
+                // Not a peer we are waiting for
+                srv->drop_connection(conn, subscr_id);
+                return;
+            }
+            g_signal_handlers_disconnect_by_data(conn, srv);
+            g_dbus_connection_signal_unsubscribe(conn, subscr_id);
+            handler(conn, std::string(obj_path), params);
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_P2P_SERVER_HPP
@@ -20,11 +20,182 @@
 #ifndef OPENVPN3_DBUS_PROXY_HPP
 #define OPENVPN3_DBUS_PROXY_HPP
 
+#include <functional>
+#include <future>
+
+#include <gio/gunixfdlist.h>
+
+#include "proxycache.hpp"
+
 namespace openvpn
 {
+    /**
+     *  Holds the result of an org.freedesktop.DBus.Properties.GetAll()
+     *  call, providing typed access to each of the retrieved properties.
+     *  All values are fetched in a single D-Bus round trip by
+     *  DBusProxy::GetAllProperties().
+     */
+    class DBusPropertySnapshot
+    {
+    public:
+        /**
+         *  Wraps a GVariant a{sv} dictionary.  The snapshot takes over
+         *  the reference to the dictionary.
+         *
+         * @param dict  GVariant a{sv} with property names and values
+         */
+        DBusPropertySnapshot(GVariant *dict)
+            : properties(dict)
+        {
+            if (NULL == properties
+                || !g_variant_is_of_type(properties, G_VARIANT_TYPE("a{sv}")))
+            {
+                THROW_DBUSEXCEPTION("DBusPropertySnapshot",
+                                    "Invalid property dictionary");
+            }
+        }
+
+
+        DBusPropertySnapshot(const DBusPropertySnapshot& orig)
+            : properties(g_variant_ref(orig.properties))
+        {
+        }
+
+
+        DBusPropertySnapshot& operator=(const DBusPropertySnapshot& orig)
+        {
+            if (this != &orig)
+            {
+                GVariant *old = properties;
+                properties = g_variant_ref(orig.properties);
+                g_variant_unref(old);
+            }
+            return *this;
+        }
+
+
+        ~DBusPropertySnapshot()
+        {
+            g_variant_unref(properties);
+        }
+
+
+        /**
+         *  Checks if a property was included in the snapshot.  Properties
+         *  the caller is not allowed to read are not included.
+         *
+         * @param property  Name of the property
+         * @return Returns true if the property value is available
+         */
+        bool Exists(const std::string& property) const
+        {
+            GVariant *v = g_variant_lookup_value(properties,
+                                                 property.c_str(), NULL);
+            if (NULL == v)
+            {
+                return false;
+            }
+            g_variant_unref(v);
+            return true;
+        }
+
+
+        /**
+         *  Retrieve the raw value of a property
+         *
+         * @param property  Name of the property
+         * @return Returns a GVariant with the value which must be released
+         *         with g_variant_unref().  If the property is not available
+         *         a DBusException is thrown.
+         */
+        GVariant * Get(const std::string& property) const
+        {
+            return lookup(property, NULL);
+        }
+
+
+        bool GetBool(const std::string& property) const
+        {
+            GVariant *v = lookup(property, G_VARIANT_TYPE_BOOLEAN);
+            bool ret = g_variant_get_boolean(v);
+            g_variant_unref(v);
+            return ret;
+        }
+
+
+        std::string GetString(const std::string& property) const
+        {
+            // Object paths and signatures are also returned as strings
+            GVariant *v = lookup(property, NULL);
+            if (!g_variant_is_of_type(v, G_VARIANT_TYPE_STRING)
+                && !g_variant_is_of_type(v, G_VARIANT_TYPE_OBJECT_PATH)
+                && !g_variant_is_of_type(v, G_VARIANT_TYPE_SIGNATURE))
+            {
+                g_variant_unref(v);
+                THROW_DBUSEXCEPTION("DBusPropertySnapshot",
+                                    "Property '" + property + "' is not "
+                                    "a string");
+            }
+            std::string ret(g_variant_get_string(v, NULL));
+            g_variant_unref(v);
+            return ret;
+        }
+
+
+        guint32 GetUInt(const std::string& property) const
+        {
+            GVariant *v = lookup(property, G_VARIANT_TYPE_UINT32);
+            guint32 ret = g_variant_get_uint32(v);
+            g_variant_unref(v);
+            return ret;
+        }
+
+
+        guint64 GetUInt64(const std::string& property) const
+        {
+            GVariant *v = lookup(property, G_VARIANT_TYPE_UINT64);
+            guint64 ret = g_variant_get_uint64(v);
+            g_variant_unref(v);
+            return ret;
+        }
+
+
+    private:
+        GVariant *properties;
+
+        GVariant * lookup(const std::string& property,
+                          const GVariantType *type) const
+        {
+            GVariant *v = g_variant_lookup_value(properties,
+                                                 property.c_str(), type);
+            if (NULL == v)
+            {
+                THROW_DBUSEXCEPTION("DBusPropertySnapshot",
+                                    "Property '" + property + "' is not "
+                                    "available or of an unexpected type");
+            }
+            return v;
+        }
+    };
+
+
+
     class DBusProxy : public DBus
     {
     public:
+        /**
+         *  Callback function type used by the asynchronous call methods.
+         *
+         *  On success, response contains the result of the call and error
+         *  is NULL.  On failure, response is NULL and error describes the
+         *  failure; a cancelled call is reported with G_IO_ERROR_CANCELLED
+         *  and a call which timed out with G_IO_ERROR_TIMED_OUT.
+         *
+         *  Both response and error are released when the callback returns.
+         *  Use g_variant_ref() on the response to keep it.
+         */
+        typedef std::function<void(GVariant *response, GError *error)> AsyncCallback;
+
         DBusProxy(GBusType bus_type,
                   std::string const & busname,
                   std::string const & interf,
@@ -36,13 +207,11 @@ namespace openvpn
               interface(interf),
               object_path(objpath),
               call_flags(G_DBUS_CALL_FLAGS_NONE),
+              call_timeout(-1),
               proxy_init(false),
               property_proxy_init(false)
         {
             proxy = SetupProxy(bus_name, interface, object_path);
-            property_proxy = SetupProxy(bus_name,
-                                        "org.freedesktop.DBus.Properties",
-                                        object_path);
         }
 
 
@@ -58,15 +227,13 @@ namespace openvpn
               interface(interf),
               object_path(objpath),
               call_flags(G_DBUS_CALL_FLAGS_NONE),
+              call_timeout(-1),
               proxy_init(false),
               property_proxy_init(false)
         {
             if (!hold_setup_proxy)
             {
                 proxy = SetupProxy(bus_name, interface, object_path);
-                property_proxy = SetupProxy(bus_name,
-                                            "org.freedesktop.DBus.Properties",
-                                            object_path);
             }
         }
 
@@ -82,13 +249,11 @@ namespace openvpn
               interface(interf),
               object_path(objpath),
               call_flags(G_DBUS_CALL_FLAGS_NONE),
+              call_timeout(-1),
               proxy_init(false),
               property_proxy_init(false)
         {
             proxy = SetupProxy(bus_name, interface, object_path);
-            property_proxy = SetupProxy(bus_name,
-                                        "org.freedesktop.DBus.Properties",
-                                        object_path);
         }
 
 
@@ -104,15 +269,13 @@ namespace openvpn
               interface(interf),
               object_path(objpath),
               call_flags(G_DBUS_CALL_FLAGS_NONE),
+              call_timeout(-1),
               proxy_init(false),
               property_proxy_init(false)
         {
             if (!hold_setup_proxy)
             {
                 proxy = SetupProxy(bus_name, interface, object_path);
-                property_proxy = SetupProxy(bus_name,
-                                            "org.freedesktop.DBus.Properties",
-                                            object_path);
             }
         }
 
@@ -128,13 +291,11 @@ namespace openvpn
               interface(interf),
               object_path(objpath),
               call_flags(G_DBUS_CALL_FLAGS_NONE),
+              call_timeout(-1),
               proxy_init(false),
               property_proxy_init(false)
         {
             proxy = SetupProxy(bus_name, interface, object_path);
-            property_proxy = SetupProxy(bus_name,
-                                        "org.freedesktop.DBus.Properties",
-                                        object_path);
         }
 
 
@@ -150,35 +311,29 @@ namespace openvpn
               interface(interf),
               object_path(objpath),
               call_flags(G_DBUS_CALL_FLAGS_NONE),
+              call_timeout(-1),
               proxy_init(false),
               property_proxy_init(false)
         {
             if( !hold_setup_proxy )
             {
                 proxy = SetupProxy(bus_name, interface, object_path);
-                property_proxy = SetupProxy(bus_name,
-                                            "org.freedesktop.DBus.Properties",
-                                            object_path);
             }
         }
 
 
         virtual ~DBusProxy()
         {
-            // If this object is using an existing connection;
-            // don't trigger a disconnect.  This variable is
-            // defined and set in the DBus class.
-            if (keep_connection)
-            {
-                return;
-            }
-
-            if (proxy_init)
+            // The GDBusProxy objects carries their own reference to the
+            // D-Bus connection and may be shared with other DBusProxy
+            // objects via the DBusProxyCache, so only our references are
+            // released here.
+            if (proxy_init && proxy)
             {
                 g_object_unref(proxy);
             }
 
-            if (property_proxy_init)
+            if (property_proxy_init && property_proxy)
             {
                 g_object_unref(property_proxy);
             }
@@ -191,6 +346,20 @@ namespace openvpn
         }
 
 
+        /**
+         *  Sets the timeout used for all calls done through this proxy
+         *  object, unless a timeout is given to the call itself.
+         *
+         * @param timeout  Timeout in milliseconds.  -1 uses the D-Bus
+         *                 library default (25 seconds), G_MAXINT disables
+         *                 the timeout.
+         */
+        void SetCallTimeout(int timeout)
+        {
+            call_timeout = timeout;
+        }
+
+
         /**
          *  Tries to ping a the destination service.  This is used to
          *  activate auto-start of services and give it time to settle.
@@ -209,8 +378,10 @@ namespace openvpn
             {
                 try
                 {
-                    dbus_proxy_call(peer_proxy, "Ping", NULL,
-                                    false, call_flags);
+                    GVariant *r = dbus_proxy_call(peer_proxy, "Ping", NULL,
+                                                  false, call_flags);
+                    g_variant_unref(r);
+                    g_object_unref(peer_proxy);
                     usleep(250);
                     return;
                 }
@@ -218,6 +389,7 @@ namespace openvpn
                 {
                     if (2 == i)
                     {
+                        g_object_unref(peer_proxy);
                         THROW_DBUSEXCEPTION("DBusProxy",
                                             "D-Bus service '"
                                             + bus_name + "' did not respond");
@@ -242,6 +414,146 @@ namespace openvpn
         }
 
 
+        /**
+         *  Calls a D-Bus method passing and/or receiving file descriptors
+         *
+         * @param method      D-Bus method to call
+         * @param params      GVariant with the method arguments.  File
+         *                    descriptors are referenced by 'h' handles
+         *                    indexing fd_list.
+         * @param fd_list     GUnixFDList with file descriptors to pass.  May
+         *                    be NULL.
+         * @param out_fd_list Pointer which will be set to a GUnixFDList with
+         *                    the file descriptors returned, if any.  The
+         *                    caller must release it with g_object_unref().
+         *
+         * @return Returns the GVariant result of the method call
+         */
+        GVariant * CallWithFDList(std::string method, GVariant *params,
+                                  GUnixFDList *fd_list,
+                                  GUnixFDList **out_fd_list)
+        {
+            if (method.empty())
+            {
+                THROW_DBUSEXCEPTION("DBusProxy", "Method cannot be empty");
+            }
+
+            GError *error = NULL;
+            GVariant *ret = g_dbus_proxy_call_with_unix_fd_list_sync(proxy,
+                                                                     method.c_str(),
+                                                                     params,
+                                                                     call_flags,
+                                                                     call_timeout,
+                                                                     fd_list,
+                                                                     out_fd_list,
+                                                                     NULL,  // GCancellable
+                                                                     &error);
+            if (!ret || error)
+            {
+                std::stringstream errmsg;
+                errmsg << "Failed calling D-Bus method " << method << ": "
+                       << (error ? error->message : "(unknown)");
+                bool unknown = (error && g_error_matches(error, G_DBUS_ERROR,
+                                                         G_DBUS_ERROR_UNKNOWN_METHOD));
+                if (error)
+                {
+                    g_error_free(error);
+                }
+                if (unknown)
+                {
+                    throw DBusUnknownMethodException("DBusProxy", errmsg.str(),
+                                                     __FILE__, __LINE__, __FUNCTION__);
+                }
+                THROW_DBUSEXCEPTION("DBusProxy", errmsg.str());
+            }
+            return ret;
+        }
+
+
+        /**
+         *  Checks if file descriptors can be passed over the D-Bus
+         *  connection used by this proxy.
+         *
+         * @return Returns true if file descriptor passing is supported
+         */
+        bool CanPassFDs()
+        {
+            return (g_dbus_connection_get_capabilities(GetConnection())
+                    & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING) != 0;
+        }
+
+
+        /**
+         *  Calls a D-Bus method without waiting for the response.  The
+         *  callback is run from the GLib main context which was the thread
+         *  default context when this method was called; for threads not
+         *  running their own main context this is the global default main
+         *  loop.
+         *
+         * @param method       D-Bus method to call
+         * @param params       GVariant with the method arguments, may be NULL
+         * @param callback     AsyncCallback to run once the call completes
+         * @param cancellable  GCancellable which can abort the call, may be
+         *                     NULL
+         * @param timeout      Timeout in milliseconds for this call.  0 uses
+         *                     the timeout set via SetCallTimeout()
+         */
+        void CallAsync(std::string method, GVariant *params,
+                       AsyncCallback callback,
+                       GCancellable *cancellable = NULL, int timeout = 0)
+        {
+            dbus_proxy_call_async(proxy, method, params, call_flags,
+                                  (0 == timeout ? call_timeout : timeout),
+                                  cancellable, callback);
+        }
+
+
+        /**
+         *  Calls a D-Bus method and returns a std::future for the response.
+         *  The future will provide the GVariant response, which the caller
+         *  must release with g_variant_unref().  On errors, the future will
+         *  throw a DBusException.
+         *
+         *  The future is completed by the GLib main loop.  Never wait for
+         *  the future in the thread running the main loop, that will
+         *  deadlock.
+         *
+         * @param method       D-Bus method to call
+         * @param params       GVariant with the method arguments, may be NULL
+         * @param cancellable  GCancellable which can abort the call, may be
+         *                     NULL
+         * @param timeout      Timeout in milliseconds for this call.  0 uses
+         *                     the timeout set via SetCallTimeout()
+         *
+         * @return  Returns a std::future<GVariant *> with the call response
+         */
+        std::future<GVariant *> CallFuture(std::string method,
+                                           GVariant *params = NULL,
+                                           GCancellable *cancellable = NULL,
+                                           int timeout = 0)
+        {
+            auto result = std::make_shared<std::promise<GVariant *>>();
+            CallAsync(method, params,
+                      [result, method](GVariant *response, GError *error)
+                      {
+                          if (error)
+                          {
+                              result->set_exception(std::make_exception_ptr(
+                                  DBusException("DBusProxy",
+                                                "Failed calling D-Bus method "
+                                                + method + ": "
+                                                + std::string(error->message),
+                                                __FILE__, __LINE__,
+                                                __FUNCTION__)));
+                              return;
+                          }
+                          result->set_value(g_variant_ref(response));
+                      },
+                      cancellable, timeout);
+            return result->get_future();
+        }
+
+
         GVariant * GetProperty(std::string property)
         {
             if (property.empty())
@@ -254,13 +566,13 @@ namespace openvpn
             // might not be updated and we get the wrong values.
 
             GError *error = NULL;
-            GVariant *response = g_dbus_proxy_call_sync(property_proxy,
+            GVariant *response = g_dbus_proxy_call_sync(get_property_proxy(),
                                                         "Get",
                                                         g_variant_new("(ss)",
                                                                       interface.c_str(),
                                                                       property.c_str()),
                                                         G_DBUS_CALL_FLAGS_NONE,
-                                                        -1,          // timeout, -1 == default
+                                                        call_timeout,
                                                         NULL,        // GCancellable
                                                         &error);
             if (!response || error)
@@ -284,6 +596,88 @@ namespace openvpn
         }
 
 
+        /**
+         *  Retrieves all the properties of the object in a single
+         *  org.freedesktop.DBus.Properties.GetAll() call.
+         *
+         * @return Returns a DBusPropertySnapshot with all the properties the
+         *         caller is allowed to read.
+         */
+        DBusPropertySnapshot GetAllProperties()
+        {
+            GError *error = NULL;
+            GVariant *response = g_dbus_proxy_call_sync(get_property_proxy(),
+                                                        "GetAll",
+                                                        g_variant_new("(s)",
+                                                                      interface.c_str()),
+                                                        G_DBUS_CALL_FLAGS_NONE,
+                                                        call_timeout,
+                                                        NULL,        // GCancellable
+                                                        &error);
+            if (!response || error)
+            {
+                std::stringstream errmsg;
+                errmsg << "Failed calling D-Bus method "
+                       << "org.freedesktop.DBus.Properties.GetAll("
+                       << "interface=" << interface
+                       << ")";
+                if (error)
+                {
+                    errmsg << ": " << error->message;
+                }
+                THROW_DBUSEXCEPTION("DBusProxy", errmsg.str());
+            }
+            GVariant *dict = NULL;
+            g_variant_get(response, "(@a{sv})", &dict);
+            g_variant_unref(response);
+            return DBusPropertySnapshot(dict);
+        }
+
+
+        /**
+         *  Retrieves a D-Bus object property without waiting for the
+         *  response.  The callback receives the property value itself, not
+         *  the org.freedesktop.DBus.Properties.Get() response tuple.
+         *  See CallAsync() for details on how the callback is run.
+         *
+         * @param property     Name of the property to retrieve
+         * @param callback     AsyncCallback to run once the value arrives
+         * @param cancellable  GCancellable which can abort the call, may be
+         *                     NULL
+         * @param timeout      Timeout in milliseconds for this call.  0 uses
+         *                     the timeout set via SetCallTimeout()
+         */
+        void GetPropertyAsync(std::string property, AsyncCallback callback,
+                              GCancellable *cancellable = NULL,
+                              int timeout = 0)
+        {
+            if (property.empty())
+            {
+                THROW_DBUSEXCEPTION("DBusProxy", "Property cannot be empty");
+            }
+
+            dbus_proxy_call_async(get_property_proxy(), "Get",
+                                  g_variant_new("(ss)",
+                                                interface.c_str(),
+                                                property.c_str()),
+                                  G_DBUS_CALL_FLAGS_NONE,
+                                  (0 == timeout ? call_timeout : timeout),
+                                  cancellable,
+                                  [callback](GVariant *response, GError *error)
+                                  {
+                                      if (error)
+                                      {
+                                          callback(NULL, error);
+                                          return;
+                                      }
+                                      GVariant *value = NULL;
+                                      g_variant_get(response, "(v)", &value);
+                                      callback(value, NULL);
+                                      g_variant_unref(value);
+                                  });
+        }
+
+
         bool GetBoolProperty(std::string property)
         {
             GVariant *res = GetProperty(property);
@@ -335,14 +729,14 @@ namespace openvpn
             // change is never sent to the backend service.
 
             GError *error = NULL;
-            GVariant *ret = g_dbus_proxy_call_sync(property_proxy,
+            GVariant *ret = g_dbus_proxy_call_sync(get_property_proxy(),
                                                    "Set",
                                                    g_variant_new("(ssv)",
                                                                  interface.c_str(),
                                                                  property.c_str(),
                                                                  value),
                                                    G_DBUS_CALL_FLAGS_NONE,
-                                                   -1,          // timeout, -1 == default
+                                                   call_timeout,
                                                    NULL,        // GCancellable
                                                    &error);
             if (!ret || error)
@@ -359,6 +753,42 @@ namespace openvpn
         }
 
 
+        /**
+         *  Modifies a D-Bus object property without waiting for the
+         *  response.  See CallAsync() for details on how the callback is
+         *  run.
+         *
+         * @param property     Name of the property to modify
+         * @param value        GVariant containing the new value
+         * @param callback     AsyncCallback to run once the change is
+         *                     completed.  May be nullptr if the result is
+         *                     not interesting.
+         * @param cancellable  GCancellable which can abort the call, may be
+         *                     NULL
+         * @param timeout      Timeout in milliseconds for this call.  0 uses
+         *                     the timeout set via SetCallTimeout()
+         */
+        void SetPropertyAsync(std::string property, GVariant *value,
+                              AsyncCallback callback,
+                              GCancellable *cancellable = NULL,
+                              int timeout = 0)
+        {
+            if (property.empty())
+            {
+                THROW_DBUSEXCEPTION("DBusProxy", "Property cannot be empty");
+            }
+
+            dbus_proxy_call_async(get_property_proxy(), "Set",
+                                  g_variant_new("(ssv)",
+                                                interface.c_str(),
+                                                property.c_str(),
+                                                value),
+                                  G_DBUS_CALL_FLAGS_NONE,
+                                  (0 == timeout ? call_timeout : timeout),
+                                  cancellable, callback);
+        }
+
+
         inline void SetProperty(std::string property, bool value)
         {
             SetProperty(property, g_variant_new_boolean(value));
@@ -383,10 +813,6 @@ namespace openvpn
 
         GDBusProxy * SetupProxy(std::string busn, std::string intf, std::string objp)
         {
-            if (busn.empty()) {
-                THROW_DBUSEXCEPTION("DBusProxy", "Bus name cannot be empty");
-            }
-
             if (intf.empty()) {
                 THROW_DBUSEXCEPTION("DBusProxy", "Interface cannot be empty");
             }
@@ -400,6 +826,12 @@ namespace openvpn
             // checks if a connection is already established
             Connect();
 
+            // Private peer-to-peer connections have no bus names
+            if (busn.empty()
+                && NULL != g_dbus_connection_get_unique_name(GetConnection())) {
+                THROW_DBUSEXCEPTION("DBusProxy", "Bus name cannot be empty");
+            }
+
             /*
               std::cout << "[DBusProxy::SetupProxy] bus_name=" << busn
                       << ", interface=" << intf
@@ -407,18 +839,14 @@ namespace openvpn
                       << std::endl;
             */
 
-            // Prepare a new D-Bus proxy, which the
-            // client side uses when communicating with
-            // a D-Bus service
+            // Retrieve a D-Bus proxy, which the client side uses when
+            // communicating with a D-Bus service.  Proxies are shared
+            // with other DBusProxy objects using the same connection and
+            // D-Bus object.
             GError *error = NULL;
-            GDBusProxy *retprx = g_dbus_proxy_new_sync(GetConnection(),
-                                                       G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
-                                                       NULL,             // GDBusInterfaceInfo
-                                                       busn.c_str(),     // aka. destination
-                                                       objp.c_str(),
-                                                       intf.c_str(),
-                                                       NULL,             // GCancellable
-                                                       &error);
+            GDBusProxy *retprx = DBusProxyCache::Instance().Acquire(GetConnection(),
+                                                                    busn, objp, intf,
+                                                                    &error);
             if (!retprx || error)
             {
                 std::stringstream errmsg;
@@ -447,14 +875,64 @@ namespace openvpn
         }
 
 
+        /**
+         *  Changes the D-Bus object path this proxy operates on.  This must
+         *  be called before the proxies are set up, which is used by
+         *  subclasses which needs to look up the object path first.
+         *
+         * @param objp  D-Bus object path to use
+         */
+        void SetObjectPath(const std::string& objp)
+        {
+            object_path = objp;
+        }
+
+
+        /**
+         *  Retrieve the org.freedesktop.DBus.Properties proxy.  This
+         *  proxy is only set up the first time it is needed, as many
+         *  DBusProxy users only call methods.
+         */
+        GDBusProxy * get_property_proxy()
+        {
+            GDBusProxy *prx = (GDBusProxy *) g_atomic_pointer_get(&property_proxy);
+            if (NULL != prx)
+            {
+                return prx;
+            }
+
+            prx = SetupProxy(bus_name, "org.freedesktop.DBus.Properties",
+                             object_path);
+            if (!g_atomic_pointer_compare_and_exchange(&property_proxy,
+                                                       NULL, prx))
+            {
+                // Another thread set it up at the same time
+                g_object_unref(prx);
+            }
+            return (GDBusProxy *) g_atomic_pointer_get(&property_proxy);
+        }
+
+
     private:
         std::string bus_name;
         std::string interface;
         std::string object_path;
         GDBusCallFlags call_flags;
+        int call_timeout;
         bool proxy_init;
         bool property_proxy_init;
 
+
+        /**
+         *  Carries the callback of an asynchronous call until the D-Bus
+         *  library reports the call as completed.
+         */
+        struct AsyncCallContext
+        {
+            std::string method;
+            AsyncCallback callback;
+        };
+
         GVariant * dbus_proxy_call(GDBusProxy *prx, std::string method,
                                    GVariant *params, bool noresponse,
                                    GDBusCallFlags flags)
@@ -473,7 +951,7 @@ namespace openvpn
                                                        method.c_str(),
                                                        params,      // parameters to method
                                                        flags,
-                                                       -1,          // timeout, -1 == default
+                                                       call_timeout,
                                                        NULL,        // GCancellable
                                                        &error);
                 if (!ret || error)
@@ -489,13 +967,77 @@ namespace openvpn
             {
                 g_dbus_proxy_call(prx, method.c_str(), params,
                                   flags,
-                                  -1,       // timeout, -1 == default
+                                  call_timeout,
                                   NULL,     // GCancellable
                                   NULL,     // Response callback, not needed here
                                   NULL);    // user_data, not needed due to no callback
                 return NULL;
             }
         }
+
+
+        /**
+         *  Starts an asynchronous method call.  The GDBusProxy is referenced
+         *  by the D-Bus library until the call completes, so the callback
+         *  is safe to run even if this DBusProxy object is removed before
+         *  the response arrives.  The callback must not reference this
+         *  object in that case.
+         */
+        void dbus_proxy_call_async(GDBusProxy *prx, std::string method,
+                                   GVariant *params, GDBusCallFlags flags,
+                                   int timeout, GCancellable *cancellable,
+                                   AsyncCallback callback)
+        {
+            if (method.empty())
+            {
+                THROW_DBUSEXCEPTION("DBusProxy", "Method cannot be empty");
+            }
+
+            AsyncCallContext *ctx = new AsyncCallContext{method, callback};
+            g_dbus_proxy_call(prx, method.c_str(), params,
+                              flags, timeout, cancellable,
+                              dbus_proxy_call_async_done,
+                              ctx);
+        }
+
+
+        /**
+         *  C wrapper called by the D-Bus library when an asynchronous
+         *  call started by dbus_proxy_call_async() completes.
+         */
+        static void dbus_proxy_call_async_done(GObject *source,
+                                               GAsyncResult *res,
+                                               gpointer user_data)
+        {
+            AsyncCallContext *ctx = (AsyncCallContext *) user_data;
+
+            GError *error = NULL;
+            GVariant *ret = g_dbus_proxy_call_finish(G_DBUS_PROXY(source),
+                                                     res, &error);
+            try
+            {
+                if (ctx->callback)
+                {
+                    ctx->callback((error ? NULL : ret), error);
+                }
+            }
+            catch (std::exception& excp)
+            {
+                std::cerr << "** ERROR ** Unhandled exception in callback for "
+                          << "D-Bus method " << ctx->method << ": "
+                          << excp.what() << std::endl;
+            }
+
+            if (ret)
+            {
+                g_variant_unref(ret);
+            }
+            if (error)
+            {
+                g_error_free(error);
+            }
+            delete ctx;
+        }
     };
 };
 #endif // OPENVPN3_DBUS_PROXY_HPP
@@ -0,0 +1,206 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   proxycache.hpp
+ *
+ * @brief  Process wide cache of GDBusProxy objects
+ */
+
+#ifndef OPENVPN3_DBUS_PROXYCACHE_HPP
+#define OPENVPN3_DBUS_PROXYCACHE_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+namespace openvpn
+{
+    /**
+     *  Caches GDBusProxy objects, keyed by the D-Bus connection, bus name,
+     *  object path and interface.  Setting up a GDBusProxy for a well-known
+     *  bus name costs a round trip to the D-Bus daemon, which this cache
+     *  avoids when several DBusProxy objects talk to the same D-Bus object.
+     *
+     *  The cache only keeps weak references.  The GObject reference count
+     *  of each GDBusProxy is what decides its life time; once the last
+     *  user have released its reference the proxy is destroyed and the
+     *  cache entry is pruned on the next lookup.
+     *
+     *  The GDBusConnection objects from g_bus_get_sync() are already
+     *  shared per bus type within a process, so those are not cached here.
+     */
+    class DBusProxyCache
+    {
+    public:
+        /**
+         *  Retrieve the process wide proxy cache
+         */
+        static DBusProxyCache& Instance()
+        {
+            static DBusProxyCache cache;
+            return cache;
+        }
+
+
+        /**
+         *  Retrieve a GDBusProxy from the cache or create a new one if
+         *  no usable proxy exists.
+         *
+         * @param conn   D-Bus connection to use
+         * @param busn   D-Bus bus name of the service
+         * @param objp   D-Bus object path
+         * @param intf   D-Bus interface
+         * @param error  GError pointer set if creating a new proxy failed
+         *
+         * @return Returns a GDBusProxy pointer which the caller must release
+         *         with g_object_unref().  On errors, NULL is returned.
+         */
+        GDBusProxy * Acquire(GDBusConnection *conn,
+                             const std::string& busn,
+                             const std::string& objp,
+                             const std::string& intf,
+                             GError **error)
+        {
+            CacheKey key(conn, busn, objp, intf);
+            GDBusProxy *ret = lookup(key);
+            if (NULL != ret)
+            {
+                return ret;
+            }
+
+            // Create the proxy without holding the lock, this does
+            // a round trip to the D-Bus daemon.
+            ret = g_dbus_proxy_new_sync(conn,
+                                        G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                        NULL,             // GDBusInterfaceInfo
+                                        (!busn.empty() ? busn.c_str() : NULL), // aka. destination
+                                        objp.c_str(),
+                                        intf.c_str(),
+                                        NULL,             // GCancellable
+                                        error);
+            if (NULL == ret)
+            {
+                return NULL;
+            }
+
+            std::lock_guard<std::mutex> lg(guard);
+            auto it = entries.find(key);
+            if (entries.end() != it)
+            {
+                // Another thread created the same proxy in the mean time
+                GDBusProxy *other = (GDBusProxy *) g_weak_ref_get(&it->second->ref);
+                if (NULL != other)
+                {
+                    g_object_unref(ret);
+                    return other;
+                }
+                entries.erase(it);
+            }
+            entries.emplace(key, std::unique_ptr<CacheEntry>(new CacheEntry(ret)));
+
+            // Proxies to short lived objects are rarely looked up again,
+            // so regularly remove entries for proxies already destroyed.
+            if (0 == (++insert_count % sweep_interval))
+            {
+                sweep();
+            }
+            return ret;
+        }
+
+
+    private:
+        typedef std::tuple<GDBusConnection *, std::string, std::string, std::string> CacheKey;
+
+        struct CacheEntry
+        {
+            CacheEntry(GDBusProxy *prx)
+            {
+                g_weak_ref_init(&ref, prx);
+            }
+
+            ~CacheEntry()
+            {
+                g_weak_ref_clear(&ref);
+            }
+
+            GWeakRef ref;
+        };
+
+        const unsigned int sweep_interval = 64;
+        std::mutex guard;
+        std::map<CacheKey, std::unique_ptr<CacheEntry>> entries;
+        unsigned int insert_count = 0;
+
+
+        DBusProxyCache() = default;
+        DBusProxyCache(const DBusProxyCache&) = delete;
+        DBusProxyCache& operator=(const DBusProxyCache&) = delete;
+
+
+        /**
+         *  Looks up a live proxy in the cache.  Entries where the proxy
+         *  have been destroyed are removed.
+         */
+        GDBusProxy * lookup(const CacheKey& key)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+
+            auto it = entries.find(key);
+            if (entries.end() == it)
+            {
+                return NULL;
+            }
+
+            GDBusProxy *ret = (GDBusProxy *) g_weak_ref_get(&it->second->ref);
+            if (NULL == ret)
+            {
+                entries.erase(it);
+            }
+            return ret;
+        }
+
+
+        /**
+         *  Removes all entries where the proxy have been destroyed.  The
+         *  caller must hold the lock.
+         */
+        void sweep()
+        {
+            for (auto it = entries.begin(); it != entries.end(); )
+            {
+                GObject *obj = (GObject *) g_weak_ref_get(&it->second->ref);
+                if (NULL == obj)
+                {
+                    it = entries.erase(it);
+                }
+                else
+                {
+                    // Only drop the temporary reference from
+                    // g_weak_ref_get(), the proxy is still in use
+                    g_object_unref(obj);
+                    ++it;
+                }
+            }
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_PROXYCACHE_HPP
@@ -0,0 +1,429 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   signal-router.hpp
+ *
+ * @brief  Per-connection D-Bus signal demultiplexer, dispatching signals
+ *         to many receivers through a single signal subscription.
+ */
+
+#ifndef OPENVPN3_DBUS_SIGNAL_ROUTER_HPP
+#define OPENVPN3_DBUS_SIGNAL_ROUTER_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dbus/exceptions.hpp"
+
+namespace openvpn
+{
+    /**
+     *  Routes D-Bus signals to receivers based on the sender, the object
+     *  path or a token carried in the signal itself.
+     *
+     *  Each DBusSignalSubscription object holds its own signal subscription,
+     *  and GDBus needs to test every subscription for each signal arriving.
+     *  When many objects subscribes to the same broadcast signal, each signal
+     *  wakes up all the objects.  The router instead keeps a single
+     *  subscription per interface and signal name and looks up the
+     *  receivers in a hash table.
+     *
+     *  The sender used for routing is the unique bus name of the process
+     *  sending the signal, well-known bus names are not resolved.
+     *
+     *  Signals are dispatched in the main loop of the thread the router
+     *  subscription was set up in, as with g_dbus_connection_signal_subscribe().
+     */
+    class DBusSignalRouter
+    {
+    public:
+        /**
+         *  Called for each signal matching a route
+         */
+        typedef std::function<void(GDBusConnection *conn,
+                                   const std::string& sender,
+                                   const std::string& obj_path,
+                                   const std::string& intf_name,
+                                   const std::string& signal_name,
+                                   GVariant *params)> Handler;
+
+
+        /**
+         *  Retrieve the signal router for a D-Bus connection.  Only one
+         *  router exists per connection for the life time of the process.
+         *
+         * @param conn  D-Bus connection to route signals from
+         *
+         * @return Returns a reference to the DBusSignalRouter
+         */
+        static DBusSignalRouter& Get(GDBusConnection *conn)
+        {
+            static std::mutex routers_guard;
+            static std::map<GDBusConnection *,
+                            std::unique_ptr<DBusSignalRouter>> routers;
+
+            std::lock_guard<std::mutex> lg(routers_guard);
+            auto it = routers.find(conn);
+            if (routers.end() == it)
+            {
+                it = routers.emplace(conn, std::unique_ptr<DBusSignalRouter>(
+                                                new DBusSignalRouter(conn))).first;
+            }
+            return *(it->second);
+        }
+
+
+        GDBusConnection * GetConnection() const
+        {
+            return conn;
+        }
+
+
+        /**
+         *  Add a route for signals from a specific sender and/or object path
+         *
+         * @param intf_name    D-Bus interface of the signal
+         * @param signal_name  Name of the signal
+         * @param sender       Unique bus name of the sender.  If empty, any
+         *                     sender matches.
+         * @param obj_path     D-Bus object path of the signal.  If empty,
+         *                     any object path matches.
+         * @param handler      Handler to call for matching signals
+         *
+         * @return Returns a route ID to be used with Unsubscribe()
+         */
+        guint Subscribe(const std::string& intf_name,
+                        const std::string& signal_name,
+                        const std::string& sender,
+                        const std::string& obj_path,
+                        Handler handler)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            Slot& slot = get_slot(intf_name, signal_name);
+
+            std::shared_ptr<Route> route(new Route{++last_route_id,
+                                                   intf_name, signal_name,
+                                                   sender, obj_path, "",
+                                                   handler});
+            slot.by_origin[origin_key(sender, obj_path)].insert(route->id);
+            routes[route->id] = route;
+            return route->id;
+        }
+
+
+        /**
+         *  Add a route for signals carrying a specific token.  The token
+         *  is a string argument of the signal, which is used as the
+         *  routing key.
+         *
+         *  All token routes for the same signal must use the same token
+         *  argument index.
+         *
+         * @param intf_name    D-Bus interface of the signal
+         * @param signal_name  Name of the signal
+         * @param token_arg    Index of the string argument carrying the token
+         * @param token        Token value to match
+         * @param handler      Handler to call for matching signals
+         *
+         * @return Returns a route ID to be used with Unsubscribe()
+         */
+        guint SubscribeToken(const std::string& intf_name,
+                             const std::string& signal_name,
+                             unsigned int token_arg,
+                             const std::string& token,
+                             Handler handler)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            Slot& slot = get_slot(intf_name, signal_name);
+            if (slot.token_arg >= 0 && (unsigned int) slot.token_arg != token_arg)
+            {
+                THROW_DBUSEXCEPTION("DBusSignalRouter",
+                                    "Conflicting token argument index for the "
+                                    + signal_name + " signal");
+            }
+            slot.token_arg = token_arg;
+
+            std::shared_ptr<Route> route(new Route{++last_route_id,
+                                                   intf_name, signal_name,
+                                                   "", "", token,
+                                                   handler});
+            slot.by_token[token].insert(route->id);
+            routes[route->id] = route;
+            return route->id;
+        }
+
+
+        /**
+         *  Remove a route.  The D-Bus signal subscription is removed when
+         *  the last route for a signal is removed.  It is safe to call this
+         *  from within a handler, also for the route being dispatched.
+         *
+         * @param route_id  Route ID from Subscribe() or SubscribeToken().
+         *                  Unknown IDs are ignored.
+         */
+        void Unsubscribe(guint route_id)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            auto rit = routes.find(route_id);
+            if (routes.end() == rit)
+            {
+                return;
+            }
+            std::shared_ptr<Route> route = rit->second;
+            routes.erase(rit);
+
+            auto sit = slots.find(slot_key(route->intf_name, route->signal_name));
+            if (slots.end() == sit)
+            {
+                return;
+            }
+            Slot& slot = sit->second;
+            if (!route->token.empty())
+            {
+                remove_id(slot.by_token, route->token, route_id);
+            }
+            else
+            {
+                remove_id(slot.by_origin,
+                          origin_key(route->sender, route->obj_path),
+                          route_id);
+            }
+
+            if (slot.by_token.empty() && slot.by_origin.empty())
+            {
+                g_dbus_connection_signal_unsubscribe(conn, slot.subscription_id);
+                slots.erase(sit);
+            }
+        }
+
+
+    private:
+        struct Route
+        {
+            guint id;
+            std::string intf_name;
+            std::string signal_name;
+            std::string sender;
+            std::string obj_path;
+            std::string token;
+            Handler handler;
+        };
+
+        typedef std::unordered_map<std::string, std::set<guint>> RouteIndex;
+
+        struct Slot
+        {
+            guint subscription_id;
+            int token_arg;
+            RouteIndex by_token;
+            RouteIndex by_origin;
+        };
+
+        GDBusConnection *conn;
+        std::mutex guard;
+        guint last_route_id;
+        std::unordered_map<std::string, Slot> slots;
+        std::unordered_map<guint, std::shared_ptr<Route>> routes;
+
+
+        DBusSignalRouter(GDBusConnection *conn)
+            : conn(conn),
+              last_route_id(0)
+        {
+        }
+
+        DBusSignalRouter(const DBusSignalRouter&) = delete;
+        DBusSignalRouter& operator=(const DBusSignalRouter&) = delete;
+
+
+        static std::string slot_key(const std::string& intf_name,
+                                    const std::string& signal_name)
+        {
+            return intf_name + "." + signal_name;
+        }
+
+
+        static std::string origin_key(const std::string& sender,
+                                      const std::string& obj_path)
+        {
+            // A space is valid in neither bus names nor object paths
+            return sender + " " + obj_path;
+        }
+
+
+        static void remove_id(RouteIndex& index, const std::string& key,
+                              guint route_id)
+        {
+            auto it = index.find(key);
+            if (index.end() == it)
+            {
+                return;
+            }
+            it->second.erase(route_id);
+            if (it->second.empty())
+            {
+                index.erase(it);
+            }
+        }
+
+
+        /**
+         *  Retrieve the routing slot for a signal, subscribing to the
+         *  signal if this is the first route for it.  The caller must
+         *  hold the lock.
+         */
+        Slot& get_slot(const std::string& intf_name,
+                       const std::string& signal_name)
+        {
+            std::string key = slot_key(intf_name, signal_name);
+            auto it = slots.find(key);
+            if (slots.end() != it)
+            {
+                return it->second;
+            }
+
+            guint sub_id = g_dbus_connection_signal_subscribe(conn,
+                                                              NULL,
+                                                              intf_name.c_str(),
+                                                              signal_name.c_str(),
+                                                              NULL,
+                                                              NULL,
+                                                              G_DBUS_SIGNAL_FLAGS_NONE,
+                                                              dbus_signal_router_callback,
+                                                              this,
+                                                              NULL);
+            if (0 == sub_id)
+            {
+                THROW_DBUSEXCEPTION("DBusSignalRouter",
+                                    "Failed to subscribe to the "
+                                    + signal_name + " signal on "
+                                    + intf_name);
+            }
+            Slot& slot = slots[key];
+            slot.subscription_id = sub_id;
+            slot.token_arg = -1;
+            return slot;
+        }
+
+
+        /**
+         *  Collects all the routes matching a signal.  The caller must hold
+         *  the lock.
+         */
+        void find_routes(const Slot& slot,
+                         const std::string& sender,
+                         const std::string& obj_path,
+                         GVariant *params,
+                         std::vector<std::shared_ptr<Route>>& result)
+        {
+            auto collect = [this, &result](const RouteIndex& index,
+                                           const std::string& key)
+            {
+                auto it = index.find(key);
+                if (index.end() == it)
+                {
+                    return;
+                }
+                for (const auto& id : it->second)
+                {
+                    result.push_back(routes[id]);
+                }
+            };
+
+            if (slot.token_arg >= 0 && !slot.by_token.empty() && params
+                && g_variant_is_container(params)
+                && g_variant_n_children(params) > (gsize) slot.token_arg)
+            {
+                GVariant *tok = g_variant_get_child_value(params, slot.token_arg);
+                if (g_variant_is_of_type(tok, G_VARIANT_TYPE_STRING))
+                {
+                    collect(slot.by_token,
+                            std::string(g_variant_get_string(tok, NULL)));
+                }
+                g_variant_unref(tok);
+            }
+
+            collect(slot.by_origin, origin_key(sender, obj_path));
+            collect(slot.by_origin, origin_key(sender, ""));
+            collect(slot.by_origin, origin_key("", obj_path));
+            collect(slot.by_origin, origin_key("", ""));
+        }
+
+
+        void dispatch(GDBusConnection *sigconn,
+                      const std::string& sender,
+                      const std::string& obj_path,
+                      const std::string& intf_name,
+                      const std::string& signal_name,
+                      GVariant *params)
+        {
+            std::vector<std::shared_ptr<Route>> targets;
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                auto it = slots.find(slot_key(intf_name, signal_name));
+                if (slots.end() == it)
+                {
+                    return;
+                }
+                find_routes(it->second, sender, obj_path, params, targets);
+            }
+
+            for (auto& route : targets)
+            {
+                {
+                    // A previous handler may have removed this route,
+                    // including destroying the object behind it.
+                    std::lock_guard<std::mutex> lg(guard);
+                    if (routes.end() == routes.find(route->id))
+                    {
+                        continue;
+                    }
+                }
+                route->handler(sigconn, sender, obj_path,
+                               intf_name, signal_name, params);
+            }
+        }
+
+
+        static void dbus_signal_router_callback(GDBusConnection *conn,
+                                                const gchar *sender,
+                                                const gchar *obj_path,
+                                                const gchar *intf_name,
+                                                const gchar *sign_name,
+                                                GVariant *params,
+                                                gpointer this_ptr)
+        {
+            DBusSignalRouter *router = (DBusSignalRouter *) this_ptr;
+            router->dispatch(conn,
+                             std::string(sender ? sender : ""),
+                             std::string(obj_path),
+                             std::string(intf_name),
+                             std::string(sign_name),
+                             params);
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_SIGNAL_ROUTER_HPP
@@ -21,6 +21,11 @@
 #define OPENVPN3_DBUS_SIGNALS_HPP
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "dbus/signal-router.hpp"
 
 namespace openvpn
 {
@@ -218,8 +223,9 @@ namespace openvpn
                                                         gpointer this_ptr)
         {
             class DBusSignalSubscription *obj = (class DBusSignalSubscription *) this_ptr;
+            // Signals on peer-to-peer connections have no sender
             obj->callback_signal_handler(conn,
-                                         std::string(sender),
+                                         std::string(sender ? sender : ""),
                                          std::string(obj_path),
                                          std::string(intf_name),
                                          std::string(sign_name),
@@ -248,7 +254,8 @@ namespace openvpn
             conn(dbuscon.GetConnection()),
             bus_name(busname),
             interface(interf),
-            object_path(objpath)
+            object_path(objpath),
+            targets(new SignalTargets(conn))
         {
             validate_params();
         }
@@ -261,12 +268,66 @@ namespace openvpn
             conn(con),
             bus_name(busname),
             interface(interf),
-            object_path(objpath)
+            object_path(objpath),
+            targets(new SignalTargets(conn))
         {
             validate_params();
         }
 
 
+        /**
+         *  Enables or disables targeted signal delivery.  When enabled,
+         *  signals without an explicit destination are only sent to the
+         *  bus names registered via AddTargetBusName() instead of being
+         *  broadcast to everyone on the bus.  If no targets are registered,
+         *  such signals are not sent at all.
+         *
+         * @param enable  Bool flag enabling targeted delivery
+         */
+        void SetTargetedDelivery(bool enable)
+        {
+            std::lock_guard<std::mutex> lg(targets->guard);
+            targets->enabled = enable;
+        }
+
+
+        /**
+         *  Registers a bus name which should receive the signals when
+         *  targeted delivery is enabled.  The bus name is removed
+         *  automatically when it disappears from the bus.
+         *
+         * @param busname  Bus name of the signal receiver
+         */
+        void AddTargetBusName(const std::string& busname)
+        {
+            targets->Add(busname);
+        }
+
+
+        /**
+         *  Removes a bus name from the targeted delivery registry
+         *
+         * @param busname  Bus name of the signal receiver to remove
+         */
+        void RemoveTargetBusName(const std::string& busname)
+        {
+            targets->Remove(busname);
+        }
+
+
+        /**
+         *  Retrieve the number of registered signal targets
+         *
+         * @return Returns the number of bus names in the targeted
+         *         delivery registry
+         */
+        size_t GetTargetCount()
+        {
+            std::lock_guard<std::mutex> lg(targets->guard);
+            return targets->names.size();
+        }
+
+
         void Send(const std::string busn,
                   const std::string interf,
                   const std::string objpath,
@@ -280,6 +341,26 @@ namespace openvpn
                       << ", signal_name=" << signal_name
                       << std::endl;
             */
+            if (busn.empty())
+            {
+                std::vector<std::string> dests;
+                {
+                    std::lock_guard<std::mutex> lg(targets->guard);
+                    if (targets->enabled)
+                    {
+                        for (const auto& t : targets->names)
+                        {
+                            dests.push_back(t.first);
+                        }
+                    }
+                }
+                if (!dests.empty() || targets->enabled)
+                {
+                    send_targeted(dests, interf, objpath, signal_name, params);
+                    return;
+                }
+            }
+
             GError *error = NULL;
 
             if( !g_dbus_connection_emit_signal(conn,
@@ -341,6 +422,45 @@ namespace openvpn
         }
 
 
+        /**
+         *  Sends the org.freedesktop.DBus.Properties.PropertiesChanged
+         *  signal for properties changed by the object, so D-Bus clients
+         *  can keep a cached copy instead of polling.  Targeted delivery
+         *  applies as for any other signal.
+         *
+         * @param intf_name  D-Bus interface of the changed properties
+         * @param changed    GVariant a{sv} dictionary with the new property
+         *                   values.  A floating reference is consumed.
+         */
+        void SendPropertiesChanged(const std::string& intf_name,
+                                   GVariant *changed)
+        {
+            Send(bus_name, "org.freedesktop.DBus.Properties", object_path,
+                 "PropertiesChanged",
+                 g_variant_new("(s@a{sv}as)", intf_name.c_str(),
+                               changed, NULL));
+        }
+
+
+        /**
+         *  Sends the PropertiesChanged signal for a single property
+         *
+         * @param intf_name  D-Bus interface of the changed property
+         * @param property   Name of the changed property
+         * @param value      GVariant with the new value.  A floating
+         *                   reference is consumed.
+         */
+        void SendPropertyChanged(const std::string& intf_name,
+                                 const std::string& property,
+                                 GVariant *value)
+        {
+            GVariantBuilder changed;
+            g_variant_builder_init(&changed, G_VARIANT_TYPE("a{sv}"));
+            g_variant_builder_add(&changed, "{sv}", property.c_str(), value);
+            SendPropertiesChanged(intf_name, g_variant_builder_end(&changed));
+        }
+
+
     protected:
         void validate_params()
         {
@@ -355,11 +475,119 @@ namespace openvpn
 
 
     private:
+        /**
+         *  Registry of bus names receiving signals when targeted delivery
+         *  is enabled.  This is shared between copies of the same
+         *  DBusSignalProducer.
+         */
+        struct SignalTargets : public std::enable_shared_from_this<SignalTargets>
+        {
+            SignalTargets(GDBusConnection *conn)
+                : conn(conn),
+                  enabled(false)
+            {
+            }
+
+            ~SignalTargets()
+            {
+                for (const auto& t : names)
+                {
+                    DBusSignalRouter::Get(conn).Unsubscribe(t.second);
+                }
+            }
+
+            void Add(const std::string& busname)
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                if (names.end() != names.find(busname))
+                {
+                    return;
+                }
+
+                // Forget the receiver when it leaves the bus
+                std::weak_ptr<SignalTargets> self = shared_from_this();
+                names[busname] = DBusSignalRouter::Get(conn).SubscribeToken(
+                                         "org.freedesktop.DBus",
+                                         "NameOwnerChanged", 0, busname,
+                                         [self, busname](GDBusConnection *c,
+                                                         const std::string& sender,
+                                                         const std::string& obj_path,
+                                                         const std::string& intf_name,
+                                                         const std::string& signal_name,
+                                                         GVariant *params)
+                                         {
+                                             const gchar *new_owner = NULL;
+                                             g_variant_get(params, "(&s&s&s)",
+                                                           NULL, NULL, &new_owner);
+                                             std::shared_ptr<SignalTargets> t = self.lock();
+                                             if (t && '\0' == new_owner[0])
+                                             {
+                                                 t->Remove(busname);
+                                             }
+                                         });
+            }
+
+            void Remove(const std::string& busname)
+            {
+                std::lock_guard<std::mutex> lg(guard);
+                auto it = names.find(busname);
+                if (names.end() == it)
+                {
+                    return;
+                }
+                DBusSignalRouter::Get(conn).Unsubscribe(it->second);
+                names.erase(it);
+            }
+
+            GDBusConnection *conn;
+            std::mutex guard;
+            bool enabled;
+            std::map<std::string, guint> names;
+        };
+
         GDBusConnection *conn;
         std::string bus_name;
         std::string interface;
         std::string object_path;
         std::string signal_name;
+        std::shared_ptr<SignalTargets> targets;
+
+
+        void send_targeted(const std::vector<std::string>& dests,
+                           const std::string& interf,
+                           const std::string& objpath,
+                           const std::string& signal_name,
+                           GVariant *params)
+        {
+            // The same parameters are sent to several receivers, so
+            // take ownership of a possibly floating reference first
+            if (params)
+            {
+                g_variant_ref_sink(params);
+            }
+
+            GError *error = NULL;
+            for (const auto& dest : dests)
+            {
+                if (!g_dbus_connection_emit_signal(conn,
+                                                   dest.c_str(),
+                                                   string2C_char(objpath),
+                                                   string2C_char(interf),
+                                                   signal_name.c_str(),
+                                                   params,
+                                                   &error))
+                {
+                    // The receiver may have just disappeared, which
+                    // must not stop the delivery to the others
+                    g_clear_error(&error);
+                }
+            }
+
+            if (params)
+            {
+                g_variant_unref(params);
+            }
+        }
     };
 };
 #endif // OPENVPN3_DBUS_SIGNALS_HPP
@@ -0,0 +1,166 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   visibility-index.hpp
+ *
+ * @brief  Index of which D-Bus objects each user has access to, used
+ *         when listing the objects a D-Bus caller may see.
+ */
+
+#ifndef OPENVPN3_DBUS_VISIBILITY_INDEX_HPP
+#define OPENVPN3_DBUS_VISIBILITY_INDEX_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+namespace openvpn
+{
+    /**
+     *  Keeps track of which object paths each UID has access to, based on
+     *  the owner, the access control list and the public access attribute
+     *  of each object.  This lets a manager object list the objects a
+     *  caller may see without running an access check against every
+     *  object it manages.
+     *
+     *  The index is kept up-to-date by DBusCredentials objects attached
+     *  to it, whenever their ACL changes.  All methods may be called from
+     *  any thread.
+     */
+    class DBusVisibilityIndex
+    {
+    public:
+        typedef std::shared_ptr<DBusVisibilityIndex> Ptr;
+
+
+        /**
+         *  Adds or updates the access information of an object
+         *
+         * @param path           std::string with the D-Bus object path
+         * @param owner          uid_t of the object owner
+         * @param acl            std::vector<uid_t> of UIDs granted access
+         * @param public_access  Set to true if everyone has access
+         */
+        void Update(const std::string& path, uid_t owner,
+                    const std::vector<uid_t>& acl, bool public_access)
+        {
+            std::set<uid_t> uids(acl.begin(), acl.end());
+            uids.insert(owner);
+
+            std::lock_guard<std::mutex> lg(guard);
+            remove(path);
+            for (const auto& uid : uids)
+            {
+                by_uid[uid].insert(path);
+            }
+            if (public_access)
+            {
+                public_paths.insert(path);
+            }
+            objects[path] = std::move(uids);
+        }
+
+
+        /**
+         *  Removes an object from the index
+         *
+         * @param path  std::string with the D-Bus object path
+         */
+        void Remove(const std::string& path)
+        {
+            std::lock_guard<std::mutex> lg(guard);
+            remove(path);
+        }
+
+
+        /**
+         *  Retrieves all object paths a user has access to
+         *
+         * @param uid  uid_t of the user to look up
+         *
+         * @return Returns a sorted std::vector<std::string> of object paths
+         */
+        std::vector<std::string> Lookup(uid_t uid)
+        {
+            std::vector<std::string> ret;
+
+            std::lock_guard<std::mutex> lg(guard);
+            auto it = by_uid.find(uid);
+            if (by_uid.end() == it)
+            {
+                ret.assign(public_paths.begin(), public_paths.end());
+                return ret;
+            }
+            std::set_union(it->second.begin(), it->second.end(),
+                           public_paths.begin(), public_paths.end(),
+                           std::back_inserter(ret));
+            return ret;
+        }
+
+
+    private:
+        std::mutex guard;
+
+        /** UIDs with access to each object, including the owner */
+        std::unordered_map<std::string, std::set<uid_t>> objects;
+
+        /** Object paths each UID has access to */
+        std::map<uid_t, std::set<std::string>> by_uid;
+
+        /** Object paths with public access */
+        std::set<std::string> public_paths;
+
+
+        /**
+         *  Removes an object from the index.  The caller must hold the lock.
+         */
+        void remove(const std::string& path)
+        {
+            auto obj = objects.find(path);
+            if (objects.end() == obj)
+            {
+                return;
+            }
+            for (const auto& uid : obj->second)
+            {
+                auto it = by_uid.find(uid);
+                if (by_uid.end() == it)
+                {
+                    continue;
+                }
+                it->second.erase(path);
+                if (it->second.empty())
+                {
+                    by_uid.erase(it);
+                }
+            }
+            public_paths.erase(path);
+            objects.erase(obj);
+        }
+    };
+};
+#endif // OPENVPN3_DBUS_VISIBILITY_INDEX_HPP
@@ -234,7 +234,7 @@ namespace openvpn
         {
         }
 
-        const std::string GetLogIntrospection()
+        static const std::string GetLogIntrospection()
         {
             return
                 "        <signal name='Log'>"
@@ -244,7 +244,7 @@ namespace openvpn
                 "        </signal>";
         }
 
-        const std::string GetStatusChangeIntrospection()
+        static const std::string GetStatusChangeIntrospection()
         {
             return
                 "        <signal name='StatusChange'>"
@@ -270,7 +270,7 @@ namespace openvpn
             }
         }
 
-        void Log(const LogGroup group, const LogCategory catg, const std::string msg)
+        virtual void Log(const LogGroup group, const LogCategory catg, const std::string msg)
         {
             // Don't log unless the log level filtering allows it
             // The filtering is done against the LogCategory of the message
@@ -390,6 +390,54 @@ namespace openvpn
     };
 
 
+    /**
+     *  Registers this process as a log listener with the session manager,
+     *  via the AddLogListener method.  The session manager then also
+     *  sends the log events of the VPN client backends and the log events
+     *  it proxies to the front-ends to this process, which otherwise only
+     *  reach the session manager and the front-ends requesting them.
+     *
+     *  The registration is renewed each time the session manager appears
+     *  on the bus.  It is removed by the session manager when this process
+     *  disconnects from the bus.
+     */
+    class LogListenerRegistration
+    {
+    public:
+        LogListenerRegistration(GDBusConnection *dbuscon)
+            : watch_id(g_bus_watch_name_on_connection(dbuscon,
+                                                      OpenVPN3DBus_name_sessions.c_str(),
+                                                      G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                      sessionmgr_appeared,
+                                                      NULL, NULL, NULL))
+        {
+        }
+
+        ~LogListenerRegistration()
+        {
+            g_bus_unwatch_name(watch_id);
+        }
+
+    private:
+        guint watch_id;
+
+        static void sessionmgr_appeared(GDBusConnection *conn,
+                                        const gchar *name,
+                                        const gchar *owner,
+                                        gpointer data)
+        {
+            // The result is not needed; if the registration is refused,
+            // only the log events broadcast by the services are seen
+            g_dbus_connection_call(conn, owner,
+                                   OpenVPN3DBus_rootp_sessions.c_str(),
+                                   OpenVPN3DBus_interf_sessions.c_str(),
+                                   "AddLogListener", NULL, NULL,
+                                   G_DBUS_CALL_FLAGS_NONE, -1,
+                                   NULL, NULL, NULL);
+        }
+    };
+
+
     class LogConsumerProxy : public LogConsumer, public LogSender
     {
     public:
@@ -401,6 +449,19 @@ namespace openvpn
         {
         }
 
+        /**
+         *  Proxies log events between two different D-Bus connections,
+         *  such as from a private peer-to-peer connection to the bus.
+         */
+        LogConsumerProxy(GDBusConnection *src_conn,
+                         std::string src_interf, std::string src_objpath,
+                         GDBusConnection *dst_conn,
+                         std::string dst_interf, std::string dst_objpath)
+            : LogConsumer(src_conn, src_interf, src_objpath),
+              LogSender(dst_conn, LogGroup::UNDEFINED, dst_interf, dst_objpath)
+        {
+        }
+
         virtual void ConsumeLogEvent(const std::string sender,
                                      const std::string interface,
                                      const std::string object_path,
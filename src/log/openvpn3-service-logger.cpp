@@ -226,6 +226,7 @@ static int logger(ParsedArgs args)
     Logger * be_subscription = nullptr;
     Logger * session_subscr = nullptr;
     Logger * config_subscr = nullptr;
+    LogListenerRegistration * listener = nullptr;
     try
     {
         if (args.Present("vpn-backend"))
@@ -281,6 +282,14 @@ static int logger(ParsedArgs args)
                                    "No logging enabled. Aborting.");
         }
 
+        if (args.Present("vpn-backend")
+            || args.Present("session-manager-client-proxy"))
+        {
+            // The log events from the VPN client backends are otherwise
+            // only delivered to the session manager
+            listener = new LogListenerRegistration(dbus.GetConnection());
+        }
+
         ProcessSignalProducer procsig(dbus.GetConnection(), OpenVPN3DBus_interf_logger, "Logger");
 
         GMainLoop *main_loop = g_main_loop_new(NULL, FALSE);
@@ -311,6 +320,10 @@ static int logger(ParsedArgs args)
     {
         delete config_subscr;
     }
+    if (listener)
+    {
+        delete listener;
+    }
 
     return ret;
 }
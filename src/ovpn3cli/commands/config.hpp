@@ -192,22 +192,24 @@ static int cmd_configs_list(ParsedArgs args)
         }
         first = false;
 
-        std::string name = cprx.GetStringProperty("name");
-        std::string alias = cprx.GetStringProperty("alias");
-        std::string user = lookup_username(cprx.GetUIntProperty("owner"));
+        // Retrieve all the properties in a single D-Bus call
+        DBusPropertySnapshot props = cprx.GetAllProperties();
+        std::string name = props.GetString("name");
+        std::string alias = props.GetString("alias");
+        std::string user = lookup_username(props.GetUInt("owner"));
 
-        std::time_t imp_tstamp = cprx.GetUInt64Property("import_timestamp");
+        std::time_t imp_tstamp = props.GetUInt64("import_timestamp");
         std::string imported(std::asctime(std::localtime(&imp_tstamp)));
         imported.erase(imported.find_last_not_of(" \n")+1); // rtrim
 
-        std::time_t last_u_tstamp = cprx.GetUInt64Property("last_used_timestamp");
+        std::time_t last_u_tstamp = props.GetUInt64("last_used_timestamp");
         std::string last_used;
         if (last_u_tstamp > 0)
         {
             last_used = std::asctime(std::localtime(&last_u_tstamp));
             last_used.erase(last_used.find_last_not_of(" \n")+1);  // rtrim
         }
-        unsigned int used_count = cprx.GetUIntProperty("used_count");
+        unsigned int used_count = props.GetUInt("used_count");
 
         std::cout << cfg << std::endl;
         std::cout << imported << std::setw(32 - imported.size()) << std::setfill(' ') << " "
@@ -0,0 +1,261 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN, Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   debug.hpp
+ *
+ * @brief  Commands retrieving debug information from the OpenVPN 3
+ *         D-Bus services
+ */
+
+#include <iomanip>
+
+#include "dbus/core.hpp"
+
+using namespace openvpn;
+
+
+/**
+ *  Provides the service names accepted by the method-stats command.
+ *
+ *  The log service is not listed, as it does not handle any D-Bus
+ *  method calls.
+ */
+std::string arghelper_debug_services()
+{
+    return "sessions configuration backends client";
+}
+
+
+/**
+ *  Formats a latency value in microseconds in a readable unit
+ *
+ * @param usec  Latency in microseconds
+ *
+ * @return Returns a std::string with the formatted latency
+ */
+static std::string format_latency(guint64 usec)
+{
+    std::stringstream r;
+    if (usec < 1000)
+    {
+        r << usec << "us";
+    }
+    else if (usec < 1000000)
+    {
+        r << std::fixed << std::setprecision(1) << (usec / 1000.0) << "ms";
+    }
+    else
+    {
+        r << std::fixed << std::setprecision(1) << (usec / 1000000.0) << "s";
+    }
+    return r.str();
+}
+
+
+/**
+ *  Estimates a percentile from a latency histogram.  The upper limit of
+ *  the bucket containing the percentile is reported.
+ *
+ * @param limits     Upper limits of each histogram bucket, in microseconds
+ * @param histogram  Number of calls in each bucket
+ * @param calls      Total number of calls in the histogram
+ * @param pct        The percentile to estimate, between 0 and 100
+ *
+ * @return Returns a std::string with the formatted latency
+ */
+static std::string histogram_percentile(const std::vector<guint64>& limits,
+                                        const std::vector<guint64>& histogram,
+                                        guint64 calls, unsigned int pct)
+{
+    guint64 target = (calls * pct + 99) / 100;
+    guint64 seen = 0;
+    for (size_t i = 0; i < histogram.size() && i < limits.size(); i++)
+    {
+        seen += histogram[i];
+        if (seen >= target)
+        {
+            if (G_MAXUINT64 == limits[i])
+            {
+                return ">" + format_latency(limits[i-1]);
+            }
+            return "<" + format_latency(limits[i]);
+        }
+    }
+    return "-";
+}
+
+
+/**
+ *  Retrieves the D-Bus method call statistics from one of the
+ *  OpenVPN 3 D-Bus services
+ *
+ * @param args  ParsedArgs object containing all related options and arguments
+ * @return Returns the exit code which will be returned to the calling shell
+ */
+static int cmd_method_stats(ParsedArgs args)
+{
+    std::string service = "sessions";
+    if (args.Present("service"))
+    {
+        service = args.GetValue("service", 0);
+    }
+
+    std::string busname;
+    std::string objpath;
+    if ("sessions" == service)
+    {
+        busname = OpenVPN3DBus_name_sessions;
+        objpath = OpenVPN3DBus_rootp_sessions;
+    }
+    else if ("configuration" == service)
+    {
+        busname = OpenVPN3DBus_name_configuration;
+        objpath = OpenVPN3DBus_rootp_configuration;
+    }
+    else if ("backends" == service)
+    {
+        busname = OpenVPN3DBus_name_backends;
+        objpath = OpenVPN3DBus_rootp_backends;
+    }
+    else if ("client" == service)
+    {
+        // Each backend client process has its own bus name
+        if (!args.Present("pid"))
+        {
+            throw CommandException("method-stats",
+                                   "The client service requires --pid");
+        }
+        busname = OpenVPN3DBus_name_backends_be + args.GetValue("pid", 0);
+        objpath = OpenVPN3DBus_rootp_backends_manager;
+    }
+    else
+    {
+        throw CommandException("method-stats",
+                               "Unknown service: " + service);
+    }
+
+    try
+    {
+        DBusProxy prx(G_BUS_TYPE_SYSTEM, busname,
+                      DBusMethodStats_interf, objpath);
+        GVariant *res = prx.Call("GetMethodStats");
+
+        GVariantIter *limits_it = NULL;
+        GVariantIter *methods_it = NULL;
+        g_variant_get(res, "(ata(ssttttat))", &limits_it, &methods_it);
+
+        std::vector<guint64> limits;
+        guint64 l = 0;
+        while (g_variant_iter_next(limits_it, "t", &l))
+        {
+            limits.push_back(l);
+        }
+        g_variant_iter_free(limits_it);
+
+        std::cout << std::left
+                  << std::setw(52) << "Method"
+                  << std::right
+                  << std::setw(10) << "Calls"
+                  << std::setw(8) << "Errors"
+                  << std::setw(10) << "Avg"
+                  << std::setw(10) << "p50"
+                  << std::setw(10) << "p99"
+                  << std::setw(10) << "Max"
+                  << std::endl
+                  << std::setfill('-') << std::setw(110) << "-"
+                  << std::setfill(' ') << std::endl;
+
+        gchar *intf = NULL;
+        gchar *method = NULL;
+        guint64 calls = 0;
+        guint64 errors = 0;
+        guint64 total_usec = 0;
+        guint64 max_usec = 0;
+        GVariantIter *hist_it = NULL;
+        while (g_variant_iter_next(methods_it, "(ssttttat)",
+                                   &intf, &method, &calls, &errors,
+                                   &total_usec, &max_usec, &hist_it))
+        {
+            std::vector<guint64> histogram;
+            guint64 h = 0;
+            while (g_variant_iter_next(hist_it, "t", &h))
+            {
+                histogram.push_back(h);
+            }
+            g_variant_iter_free(hist_it);
+
+            // Calls not expecting a reply are counted without a latency
+            guint64 timed = 0;
+            for (auto& c : histogram)
+            {
+                timed += c;
+            }
+
+            std::cout << std::left
+                      << std::setw(52) << (std::string(intf) + "." + method)
+                      << std::right
+                      << std::setw(10) << calls
+                      << std::setw(8) << errors
+                      << std::setw(10) << (timed > 0 ? format_latency(total_usec / timed) : "-")
+                      << std::setw(10) << histogram_percentile(limits, histogram, timed, 50)
+                      << std::setw(10) << histogram_percentile(limits, histogram, timed, 99)
+                      << std::setw(10) << (timed > 0 ? format_latency(max_usec) : "-")
+                      << std::endl;
+            g_free(intf);
+            g_free(method);
+        }
+        g_variant_iter_free(methods_it);
+        g_variant_unref(res);
+    }
+    catch (DBusException& err)
+    {
+        throw CommandException("method-stats", err.getRawError());
+    }
+    return 0;
+}
+
+
+/**
+ *  Declare all the supported commands and their options and arguments.
+ *
+ *  This function should only be called once by the main openvpn3 program,
+ *  which sends a reference to the Commands argument parser which is used
+ *  for this registration process
+ *
+ * @param ovpn3  Commands object where to register all the commands, options
+ *               and arguments.
+ */
+void RegisterCommands_debug(Commands& ovpn3)
+{
+    //
+    //  method-stats command
+    //
+    auto cmd = ovpn3.AddCommand("method-stats",
+                                "Show D-Bus method call statistics of a service "
+                                "(root only)",
+                                cmd_method_stats);
+    cmd->AddOption("service", "SERVICE", true,
+                   "Service to query: sessions, configuration, backends "
+                   "or client (default: sessions)",
+                   arghelper_debug_services);
+    cmd->AddOption("pid", "PID", true,
+                   "Process ID of the backend client to query, "
+                   "used with --service client");
+}
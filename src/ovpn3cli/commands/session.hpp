@@ -188,10 +188,17 @@ static int cmd_session_start(ParsedArgs args)
 
         std::string sessionpath = sessmgr.NewTunnel(cfgpath);
 
-        sleep(1);  // Allow session to be established (FIXME: Signals?)
         std::cout << "Session path: " << sessionpath << std::endl;
         OpenVPN3SessionProxy session(G_BUS_TYPE_SYSTEM, sessionpath);
 
+        // The backend process is started in the background
+        if (!session.WaitForBackend(30))
+        {
+            std::cout << "Failed to start the VPN client backend process"
+                      << std::endl;
+            return 2;
+        }
+
         unsigned int loops = 10;
         while (loops > 0)
         {
@@ -331,20 +338,24 @@ static int cmd_session_list(ParsedArgs args)
         }
         first = false;
 
-        std::string owner = lookup_username(sprx.GetUIntProperty("owner"));
-        pid_t be_pid = sprx.GetUIntProperty("backend_pid");
+        // Retrieve all the properties in a single D-Bus call
+        DBusPropertySnapshot props = sprx.GetAllProperties();
+        std::string owner = lookup_username(props.GetUInt("owner"));
+        pid_t be_pid = props.GetUInt("backend_pid");
 
         std::string status_str;
         BackendStatus status;
         std::string cfgname = "";
         try
         {
-            status = sprx.GetLastStatus();
+            GVariant *status_v = props.Get("status");
+            status = BackendStatus(status_v);
+            g_variant_unref(status_v);
             status_str = "[" + std::to_string((unsigned int) status.major) + ","
                             + std::to_string((unsigned int) status.minor) + "] "
                             + status.major_str + ", " + status.minor_str;
 
-            std::string config_path = sprx.GetStringProperty("config_path");
+            std::string config_path = props.GetString("config_path");
             try
             {
                 OpenVPN3ConfigurationProxy cprx(G_BUS_TYPE_SYSTEM, config_path);
@@ -362,7 +373,7 @@ static int cmd_session_list(ParsedArgs args)
 
         std::cout << "        Path: " << sessp << std::endl;
 
-        std::time_t sess_created = sprx.GetUInt64Property("session_created");
+        std::time_t sess_created = props.GetUInt64("session_created");
         std::cout << "     Created: " << std::asctime(std::localtime(&sess_created));
 
         std::cout << "       Owner: " << owner << std::setw(43 - owner.size())
@@ -37,6 +37,7 @@
 #include "commands/config.hpp"
 #include "commands/session.hpp"
 #include "commands/log.hpp"
+#include "commands/debug.hpp"
 
 
 /**
@@ -67,6 +68,7 @@ int main(int argc, char **argv)
     RegisterCommands_config(openvpn3);
     RegisterCommands_session(openvpn3);
     RegisterCommands_log(openvpn3);
+    RegisterCommands_debug(openvpn3);
 
     try
     {
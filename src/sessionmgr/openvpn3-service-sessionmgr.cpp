@@ -47,13 +47,25 @@ static int session_manager(ParsedArgs args)
         log_level = std::atoi(args.GetValue("log-level", 0).c_str());
     }
     sessmgr.SetManagerLogLevel(log_level);
+    sessmgr.SetSubtreeRegistration(args.Present("subtree-registration"));
+
+    unsigned int pool_size = 0;
+    if (args.Present("backend-pool"))
+    {
+        pool_size = std::atoi(args.GetValue("backend-pool", 0).c_str());
+    }
+    unsigned int pool_min_memory = 256;
+    if (args.Present("backend-pool-min-memory"))
+    {
+        pool_min_memory = std::atoi(args.GetValue("backend-pool-min-memory", 0).c_str());
+    }
+    sessmgr.SetBackendPool(pool_size, pool_min_memory);
 
     IdleCheck::Ptr idle_exit;
     if (idle_wait_min > 0)
     {
         idle_exit.reset(new IdleCheck(main_loop,
                                       std::chrono::minutes(idle_wait_min)));
-        idle_exit->SetPollTime(std::chrono::seconds(30));
         sessmgr.EnableIdleCheck(idle_exit);
     }
     sessmgr.Setup();
@@ -68,7 +80,6 @@ static int session_manager(ParsedArgs args)
     if (idle_wait_min > 0)
     {
         idle_exit->Disable();
-        idle_exit->Join();
     }
 
     return 0;
@@ -84,6 +95,15 @@ int main(int argc, char **argv)
     argparser.AddOption("idle-exit", "MINUTES", true,
                         "How long to wait before exiting if being idle. "
                         "0 disables it (Default: 3 minutes)");
+    argparser.AddOption("subtree-registration",
+                        "Register session objects through a single D-Bus "
+                        "subtree instead of one registration per session");
+    argparser.AddOption("backend-pool", "COUNT", true,
+                        "Number of idle VPN client backend processes to keep "
+                        "started in advance (Default: 0)");
+    argparser.AddOption("backend-pool-min-memory", "MB", true,
+                        "Only start idle VPN client backend processes while "
+                        "this much memory is available (Default: 256 MB)");
 
     try
     {
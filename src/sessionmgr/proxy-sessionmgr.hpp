@@ -162,7 +162,8 @@ public:
                                  "UserInputQueueGetTypeGroup",
                                  "UserInputQueueFetch",
                                  "UserInputQueueCheck",
-                                 "UserInputProvide")
+                                 "UserInputProvide"),
+          session_path(objpath)
     {
     }
 
@@ -181,7 +182,8 @@ public:
                                  "UserInputQueueGetTypeGroup",
                                  "UserInputQueueFetch",
                                  "UserInputQueueCheck",
-                                 "UserInputProvide")
+                                 "UserInputProvide"),
+          session_path(objpath)
     {
     }
 
@@ -306,6 +308,73 @@ public:
     }
 
 
+    /**
+     *  Waits for the VPN backend process of a new session to register with
+     *  the session manager.  Until then, the session reports the
+     *  SESSION/PROC_STARTING status and rejects method calls.  The wait
+     *  completes on the SESSION/PROC_STARTED status change.
+     *
+     * @param timeout  Maximum number of seconds to wait
+     *
+     * @return Returns true when the backend is ready.  Returns false if
+     *         the backend process failed to start or did not register
+     *         within the timeout.
+     */
+    bool WaitForBackend(unsigned int timeout)
+    {
+        GMainContext *ctx = g_main_context_new();
+        g_main_context_push_thread_default(ctx);
+
+        // Subscribe before checking the current status, so the
+        // PROC_STARTED status change cannot be missed
+        BackendStartWait wait;
+        guint subscr = g_dbus_connection_signal_subscribe(GetConnection(),
+                                                          OpenVPN3DBus_name_sessions.c_str(),
+                                                          OpenVPN3DBus_interf_sessions.c_str(),
+                                                          "StatusChange",
+                                                          session_path.c_str(),
+                                                          NULL,
+                                                          G_DBUS_SIGNAL_FLAGS_NONE,
+                                                          backend_start_status,
+                                                          &wait,
+                                                          NULL);
+
+        GSource *timer = g_timeout_source_new_seconds(timeout);
+        g_source_set_callback(timer, backend_start_timeout, &wait, NULL);
+        g_source_attach(timer, ctx);
+
+        try
+        {
+            BackendStatus s = GetLastStatus();
+            if (StatusMajor::SESSION != s.major
+                || StatusMinor::PROC_STARTING != s.minor)
+            {
+                wait.done = true;
+                wait.started = true;
+            }
+        }
+        catch (DBusException&)
+        {
+            // The session is gone, or its backend has not reported
+            // any status yet; the following calls will tell which
+            wait.done = true;
+            wait.started = true;
+        }
+
+        while (!wait.done)
+        {
+            g_main_context_iteration(ctx, TRUE);
+        }
+
+        g_source_destroy(timer);
+        g_source_unref(timer);
+        g_dbus_connection_signal_unsubscribe(GetConnection(), subscr);
+        g_main_context_pop_thread_default(ctx);
+        g_main_context_unref(ctx);
+        return wait.started;
+    }
+
+
     /**
      *  Checks if the VPN backend process has all it needs to start connecting
      *  to a VPN server.  If it needs more information from the front-end, a
@@ -529,6 +598,60 @@ public:
 
 
 private:
+    /**
+     *  Progress of WaitForBackend()
+     */
+    struct BackendStartWait
+    {
+        bool done = false;
+        bool started = false;
+    };
+
+    std::string session_path;
+
+
+    static void backend_start_status(GDBusConnection *conn,
+                                     const gchar *sender,
+                                     const gchar *obj_path,
+                                     const gchar *intf_name,
+                                     const gchar *sign_name,
+                                     GVariant *params,
+                                     gpointer data)
+    {
+        BackendStartWait *wait = (BackendStartWait *) data;
+        guint32 maj = 0;
+        guint32 min = 0;
+        g_variant_get(params, "(uu&s)", &maj, &min, NULL);
+        if (StatusMajor::SESSION != (StatusMajor) maj)
+        {
+            return;
+        }
+        switch ((StatusMinor) min)
+        {
+        case StatusMinor::PROC_STARTED:
+            wait->done = true;
+            wait->started = true;
+            break;
+
+        case StatusMinor::PROC_STOPPED:
+        case StatusMinor::PROC_KILLED:
+            wait->done = true;
+            wait->started = false;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+
+    static gboolean backend_start_timeout(gpointer data)
+    {
+        ((BackendStartWait *) data)->done = true;
+        return G_SOURCE_REMOVE;
+    }
+
+
     /**
      * Simple wrapper for simple D-Bus method calls not requiring much
      * input.  Will also throw a DBusException in case of errors.
@@ -33,9 +33,19 @@
 #ifndef OPENVPN3_DBUS_SESSIONMGR_HPP
 #define OPENVPN3_DBUS_SESSIONMGR_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstring>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <ctime>
+#include <deque>
+#include <fstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <glib-unix.h>
 
 #include <openvpn/common/likely.hpp>
 #include <openvpn/log/logsimple.hpp>
@@ -45,11 +55,20 @@
 #include "common/utils.hpp"
 #include "dbus/core.hpp"
 #include "dbus/connection-creds.hpp"
+#include "dbus/objectmanager.hpp"
+#include "dbus/object-subtree.hpp"
+#include "dbus/p2p-server.hpp"
 #include "dbus/path.hpp"
+#include "dbus/signal-router.hpp"
 #include "log/dbus-log.hpp"
 #include "client/backendstatus.hpp"
 #include "ovpn3cli/lookup.hpp"
 
+// Older C libraries lacks the pidfd_open() system call number
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open 434
+#endif
+
 using namespace openvpn;
 
 /**
@@ -158,7 +177,9 @@ public:
      *   a front-end.  The interface name of proxied log entries will be
      *   the session managers interface.
      *
-     * @param conn               D-Bus connection to use
+     * @param conn               D-Bus connection to proxy the log events to
+     * @param be_conn            D-Bus connection to the backend.  This may
+     *                           be a private peer-to-peer connection.
      * @param bus_name           Backend D-Bus name which will this object
      *                           will subscribe to
      * @param interface          Backend D-Bus interface needed for the
@@ -168,13 +189,28 @@ public:
      * @param sigproxy_obj_path  Destinaion D-Bus path for the signal
      */
     SessionLogEvent(GDBusConnection *conn,
+                    GDBusConnection *be_conn,
                     std::string bus_name,
                     std::string interface,
                     std::string be_obj_path,
                     std::string sigproxy_obj_path)
-        : LogConsumerProxy(conn, interface, be_obj_path,
-                           OpenVPN3DBus_interf_sessions, sigproxy_obj_path)
+        : LogConsumerProxy(be_conn, interface, be_obj_path,
+                           conn, OpenVPN3DBus_interf_sessions, sigproxy_obj_path),
+          sigproxy_path(sigproxy_obj_path)
+    {
+    }
+
+
+    /**
+     *  Also sends the proxied log events to the log listeners registered
+     *  with the session manager
+     *
+     * @param listeners  DBusSignalProducer with the log listeners as its
+     *                   signal targets.  May be empty.
+     */
+    void SetLogListeners(std::shared_ptr<DBusSignalProducer> listeners)
     {
+        log_listeners = listeners;
     }
 
 
@@ -199,6 +235,15 @@ public:
         last_group = group;
         last_logcateg = catg;
         last_msg = msg;
+
+        // Only announce the log events which are also proxied, to
+        // the same receivers as the proxied Log signals
+        GVariant *entry = nullptr;
+        if (LogSender::LogFilterAllow(catg) && (entry = GetLastLogEntry()))
+        {
+            SendPropertyChanged(OpenVPN3DBus_interf_sessions, "last_log",
+                                entry);
+        }
     }
 
 
@@ -227,7 +272,28 @@ public:
         LogSender::SetLogLevel(loglev);
     }
 
+protected:
+    void process_log_event(const std::string sender,
+                           const std::string interface,
+                           const std::string object_path,
+                           GVariant *params)
+    {
+        LogConsumerProxy::process_log_event(sender, interface, object_path,
+                                            params);
+
+        guint catg = 0;
+        g_variant_get(params, "(uus)", NULL, &catg, NULL);
+        if (log_listeners && 0 < log_listeners->GetTargetCount()
+            && LogSender::LogFilterAllow(catg))
+        {
+            log_listeners->Send("", OpenVPN3DBus_interf_sessions,
+                                sigproxy_path, "Log", params);
+        }
+    }
+
 private:
+    std::string sigproxy_path;
+    std::shared_ptr<DBusSignalProducer> log_listeners;
     LogGroup last_group;
     LogCategory last_logcateg;
     std::string last_msg;
@@ -247,7 +313,9 @@ public:
     /**
      *  Constructor preparing the proxy of StatusChange events
      *
-     * @param conn               D-Bus connection to use
+     * @param conn               D-Bus connection to proxy the signals to
+     * @param be_conn            D-Bus connection to the backend.  This may
+     *                           be a private peer-to-peer connection.
      * @param bus_name           D-Bus bus name to use for the signal
      *                           subscription
      * @param interface          D-Bus interface to use for the signal
@@ -260,11 +328,12 @@ public:
      *                           StatusChange signal
      */
     SessionStatusChange(GDBusConnection *conn,
+                        GDBusConnection *be_conn,
                         std::string bus_name,
                         std::string interface,
                         std::string be_obj_path,
                         std::string sigproxy_obj_path)
-        : DBusSignalSubscription(conn, bus_name, interface, be_obj_path, "StatusChange"),
+        : DBusSignalSubscription(be_conn, bus_name, interface, be_obj_path, "StatusChange"),
           DBusSignalProducer(conn, "", OpenVPN3DBus_interf_sessions, sigproxy_obj_path),
           last_major(0),
           last_minor(0),
@@ -307,16 +376,24 @@ public:
 
         // If the last status received was CONNECTION:CONN_AUTH_FAILED,
         // preserve this status message
+        bool changed = false;
         if (!(StatusMajor::CONNECTION == (StatusMajor) last_major
             && StatusMinor::CONN_AUTH_FAILED == (StatusMinor) last_minor))
         {
+            changed = (last_major != maj || last_minor != min
+                       || last_msg != msg);
             last_major = maj;
             last_minor = min;
             last_msg = std::string(msg);
         }
+        g_free(msg);
 
         // Proxy this mesage via DBusSignalProducer
         Send("StatusChange", status);
+        if (changed)
+        {
+            send_status_property();
+        }
     }
 
 
@@ -326,9 +403,13 @@ public:
 
         // If the last status received was CONNECTION:CONN_AUTH_FAILED,
         // preserve this status message
+        bool changed = false;
         if (!(StatusMajor::CONNECTION == (StatusMajor) last_major
             && StatusMinor::CONN_AUTH_FAILED == (StatusMinor) last_minor))
         {
+            changed = (last_major != (guint32) be_status.major
+                       || last_minor != (guint32) be_status.minor
+                       || last_msg != be_status.message);
             last_major = (guint32) be_status.major;
             last_minor = (guint32) be_status.minor;
             last_msg = be_status.message;
@@ -340,6 +421,10 @@ public:
                                       (guint32) be_status.minor,
                                       be_status.message.c_str());
         Send("StatusChange", sig);
+        if (changed)
+        {
+            send_status_property();
+        }
     }
 
     /**
@@ -383,7 +468,7 @@ public:
         BackendStatus chk(status_chk);
         return (chk.major == (StatusMajor) last_major)
                && (chk.minor == (StatusMinor) last_minor)
-               && (last_msg.compare(chk.message));
+               && (0 == last_msg.compare(chk.message));
     }
 
 private:
@@ -391,562 +476,1995 @@ private:
     guint32 last_minor;
     std::string last_msg;
 
+
+    /**
+     *  Announces the new value of the session's status property
+     */
+    void send_status_property()
+    {
+        GVariant *st = GetLastStatusChange();
+        if (NULL != st)
+        {
+            SendPropertyChanged(OpenVPN3DBus_interf_sessions, "status", st);
+        }
+    }
 };
 
 
 /**
- *  A SessionObject contains information about a specific VPN client tunnel.
- *  Each time a new tunnel is created and initiated via D-Bus, the contents
- *  of that D-Bus object is contained within a SessionObject.  The session
- *  manager is be responsible for maintaining the life cycle of these objects.
+ *  Keeps a number of VPN client backend processes started and registered
+ *  in advance, so a new session can take over an idle backend instead of
+ *  waiting for a new backend process to start.
+ *
+ *  Idle backends are started through openvpn3-service-backendstart with
+ *  a token owned by the pool, just like a session starts its backend.
+ *  The RegistrationRequest of the backend is kept by the pool without
+ *  being confirmed.  Until the backend receives the RegistrationConfirmation,
+ *  it has not retrieved any configuration profile and is not tied to
+ *  any user or session.
+ *
+ *  The pool is refilled in the background whenever a backend has been
+ *  claimed or has disappeared, but only while the system has at least
+ *  the configured amount of memory available.  All methods must be
+ *  called from the main loop.
  */
-class SessionObject : public DBusObject,
-                      public DBusSignalSubscription,
-                      public DBusCredentials,
-                      public SessionManagerSignals
+class BackendPool : public SessionManagerSignals,
+                    public std::enable_shared_from_this<BackendPool>
 {
 public:
+    typedef std::shared_ptr<BackendPool> Ptr;
+
     /**
-     *  Constructor creating a new SessionObject
-     *
-     * @param dbuscon  D-Bus connection this object is tied to
-     * @param owner    An uid reference of the owner of this object.  This is
-     *                 typically the uid of the front-end user initating the
-     *                 creation of a new tunnel session.
-     * @param objpath  D-Bus object path of this object
-     * @param cfg_path D-Bus object path of the VPN profile configuration this
-     *                 session is tied to.
+     *  A registered backend waiting to be claimed by a session
      */
-    SessionObject(GDBusConnection *dbuscon,
-                  std::function<void()> remove_callback,
-                  uid_t owner,
-                  std::string objpath, std::string cfg_path,
-                  unsigned int manager_log_level)
-        : DBusObject(objpath),
-          DBusSignalSubscription(dbuscon, "", OpenVPN3DBus_interf_backends, ""),
-          DBusCredentials(dbuscon, owner),
-          SessionManagerSignals(dbuscon, objpath, manager_log_level),
-          remove_callback(remove_callback),
-          be_proxy(nullptr),
-          recv_log_events(false),
-          session_created(std::time(nullptr)),
-          config_path(cfg_path),
-          sig_statuschg(nullptr),
-          sig_logevent(nullptr),
-          backend_token(""),
-          backend_pid(0),
-          be_conn(nullptr),
-          registered(false),
-          selfdestruct_complete(false)
+    struct IdleBackend
     {
-        // Only for the initialization of this object, use the manager's
-        // log level.  Once the object is registered with a backend, it
-        // will switch to the default session log level.
-        SetLogLevel(manager_log_level);
-        Subscribe("RegistrationRequest");
-        RequiresQueue dummyqueue;  // Only used to get introspection data
-
-        // Register configuration the configuration object
-        std::stringstream introspection_xml;
-        introspection_xml << "<node name='" << objpath << "'>"
-                          << "    <interface name='" << OpenVPN3DBus_interf_sessions << "'>"
-                          << "        <method name='Connect'/>"
-                          << "        <method name='Pause'>"
-                          << "            <arg type='s' name='reason' direction='in'/>"
-                          << "        </method>"
-                          << "        <method name='Resume'/>"
-                          << "        <method name='Restart'/>"
-                          << "        <method name='Disconnect'/>"
-                          << "        <method name='Ready'/>"
-                          << "        <method name='AccessGrant'>"
-                          << "            <arg direction='in' type='u' name='uid'/>"
-                          << "        </method>"
-                          << "        <method name='AccessRevoke'>"
-                          << "            <arg direction='in' type='u' name='uid'/>"
-                          << "        </method>"
-                          << dummyqueue.IntrospectionMethods("UserInputQueueGetTypeGroup",
-                                                             "UserInputQueueFetch",
-                                                             "UserInputQueueCheck",
-                                                             "UserInputProvide")
-                          << "        <signal name='AttentionRequired'>"
-                          << "            <arg type='u' name='type' direction='out'/>"
-                          << "            <arg type='u' name='group' direction='out'/>"
-                          << "            <arg type='s' name='message' direction='out'/>"
-                          << "        </signal>"
-                          << GetStatusChangeIntrospection()
-                          << GetLogIntrospection()
-                          << "        <property type='u' name='owner' access='read'/>"
-                          << "        <property type='t' name='session_created' access='read'/>"
-                          << "        <property type='au' name='acl' access='read'/>"
-                          << "        <property type='b' name='public_access' access='readwrite'/>"
-                          << "        <property type='a{sv}' name='status' access='read'/>"
-                          << "        <property type='a{sv}' name='last_log' access='read'/>"
-                          << "        <property type='a{sx}' name='statistics' access='read'/>"
-                          << "        <property type='o' name='config_path' access='read'/>"
-                          << "        <property type='u' name='backend_pid' access='read'/>"
-                          << "        <property type='b' name='receive_log_events' access='readwrite'/>"
-                          << "        <property type='u' name='log_verbosity' access='readwrite'/>"
-                          << "    </interface>"
-                          << "</node>";
-        ParseIntrospectionXML(introspection_xml);
-
-        // Start a new backend process via the openvpn3-service-backendstart
-        // (net.openvpn.v3.backends) service.  A random backend token is
-        // created and sent to the backend process.  When the backend process
-        // have initialized, it reports back to the session manager using
-        // this token as a reference.  This is used to tie the backend process
-        // to this specific SessionObject.
-        backend_token = generate_path_uuid("", 't');
-
-        auto backend_start = new DBusProxy(G_BUS_TYPE_SYSTEM,
-                                           OpenVPN3DBus_name_backends,
-                                           OpenVPN3DBus_interf_backends,
-                                           OpenVPN3DBus_rootp_backends);
-        GVariant *res_g = backend_start->Call("StartClient",
-                                              g_variant_new("(s)", backend_token.c_str()));
-        if (NULL == res_g) {
-                THROW_DBUSEXCEPTION("SessionObject",
-                                    "Failed to extract the result of the "
-                                    "StartClient request");
-        }
-        g_variant_get(res_g, "(u)", &backend_pid);
+        std::string token;        /**< Token the backend was started with */
+        GDBusConnection *conn;    /**< Connection the backend registered on */
+        std::string sender;       /**< Unique bus name, empty on a private connection */
+        std::string object_path;  /**< D-Bus object path of the backend */
+        GVariant *params;         /**< RegistrationRequest signal arguments */
+        bool p2p;                 /**< Registered over a private connection */
+        gulong watch;             /**< Bus name watch or "closed" signal handler */
+        std::time_t registered;   /**< When the backend registered */
+    };
 
-        // The PID value we get here is just a temporary.  This is the
-        // PID returned by openvpn3-service-backendstart.  This will again
-        // start the openvpn3-service-client process, which will fork() once
-        // to be completely independent.  When this last fork() happens,
-        // the backend will report back its final PID.
-        StatusChange(StatusMajor::SESSION, StatusMinor::PROC_STARTED,
-                             "session_path=" + GetObjectPath()
-                             + ", backend_pid=" + std::to_string(backend_pid));
-        Debug("SessionObject registered on '" + OpenVPN3DBus_interf_sessions + "': "
-              + objpath + " [backend_token=" + backend_token + "]");
 
-        std::stringstream msg;
-        msg << "Session starting, configuration path: " << cfg_path
-            << ", owner: " << lookup_username(owner);
-        LogVerb1(msg.str());
+    /**
+     * @param conn        D-Bus connection to the bus
+     * @param objpath     D-Bus object path log events are sent from
+     * @param log_level   Log level of the pool
+     * @param p2p_server  DBusP2PServer backends may register through.
+     *                    May be empty.
+     * @param size        Number of idle backends to keep
+     * @param min_memory  Megabytes of memory which must be available
+     *                    on the system to start another idle backend
+     */
+    BackendPool(GDBusConnection *conn, const std::string& objpath,
+                unsigned int log_level,
+                std::shared_ptr<DBusP2PServer> p2p_server,
+                unsigned int size, unsigned int min_memory)
+        : SessionManagerSignals(conn, objpath, log_level),
+          dbuscon(conn),
+          sigrouter(DBusSignalRouter::Get(conn)),
+          p2p_server(p2p_server),
+          pool_size(size),
+          min_memory((guint64) min_memory * 1024 * 1024),
+          refill_source(0),
+          refill_due(0),
+          early_deaths(0)
+    {
     }
 
-    ~SessionObject()
+
+    ~BackendPool()
     {
-        if (sig_statuschg)
+        if (0 != refill_source)
         {
-            delete sig_statuschg;
+            g_source_remove(refill_source);
         }
-
-        if (sig_logevent)
+        for (auto& s : starting)
         {
-            delete sig_logevent;
+            forget_token(s.first, s.second.route);
         }
-
-        if (be_proxy)
+        for (auto& be : idle)
         {
-            delete be_proxy;
+            unwatch(be);
+            try
+            {
+                // Not waiting for the backends to respond; a message
+                // sent over a private connection is still written
+                // before release() closes the connection
+                DBusProxy prx(be.conn, (be.p2p ? "" : be.sender),
+                              OpenVPN3DBus_interf_backends, be.object_path);
+                prx.CallAsync("ForceShutdown", NULL, nullptr);
+            }
+            catch (DBusException& excp)
+            {
+                // The backend is already gone
+            }
+            release(be);
         }
-        LogVerb1("Session is closing");
-        StatusChange(StatusMajor::SESSION, StatusMinor::SESS_REMOVED);
-        remove_callback();
-        IdleCheck_RefDec();
     }
 
 
     /**
-     *  Callback method called each time signals we have subscribed to
-     *  occurs.  For the SessionObject, we care about these signals:
+     *  Starts filling the pool
+     */
+    void Start()
+    {
+        LogVerb1("Keeping " + std::to_string(pool_size)
+                 + " idle VPN client backend processes");
+        schedule_refill(0);
+    }
+
+
+    /**
+     *  Takes an idle backend out of the pool.  The caller takes over the
+     *  reference to the RegistrationRequest arguments and, for a backend
+     *  on a private connection, the reference to the connection.
      *
-     *    - RegistrationRequest:  which the VPN client backend process
-     *                            sends once it has completed the
-     *                            initialization.
-     *    - StatusChange:         whenever the status changes in the backend
-     *    - AttentionRequired:    whenever the backend process needs
-     *                            information from the front-end user.
+     * @param backend  IdleBackend where the claimed backend is stored
      *
-     * @param conn             D-Bus connection where the signal came from
-     * @param sender_name      D-Bus bus name of the sender of the singal
-     * @param object_path      D-Bus object path of the signal
-     * @param interface_name   D-Bus interface of the signal
-     * @param signal_name      The name of the signal itself
-     * @param params           GVariant Glib2 object containing all the
-     *                         variables the signal carries
+     * @return Returns true if an idle backend was available
      */
-    void callback_signal_handler(GDBusConnection *conn,
-                                 const std::string sender_name,
-                                 const std::string object_path,
-                                 const std::string interface_name,
-                                 const std::string signal_name,
-                                 GVariant *params)
+    bool Claim(IdleBackend& backend)
     {
-        if ((signal_name == "RegistrationRequest")
-            && (interface_name == OpenVPN3DBus_interf_backends))
+        if (idle.empty())
         {
-            gchar *busn;
-            gchar *sesstoken;
-            g_variant_get (params, "(ss)", &busn, &sesstoken);
+            schedule_refill(0);
+            return false;
+        }
+        backend = idle.front();
+        idle.pop_front();
+        unwatch(backend);
+        schedule_refill(0);
+        return true;
+    }
 
-            be_conn = conn;
-            be_busname = std::string(busn);
-            be_path = std::string(object_path);
-            g_free(busn);
 
-            if (std::string(sesstoken) != backend_token)
-            {
-                // This registration request was not for us.
-                // The RegistrationRequest signals is broadcasted which means
-                // any SessionObject still subscribed to this signal will
-                // see this request.
-                //
-                // This can happen if several tunnels are started in parallel
-                // and they issue this signal at approximately the same time
-                // and before the owning SessionObject() have managed to
-                // unsubscribe from the signal
+private:
+    /** Seconds a started backend may take to register */
+    const unsigned int registration_timeout = 30;
 
-                // Debug("Ignoring RegistrationRequest (token mismatch)  - name=" + be_busname + ", path=" + be_path);
-                return;
-            }
+    /** Seconds to wait before retrying after a backend failed to start */
+    const unsigned int start_retry_delay = 30;
 
-            try
-            {
-                Subscribe(sender_name, be_path, "AttentionRequired");
-                Subscribe(sender_name, be_path, "StatusChange");
-                register_backend();
-                Unsubscribe("RegistrationRequest");
-                SetLogLevel(default_session_log_level);
-                LogVerb2("Backend VPN client process registered");
-            }
-            catch (DBusException& err)
+    /** Seconds an idle backend must run to not count as an early death */
+    const unsigned int early_death_period = 60;
+
+    /** Limits the backoff after early deaths to start_retry_delay * 2^n */
+    const unsigned int max_backoff_shift = 4;
+
+    /**
+     *  A backend which has been started but has not registered yet
+     */
+    struct Starting
+    {
+        guint route;
+        std::time_t started;
+    };
+
+    GDBusConnection *dbuscon;
+    DBusSignalRouter& sigrouter;
+    std::shared_ptr<DBusP2PServer> p2p_server;
+    unsigned int pool_size;
+    guint64 min_memory;
+    std::map<std::string, Starting> starting;
+    std::deque<IdleBackend> idle;
+    guint refill_source;
+    std::time_t refill_due;
+    unsigned int early_deaths;
+
+
+    /**
+     *  Schedules starting more backends from the main loop.  A refill
+     *  already scheduled is kept, unless this one is due earlier.
+     *
+     * @param delay  Seconds to wait before refilling
+     */
+    void schedule_refill(unsigned int delay)
+    {
+        std::time_t due = std::time(nullptr) + delay;
+        if (0 != refill_source)
+        {
+            if (due >= refill_due)
             {
-                LogError("Could not register backend process, removing session object");
-                Debug(be_busname, be_path, backend_pid, std::string(err.what()));
-                StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Backend process died");
-                selfdestruct(conn);
+                return;
             }
+            g_source_remove(refill_source);
+            refill_source = 0;
         }
-        else if ((signal_name == "StatusChange")
-                 && (interface_name == OpenVPN3DBus_interf_backends))
+        refill_due = due;
+        std::weak_ptr<BackendPool> *self = new std::weak_ptr<BackendPool>(shared_from_this());
+        if (0 == delay)
         {
-            guint32 major_u;
-            guint32 minor_u;
-            gchar *msg;
-            g_variant_get (params, "(uus)", &major_u, &minor_u, &msg);
-
-            StatusMajor major = (StatusMajor) major_u;
-            StatusMinor minor = (StatusMinor) minor_u;
-            if (StatusMajor::CONNECTION == major
-                && (StatusMinor::CONN_FAILED == minor
-                    || StatusMinor::CONN_AUTH_FAILED == minor))
-            {
-                // When the backend client signals connection failure
-                // force it to shutdown and close this session object
-                //
-                // FIXME: Consider if we need to split CONN_FAILED into
-                //        a fatal error (as now) and "Connection failed, but session may resume"
-                //        This link is between here and client/core-client.hpp:173
-                //
-                shutdown(true, (StatusMinor::CONN_FAILED == minor));
-            }
+            refill_source = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                                            refill_cb, self, weak_free);
         }
-        else if ((signal_name =="AttentionRequired")
-                 && (interface_name == OpenVPN3DBus_interf_backends))
+        else
         {
-                // Proxy this signal directly to the front-end processes
-                // listening
-                Send("AttentionRequired", params);
+            refill_source = g_timeout_add_seconds_full(G_PRIORITY_DEFAULT,
+                                                       delay, refill_cb,
+                                                       self, weak_free);
         }
     }
 
+
     /**
-     *  Callback method which is called each time a D-Bus method call occurs
-     *  on this SessionObject.
-     *
-     *  In most cases the method call is just proxied to the client backend
-     *  process after an access control check has been performed.  Many of the
-     *  calls can be accessed by the owner or designated user IDs, and the
-     *  most sensitive methods are only accessible to the owner of this
-     *  session.
-     *
-     * @param conn       D-Bus connection where the method call occurred
-     * @param sender     D-Bus bus name of the sender of the method call
-     * @param obj_path   D-Bus object path of the target object.
-     * @param intf_name  D-Bus interface of the method call
-     * @param method_name D-Bus method name to be executed
-     * @param params     GVariant Glib2 object containing the arguments for
-     *                   the method call
-     * @param invoc      GDBusMethodInvocation where the response/result of
-     *                   the method call will be returned.
+     *  Starts backends until the pool is full.  Backends which have not
+     *  registered in time are given up on.
      */
-    void callback_method_call(GDBusConnection *conn,
-                              const std::string sender,
-                              const std::string obj_path,
-                              const std::string intf_name,
-                              const std::string method_name,
-                              GVariant *params,
-                              GDBusMethodInvocation *invoc)
+    void refill()
     {
-        bool ping = false;
-        bool disable_critical_log = false;
-
-        try {
-            if (!be_proxy)
+        std::time_t now = std::time(nullptr);
+        for (auto it = starting.begin(); it != starting.end();)
+        {
+            if (now - it->second.started >= (std::time_t) registration_timeout)
             {
-                THROW_DBUSEXCEPTION("SessionObject", "No backend proxy connection available. Backend died?");
+                LogWarn("Idle VPN client backend did not register in time");
+                forget_token(it->first, it->second.route);
+                it = starting.erase(it);
             }
-            try {
-                ping = ping_backend();
-                if (unlikely(!ping))
-                {
-                    THROW_DBUSEXCEPTION("SessionObject",
-                                        "The response from the backend Ping request was surprising");
-                }
-            }
-            catch (DBusException &dbserr)
+            else
             {
-                ping = false;
-                THROW_DBUSEXCEPTION("SessionObject",
-                                    "Backend did not respond: "
-                                    + std::string(dbserr.getRawError()));
+                ++it;
             }
+        }
 
-
-            std::stringstream msg;
-            msg << "Session operation: " << method_name
-                << ", requester:  " << lookup_username(GetUID(sender));
-            Debug(msg.str());
-
-            if ("Connect" == method_name)
-            {
-                CheckACL(sender);
-                be_proxy->Call("Connect");
-                LogVerb2("Starting connection");
-            }
-            else if ("Restart" == method_name)
+        while (starting.size() + idle.size() < pool_size)
+        {
+            if (available_memory() < min_memory)
             {
-                CheckACL(sender, true);
-                be_proxy->Call("Restart");
-                LogVerb2("Restarting connection");
+                Debug("Not enough memory available to start "
+                      "idle VPN client backends");
+                schedule_refill(start_retry_delay);
+                return;
             }
-            else if ("Pause" == method_name)
+            if (!start_backend())
             {
-                CheckACL(sender, true);
-                // FIXME: Should check that params contains only the expected formatting
-                be_proxy->Call("Pause", params);
-                LogVerb2("Pausing connection");
+                schedule_refill(start_retry_delay);
+                return;
             }
-            else if ("Resume"  == method_name)
-            {
-                CheckACL(sender, true);
-                be_proxy->Call("Resume");
-                LogVerb2("Resuming connection");
-            }
-            else if ("Disconnect" == method_name)
-            {
-                CheckACL(sender, true);
-                LogVerb2("Disconnecting connection");
-                shutdown(false, true);
-            }
-            else if ("Ready" == method_name)
-            {
-                // We disable logging critical exceptions in this case because
-                // the Ready method is expected to throw an exception with a
-                // reason if the backend isn't ready.  This is not a session
-                // critical scenario.
-                disable_critical_log = true;
-                CheckACL(sender);
-                be_proxy->Call("Ready");
-            }
-            else if ("UserInputQueueGetTypeGroup" == method_name)
+        }
+
+        // Check again later for backends not registering
+        if (!starting.empty())
+        {
+            schedule_refill(registration_timeout);
+        }
+    }
+
+
+    /**
+     *  Starts a new idle backend through openvpn3-service-backendstart
+     *
+     * @return Returns false if the backend could not be started
+     */
+    bool start_backend()
+    {
+        std::string token = generate_path_uuid("", 't');
+        guint route = sigrouter.SubscribeToken(OpenVPN3DBus_interf_backends,
+                                               "RegistrationRequest", 1,
+                                               token,
+                                               [this, token](GDBusConnection *conn,
+                                                             const std::string& sender,
+                                                             const std::string& obj_path,
+                                                             const std::string& intf_name,
+                                                             const std::string& signal_name,
+                                                             GVariant *params)
+                                               {
+                                                   backend_registered(token, conn, sender,
+                                                                      obj_path, params, false);
+                                               });
+        if (p2p_server)
+        {
+            p2p_server->AddToken(token,
+                                 [this, token](GDBusConnection *p2pconn,
+                                               const std::string& obj_path,
+                                               GVariant *params)
+                                 {
+                                     backend_registered(token, p2pconn, "",
+                                                        obj_path, params, true);
+                                 });
+        }
+        starting[token] = Starting{route, std::time(nullptr)};
+
+        std::weak_ptr<BackendPool> self(shared_from_this());
+        try
+        {
+            DBusProxy backend_start(G_BUS_TYPE_SYSTEM,
+                                    OpenVPN3DBus_name_backends,
+                                    OpenVPN3DBus_interf_backends,
+                                    OpenVPN3DBus_rootp_backends);
+            backend_start.CallAsync("StartClient",
+                                    g_variant_new("(s)", token.c_str()),
+                                    [self, token](GVariant *response, GError *error)
+                                    {
+                                        Ptr pool = self.lock();
+                                        if (pool && NULL != error)
+                                        {
+                                            pool->backend_start_failed(token, error->message);
+                                        }
+                                    });
+        }
+        catch (DBusException& excp)
+        {
+            LogWarn("Failed to start an idle VPN client backend: "
+                    + excp.getRawError());
+            forget_token(token, route);
+            starting.erase(token);
+            return false;
+        }
+        return true;
+    }
+
+
+    /**
+     *  Drops a backend whose StartClient call failed
+     *
+     * @param token   Token the backend was started with
+     * @param errmsg  std::string with the reason for the failure
+     */
+    void backend_start_failed(const std::string& token, const std::string& errmsg)
+    {
+        auto it = starting.find(token);
+        if (starting.end() == it)
+        {
+            return;
+        }
+        LogWarn("Failed to start an idle VPN client backend: " + errmsg);
+        forget_token(token, it->second.route);
+        starting.erase(it);
+        schedule_refill(start_retry_delay);
+    }
+
+
+    /**
+     *  Parks a backend which has sent its RegistrationRequest, until a
+     *  session claims it.  On a private connection, the pool takes over
+     *  the reference to the connection.
+     */
+    void backend_registered(const std::string& token,
+                            GDBusConnection *conn,
+                            const std::string& sender,
+                            const std::string& obj_path,
+                            GVariant *params,
+                            bool p2p)
+    {
+        auto it = starting.find(token);
+        if (starting.end() == it)
+        {
+            if (p2p)
             {
-                CheckACL(sender);
-                try
-                {
-                    GVariant *res = be_proxy->Call("UserInputQueueGetTypeGroup", params);
-                    g_dbus_method_invocation_return_value(invoc, res);
-                    g_variant_unref(res);
-                }
-                catch (RequiresQueueException& excp)
-                {
-                    excp.GenerateDBusError(invoc);
-                }
-                return;
+                g_dbus_connection_close(conn, NULL, NULL, NULL);
+                g_object_unref(conn);
             }
-            else if ("UserInputQueueFetch" == method_name)
+            return;
+        }
+        forget_token(token, it->second.route);
+        starting.erase(it);
+
+        IdleBackend be{token, conn, sender, obj_path,
+                       g_variant_ref(params), p2p, 0, std::time(nullptr)};
+        if (p2p)
+        {
+            be.watch = g_signal_connect_data(conn, "closed",
+                                             G_CALLBACK(p2p_closed_cb),
+                                             new std::weak_ptr<BackendPool>(shared_from_this()),
+                                             (GClosureNotify) weak_free_closure,
+                                             (GConnectFlags) 0);
+        }
+        else
+        {
+            be.watch = g_bus_watch_name_on_connection(dbuscon, sender.c_str(),
+                                                      G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                      NULL,
+                                                      name_vanished_cb,
+                                                      new std::weak_ptr<BackendPool>(shared_from_this()),
+                                                      weak_free);
+        }
+        idle.push_back(be);
+        Debug("Idle VPN client backend registered: " + obj_path
+              + (p2p ? " (private connection)" : " (" + sender + ")"));
+    }
+
+
+    /**
+     *  Removes an idle backend which has disappeared before being claimed.
+     *  Backends which keep disappearing shortly after registering are
+     *  replaced with an exponentially increasing delay, so a failing
+     *  backend is not restarted in a tight loop.
+     *
+     * @param match  Function returning true for the backend to remove
+     */
+    void backend_gone(std::function<bool(const IdleBackend&)> match)
+    {
+        for (auto it = idle.begin(); it != idle.end(); ++it)
+        {
+            if (match(*it))
             {
-                CheckACL(sender);
-                try
+                IdleBackend be = *it;
+                idle.erase(it);
+                unwatch(be);
+                release(be);
+
+                if (std::time(nullptr) - be.registered
+                    < (std::time_t) early_death_period)
                 {
-                    GVariant *res = be_proxy->Call("UserInputQueueFetch", params);
-                    g_dbus_method_invocation_return_value(invoc, res);
-                    g_variant_unref(res);
+                    unsigned int shift = std::min(early_deaths,
+                                                  max_backoff_shift);
+                    ++early_deaths;
+                    unsigned int delay = start_retry_delay << shift;
+                    LogWarn("Idle VPN client backend disappeared shortly "
+                            "after starting, replacing it in "
+                            + std::to_string(delay) + " seconds");
+                    schedule_refill(delay);
                 }
-                catch (RequiresQueueException& excp)
+                else
                 {
-                    excp.GenerateDBusError(invoc);
+                    early_deaths = 0;
+                    LogVerb2("Idle VPN client backend disappeared");
+                    schedule_refill(0);
                 }
                 return;
             }
-            else if ("UserInputQueueCheck" == method_name)
+        }
+    }
+
+
+    /**
+     *  Removes the registration routes of a token
+     */
+    void forget_token(const std::string& token, guint route)
+    {
+        sigrouter.Unsubscribe(route);
+        if (p2p_server)
+        {
+            p2p_server->RemoveToken(token);
+        }
+    }
+
+
+    /**
+     *  Stops watching an idle backend for disappearing
+     */
+    void unwatch(IdleBackend& be)
+    {
+        if (0 == be.watch)
+        {
+            return;
+        }
+        if (be.p2p)
+        {
+            g_signal_handler_disconnect(be.conn, be.watch);
+        }
+        else
+        {
+            g_bus_unwatch_name(be.watch);
+        }
+        be.watch = 0;
+    }
+
+
+    /**
+     *  Releases the references held for an idle backend
+     */
+    static void release(IdleBackend& be)
+    {
+        g_variant_unref(be.params);
+        if (be.p2p)
+        {
+            g_dbus_connection_close(be.conn, NULL, NULL, NULL);
+            g_object_unref(be.conn);
+        }
+    }
+
+
+    /**
+     *  Retrieves the memory available for starting new processes
+     *
+     * @return Returns the available memory in bytes.  If unknown, the
+     *         maximum value is returned.
+     */
+    static guint64 available_memory()
+    {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string key;
+        guint64 value = 0;
+        std::string unit;
+        while (meminfo >> key >> value >> unit)
+        {
+            if ("MemAvailable:" == key)
             {
-                CheckACL(sender);
-                GVariant *res = be_proxy->Call("UserInputQueueCheck", params);
-                g_dbus_method_invocation_return_value(invoc, res);
-                g_variant_unref(res);
-                return;
+                return value * 1024;
             }
-            else if ("UserInputProvide" == method_name)
+        }
+        return G_MAXUINT64;
+    }
+
+
+    /*
+     *  C wrappers for the main loop sources, bus name watches and signal
+     *  handlers.  Each carries a weak reference to the pool as user data.
+     */
+    static void weak_free(gpointer data)
+    {
+        delete (std::weak_ptr<BackendPool> *) data;
+    }
+
+
+    static void weak_free_closure(gpointer data, GClosure *closure)
+    {
+        weak_free(data);
+    }
+
+
+    static gboolean refill_cb(gpointer data)
+    {
+        Ptr pool = ((std::weak_ptr<BackendPool> *) data)->lock();
+        if (pool)
+        {
+            pool->refill_source = 0;
+            pool->refill();
+        }
+        return G_SOURCE_REMOVE;
+    }
+
+
+    static void name_vanished_cb(GDBusConnection *conn,
+                                 const gchar *name,
+                                 gpointer data)
+    {
+        Ptr pool = ((std::weak_ptr<BackendPool> *) data)->lock();
+        if (pool)
+        {
+            std::string sender(name);
+            pool->backend_gone([sender](const IdleBackend& be)
+                               {
+                                   return !be.p2p && be.sender == sender;
+                               });
+        }
+    }
+
+
+    static void p2p_closed_cb(GDBusConnection *conn,
+                              gboolean remote_peer_vanished,
+                              GError *error,
+                              gpointer data)
+    {
+        Ptr pool = ((std::weak_ptr<BackendPool> *) data)->lock();
+        if (pool)
+        {
+            pool->backend_gone([conn](const IdleBackend& be)
+                               {
+                                   return be.p2p && be.conn == conn;
+                               });
+        }
+    }
+};
+
+
+/**
+ *  A SessionObject contains information about a specific VPN client tunnel.
+ *  Each time a new tunnel is created and initiated via D-Bus, the contents
+ *  of that D-Bus object is contained within a SessionObject.  The session
+ *  manager is be responsible for maintaining the life cycle of these objects.
+ */
+class SessionObject : public DBusObject,
+                      public DBusCredentials,
+                      public SessionManagerSignals
+{
+public:
+    /**
+     *  Constructor creating a new SessionObject
+     *
+     * @param dbuscon  D-Bus connection this object is tied to
+     * @param owner    An uid reference of the owner of this object.  This is
+     *                 typically the uid of the front-end user initating the
+     *                 creation of a new tunnel session.
+     * @param objpath  D-Bus object path of this object
+     * @param cfg_path D-Bus object path of the VPN profile configuration this
+     *                 session is tied to.
+     * @param p2p_server  DBusP2PServer the backend may register through,
+     *                 instead of registering over the bus.  May be empty.
+     */
+    SessionObject(GDBusConnection *dbuscon,
+                  std::function<void()> remove_callback,
+                  uid_t owner,
+                  std::string objpath, std::string cfg_path,
+                  unsigned int manager_log_level,
+                  std::shared_ptr<DBusP2PServer> p2p_server)
+        : DBusObject(objpath),
+          DBusCredentials(dbuscon, owner),
+          SessionManagerSignals(dbuscon, objpath, manager_log_level),
+          remove_callback(remove_callback),
+          recv_log_events(false),
+          session_created(std::time(nullptr)),
+          config_path(cfg_path),
+          sig_statuschg(nullptr),
+          sig_logevent(nullptr),
+          backend_token(""),
+          backend_pid(0),
+          be_conn(nullptr),
+          be_p2p(false),
+          p2p_server(p2p_server),
+          be_p2p_subscr(0),
+          sigrouter(DBusSignalRouter::Get(dbuscon)),
+          regreq_route(0),
+          attention_route(0),
+          statuschg_route(0),
+          log_route(0),
+          propchg_route(0),
+          procchg_route(0),
+          registered(false),
+          backend_starting(false),
+          backend_alive(false),
+          callback_guard(std::make_shared<CallbackGuard>()),
+          selfdestruct_requested(false)
+    {
+        callback_guard->session = this;
+
+        // Only for the initialization of this object, use the manager's
+        // log level.  Once the object is registered with a backend, it
+        // will switch to the default session log level.
+        SetLogLevel(manager_log_level);
+        SetIntrospection(introspection_data());
+
+        // The backend process is started by StartBackend() via the
+        // openvpn3-service-backendstart (net.openvpn.v3.backends) service.
+        // A random backend token is created and sent to the backend
+        // process.  When the backend process have initialized, it reports
+        // back to the session manager using this token as a reference.
+        // This is used to tie the backend process to this specific
+        // SessionObject.
+        backend_token = generate_path_uuid("", 't');
+
+        // The RegistrationRequest signal is broadcast by all starting
+        // backend processes.  Route it on the backend token, so only
+        // this session object is woken up by its own backend.
+        regreq_route = sigrouter.SubscribeToken(OpenVPN3DBus_interf_backends,
+                                                "RegistrationRequest", 1,
+                                                backend_token,
+                                                signal_handler());
+
+        // A backend able to reach the session manager directly registers
+        // over a private connection instead, which is then used for all
+        // the communication with the backend.
+        if (p2p_server)
+        {
+            p2p_server->AddToken(backend_token,
+                                 [this](GDBusConnection *p2pconn,
+                                        const std::string& obj_path,
+                                        GVariant *params)
+                                 {
+                                     registration_request(p2pconn, "", obj_path,
+                                                          params, true);
+                                 });
+        }
+
+        Debug("SessionObject registered on '" + OpenVPN3DBus_interf_sessions + "': "
+              + objpath + " [backend_token=" + backend_token + "]");
+
+        std::stringstream msg;
+        msg << "Session starting, configuration path: " << cfg_path
+            << ", owner: " << lookup_username(owner);
+        LogVerb1(msg.str());
+    }
+
+
+    /**
+     *  Sets the log listeners registered with the session manager, which
+     *  receive the log events of this session as well.  This must be
+     *  called before StartBackend().
+     *
+     * @param listeners  DBusSignalProducer with the log listeners as its
+     *                   signal targets
+     */
+    void SetLogListeners(std::shared_ptr<DBusSignalProducer> listeners)
+    {
+        log_listeners = listeners;
+    }
+
+
+    /**
+     *  Requests openvpn3-service-backendstart to start the VPN client
+     *  backend process for this session.  This does not wait for the
+     *  process to be started; until the backend has registered, the
+     *  session is in the PROC_STARTING state and method calls are
+     *  rejected with the net.openvpn.v3.sessions.error.starting error.
+     *  PROC_STARTED is announced once the backend has registered.  If
+     *  the backend could not be started, the session is removed.
+     *
+     *  If a BackendPool is given and it has an idle backend available,
+     *  that backend is used instead of starting a new one.
+     *
+     *  This must be called from the main loop after the object has been
+     *  registered on the D-Bus.
+     *
+     * @param pool  BackendPool to claim an idle backend from.  May be empty.
+     */
+    void StartBackend(BackendPool::Ptr pool = nullptr)
+    {
+        backend_starting = true;
+        StatusChange(StatusMajor::SESSION, StatusMinor::PROC_STARTING,
+                     "session_path=" + GetObjectPath());
+
+        BackendPool::IdleBackend idle_be;
+        if (pool && pool->Claim(idle_be))
+        {
+            adopt_backend(idle_be);
+            return;
+        }
+
+        std::shared_ptr<CallbackGuard> guard = callback_guard;
+        try
+        {
+            DBusProxy backend_start(G_BUS_TYPE_SYSTEM,
+                                    OpenVPN3DBus_name_backends,
+                                    OpenVPN3DBus_interf_backends,
+                                    OpenVPN3DBus_rootp_backends);
+            backend_start.CallAsync("StartClient",
+                                    g_variant_new("(s)", backend_token.c_str()),
+                                    [guard](GVariant *response, GError *error)
+                                    {
+                                        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+                                        if (nullptr != guard->session)
+                                        {
+                                            guard->session->backend_started(response, error);
+                                        }
+                                    });
+        }
+        catch (DBusException& excp)
+        {
+            backend_start_failed(excp.getRawError());
+        }
+    }
+
+    ~SessionObject()
+    {
+        // Unlist this session in the session manager before any member
+        // is torn down; GetManagedObjects() may otherwise reach it
+        unlist_session();
+        {
+            // Waits for a pending callback being processed
+            std::lock_guard<std::recursive_mutex> lg(callback_guard->lock);
+            callback_guard->session = nullptr;
+            shutdown_wait_cleanup();
+            stop_liveness_tracking();
+        }
+        unsubscribe_signals();
+        backend_host_ref(false);
+
+        if (sig_statuschg)
+        {
+            delete sig_statuschg;
+        }
+
+        if (sig_logevent)
+        {
+            delete sig_logevent;
+        }
+
+        if (be_p2p && be_conn)
+        {
+            g_dbus_connection_close(be_conn, NULL, NULL, NULL);
+            g_object_unref(be_conn);
+        }
+
+        if (last_statistics)
+        {
+            g_variant_unref(last_statistics);
+        }
+        LogVerb1("Session is closing");
+        StatusChange(StatusMajor::SESSION, StatusMinor::SESS_REMOVED);
+        IdleCheck_RefDec();
+    }
+
+
+    /**
+     *  Callback method called each time signals we have subscribed to
+     *  occurs.  For the SessionObject, we care about these signals:
+     *
+     *    - RegistrationRequest:  which the VPN client backend process
+     *                            sends once it has completed the
+     *                            initialization, if it could not
+     *                            register over a private connection.
+     *    - StatusChange:         whenever the status changes in the backend
+     *    - AttentionRequired:    whenever the backend process needs
+     *                            information from the front-end user.
+     *    - Log:                  log events from the backend process
+     *
+     *  The backend sends StatusChange, AttentionRequired and Log only to
+     *  the session manager, so these are passed on to the registered log
+     *  listeners as well.
+     *
+     * @param conn             D-Bus connection where the signal came from
+     * @param sender_name      D-Bus bus name of the sender of the singal
+     * @param object_path      D-Bus object path of the signal
+     * @param interface_name   D-Bus interface of the signal
+     * @param signal_name      The name of the signal itself
+     * @param params           GVariant Glib2 object containing all the
+     *                         variables the signal carries
+     */
+    void callback_signal_handler(GDBusConnection *conn,
+                                 const std::string sender_name,
+                                 const std::string object_path,
+                                 const std::string interface_name,
+                                 const std::string signal_name,
+                                 GVariant *params)
+    {
+        if ((interface_name == OpenVPN3DBus_interf_backends)
+            && (signal_name == "StatusChange"
+                || signal_name == "AttentionRequired"
+                || signal_name == "Log"))
+        {
+            forward_to_log_listeners(signal_name, params);
+        }
+
+        if ((signal_name == "RegistrationRequest")
+            && (interface_name == OpenVPN3DBus_interf_backends))
+        {
+            registration_request(conn, sender_name, object_path, params, false);
+        }
+        else if ((signal_name == "StatusChange")
+                 && (interface_name == OpenVPN3DBus_interf_backends))
+        {
+            guint32 major_u;
+            guint32 minor_u;
+            gchar *msg;
+            g_variant_get (params, "(uus)", &major_u, &minor_u, &msg);
+
+            StatusMajor major = (StatusMajor) major_u;
+            StatusMinor minor = (StatusMinor) minor_u;
+            if (StatusMajor::CONNECTION == major
+                && (StatusMinor::CONN_FAILED == minor
+                    || StatusMinor::CONN_AUTH_FAILED == minor))
+            {
+                // When the backend client signals connection failure
+                // force it to shutdown and close this session object
+                //
+                // FIXME: Consider if we need to split CONN_FAILED into
+                //        a fatal error (as now) and "Connection failed, but session may resume"
+                //        This link is between here and client/core-client.hpp:173
+                //
+                shutdown(true, (StatusMinor::CONN_FAILED == minor));
+            }
+        }
+        else if ((signal_name =="AttentionRequired")
+                 && (interface_name == OpenVPN3DBus_interf_backends))
+        {
+                // Proxy this signal directly to the front-end processes
+                // listening
+                Send("AttentionRequired", params);
+        }
+        else if ((signal_name == "PropertiesChanged")
+                 && (interface_name == "org.freedesktop.DBus.Properties"))
+        {
+            proxy_backend_properties(params);
+        }
+        else if ((signal_name == "ProcessChange")
+                 && (interface_name == OpenVPN3DBus_interf_backends))
+        {
+            guint32 status = 0;
+            g_variant_get(params, "(u&su)", &status, NULL, NULL);
+            if (StatusMinor::PROC_STOPPED == (StatusMinor) status)
+            {
+                // This object may be removed by backend_exited()
+                std::shared_ptr<CallbackGuard> guard = callback_guard;
+                std::lock_guard<std::recursive_mutex> lg(guard->lock);
+                backend_exited();
+            }
+        }
+    }
+
+    /**
+     *  Method calls which are forwarded to the VPN client backend process
+     *  may block for a while.  These are dispatched on a worker thread
+     *  when asynchronous dispatching is enabled, to avoid blocking other
+     *  sessions handled by the session manager.
+     *
+     *  Access control list changes and property reads are kept in the
+     *  main loop, as the ACL is also read by the session manager when
+     *  listing available sessions.
+     *
+     * @param intf_name  D-Bus interface of the method call
+     * @param meth_name  D-Bus method name being called
+     *
+     * @return Returns true if the method call can run on a worker thread
+     */
+    bool callback_async_dispatch(const std::string& intf_name,
+                                 const std::string& meth_name)
+    {
+        return (OpenVPN3DBus_interf_sessions == intf_name
+                && "AccessGrant" != meth_name
+                && "AccessRevoke" != meth_name);
+    }
+
+
+    /**
+     *  Callback method which is called each time a D-Bus method call occurs
+     *  on this SessionObject.  The method call is passed on to the handler
+     *  registered in the method table, after the backend process has been
+     *  checked to be alive.
+     *
+     *  In most cases the method call is just proxied to the client backend
+     *  process after an access control check has been performed.  Many of the
+     *  calls can be accessed by the owner or designated user IDs, and the
+     *  most sensitive methods are only accessible to the owner of this
+     *  session.
+     *
+     * @param call  DBusMethodCall with the method call arguments
+     *
+     * @return Returns false if the method is not found in the method table
+     */
+    bool callback_method_dispatch(const DBusMethodCall& call)
+    {
+        MethodTable::Handler handler = method_table().Lookup(call.intf_name,
+                                                             call.method_name);
+        if (nullptr == handler)
+        {
+            return false;
+        }
+
+        if (backend_starting)
+        {
+            // The backend has not registered yet; this is not a failure
+            // of the session.  Front-ends should wait for the PROC_STARTED
+            // status change before calling methods on the session.
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.sessions.error.starting",
+                                                          "Backend process is still starting");
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+            return true;
+        }
+
+        // The backend liveness is tracked from the main loop, through
+        // its bus name and a pidfd for the backend process
+        bool alive = backend_alive;
+        bool disable_critical_log = false;
+
+        try {
+            if (!backend_proxy())
+            {
+                THROW_DBUSEXCEPTION("SessionObject", "No backend proxy connection available. Backend died?");
+            }
+            if (!alive)
+            {
+                THROW_DBUSEXCEPTION("SessionObject", "Backend process has exited");
+            }
+
+
+            std::stringstream msg;
+            msg << "Session operation: " << call.method_name
+                << ", requester:  " << lookup_username(GetUID(call.sender));
+            Debug(msg.str());
+
+            // We disable logging critical exceptions for the Ready method
+            // because it is expected to throw an exception with a reason if
+            // the backend isn't ready.  This is not a session critical
+            // scenario.
+            disable_critical_log = (0 == g_strcmp0("Ready", call.method_name));
+
+            (this->*handler)(call);
+        }
+        catch (DBusException& dberr)
+        {
+            bool do_selfdestruct = false;
+            std::string errmsg;
+
+            if (!alive)
+            {
+                errmsg = "Backend VPN process have died.  Session is no longer valid.";
+                if (!selfdestruct_requested)
+                {
+                    StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Backend process died");
+                    do_selfdestruct = true;
+                }
+            }
+            else
+            {
+                errmsg = "Failed communicating with VPN backend: " + dberr.getRawError();
+            }
+
+            if (!disable_critical_log)
+            {
+                LogCritical(errmsg);
+            }
+
+            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.sessions.error",
+                                                          errmsg.c_str());
+            g_dbus_method_invocation_return_gerror(call.invoc, err);
+            g_error_free(err);
+
+            if (do_selfdestruct)
+            {
+                selfdestruct();
+            }
+        }
+        catch (DBusCredentialsException& excp)
+        {
+            LogWarn(excp.err());
+            excp.SetDBusError(call.invoc);
+        }
+        return true;
+    };
+
+
+    /**
+     *  Called for method calls not found in the method table.  GDBus
+     *  validates the method calls against the introspection data, so
+     *  this should normally not happen.
+     *
+     * @param conn       D-Bus connection where the method call occurred
+     * @param sender     D-Bus bus name of the sender of the method call
+     * @param obj_path   D-Bus object path of the target object.
+     * @param intf_name  D-Bus interface of the method call
+     * @param method_name D-Bus method name to be executed
+     * @param params     GVariant Glib2 object containing the arguments for
+     *                   the method call
+     * @param invoc      GDBusMethodInvocation where the response/result of
+     *                   the method call will be returned.
+     */
+    void callback_method_call(GDBusConnection *conn,
+                              const std::string sender,
+                              const std::string obj_path,
+                              const std::string intf_name,
+                              const std::string method_name,
+                              GVariant *params,
+                              GDBusMethodInvocation *invoc)
+    {
+        std::string errmsg = "No method named" + method_name + " is available";
+        GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.sessions.error",
+                                                      errmsg.c_str());
+        g_dbus_method_invocation_return_gerror(invoc, err);
+        g_error_free(err);
+    };
+
+
+    /**
+     *   Callback which is used each time a SessionObject D-Bus property is
+     *   being read.
+     *
+     *   Only the 'owner' is accessible by anyone, otherwise it must either
+     *   be the session owner or UIDs granted access to this session.
+     *
+     * @param conn           D-Bus connection this event occurred on
+     * @param sender         D-Bus bus name of the requester
+     * @param obj_path       D-Bus object path to the object being requested
+     * @param intf_name      D-Bus interface of the property being accessed
+     * @param property_name  The property name being accessed
+     * @param error          A GLib2 GError object if an error occurs
+     *
+     * @return  Returns a GVariant Glib2 object containing the value of the
+     *          requested D-Bus object property.  On errors, NULL must be
+     *          returned and the error must be returned via a GError
+     *          object.
+     */
+    GVariant * callback_get_property(GDBusConnection *conn,
+                                     const std::string sender,
+                                     const std::string obj_path,
+                                     const std::string intf_name,
+                                     const std::string property_name,
+                                     GError **error)
+    {
+        if ("owner" == property_name)
+        {
+            return GetOwner();
+        }
+
+        if (ACLDecision::DENY == EvaluateACL(sender))
+        {
+            DBusCredentialsException excp = AccessDenied(sender);
+            LogWarn(excp.err());
+            excp.SetDBusError(error, G_IO_ERROR, G_IO_ERROR_FAILED);
+            return NULL;
+        }
+
+
+        /*
+          std::cout << "[SessionObject] get_property(): "
+                  << "sender=" << sender
+                  << ", object_path=" << obj_path
+                  << ", interface=" << intf_name
+                  << ", property=" << property_name
+                  << std::endl;
+        */
+        return get_property_value(property_name, error);
+    };
+
+
+    /**
+     *   Callback used when all SessionObject properties are retrieved in
+     *   a single org.freedesktop.DBus.Properties.GetAll() call.  The access
+     *   control check is only done once for all the properties.  Callers
+     *   without access will only see the 'owner' property.
+     *
+     * @param conn           D-Bus connection this event occurred on
+     * @param sender         D-Bus bus name of the requester
+     * @param obj_path       D-Bus object path to the object being requested
+     * @param intf_name      D-Bus interface of the properties being accessed
+     * @param error          A GLib2 GError object if an error occurs
+     *
+     * @return  Returns a GVariant a{sv} dictionary with all the properties.
+     *          On errors, NULL is returned and the error is returned via
+     *          the GError object.
+     */
+    GVariant * callback_get_all_properties(GDBusConnection *conn,
+                                           const std::string sender,
+                                           const std::string obj_path,
+                                           const std::string intf_name,
+                                           GError **error)
+    {
+        bool granted = (ACLDecision::DENY != EvaluateACL(sender));
+        if (!granted)
+        {
+            LogWarn(AccessDenied(sender).err());
+        }
+
+        return build_all_properties(intf_name,
+                                    [this, granted](const std::string& prop,
+                                                    GError **err) -> GVariant *
+                                    {
+                                        if (!granted && "owner" != prop)
+                                        {
+                                            return NULL;
+                                        }
+                                        return get_property_value(prop, err);
+                                    });
+    }
+
+
+    /**
+     *  Callback method which is used each time a SessionObject property
+     *  is being modified over the D-Bus.
+     *
+     * @param conn           D-Bus connection this event occurred on
+     * @param sender         D-Bus bus name of the requester
+     * @param obj_path       D-Bus object path to the object being requested
+     * @param intf_name      D-Bus interface of the property being accessed
+     * @param property_name  The property name being accessed
+     * @param value          GVariant object containing the value to be stored
+     * @param error          A GLib2 GError object if an error occurs
+     *
+     * @return Returns a GVariantBuilder object which will be used by the
+     *         D-Bus library to issue the required PropertiesChanged signal.
+     *         If an error occurres, the DBusPropertyException is thrown.
+     */
+    GVariantBuilder * callback_set_property(GDBusConnection *conn,
+                                            const std::string sender,
+                                            const std::string obj_path,
+                                            const std::string intf_name,
+                                            const std::string property_name,
+                                            GVariant *value,
+                                            GError **error)
+    {
+        /*
+          std::cout << "[SessionObject] set_property(): "
+                  << "sender=" << sender
+                  << ", object_path=" << obj_path
+                  << ", interface=" << intf_name
+                  << ", property=" << property_name
+                  << std::endl;
+        */
+        try
+        {
+            CheckOwnerAccess(sender);
+        }
+        catch (DBusCredentialsException& excp)
+        {
+            LogWarn(excp.err());
+            throw DBusPropertyException(G_IO_ERROR, G_IO_ERROR_FAILED,
+                                        obj_path, intf_name, property_name,
+                                        excp.getUserError());
+        }
+
+        try
+        {
+            if (("receive_log_events" == property_name) && be_conn)
+            {
+                // The proxied log events are only delivered to the
+                // callers which enabled this property
+                if (g_variant_get_boolean(value))
+                {
+                    if (nullptr == sig_logevent)
+                    {
+                        // Subscribe to log signals
+                        sig_logevent = new SessionLogEvent(
+                                        sigrouter.GetConnection(),
+                                        be_conn,
+                                        be_sender(),
+                                        OpenVPN3DBus_interf_backends,
+                                        be_path,
+                                        GetObjectPath());
+                        sig_logevent->SetLogLevel(default_session_log_level);
+                        sig_logevent->SetLogListeners(log_listeners);
+                        sig_logevent->SetTargetedDelivery(true);
+                    }
+                    sig_logevent->AddTargetBusName(sender);
+                }
+                else if (nullptr != sig_logevent)
+                {
+                    sig_logevent->RemoveTargetBusName(sender);
+                    if (0 == sig_logevent->GetTargetCount())
+                    {
+                        delete sig_logevent;
+                        sig_logevent = nullptr;
+                    }
+                }
+                recv_log_events = (nullptr != sig_logevent);
+                return build_set_property_response(property_name, recv_log_events);
+            }
+            else if (("log_verbosity" == property_name) && be_conn && sig_logevent)
+            {
+                unsigned int log_verb = g_variant_get_uint32(value);
+                sig_logevent->SetLogLevel(log_verb);
+                SetLogLevel(log_verb);
+
+                // FIXME: Proxy log level to the OpenVPN3 Core client
+                return build_set_property_response(property_name,
+                                                   (guint32) log_verb);
+            }
+            else if (("public_access" == property_name) && conn)
+            {
+                bool acl_public = g_variant_get_boolean(value);
+                SetPublicAccess(acl_public);
+                LogInfo("Public access set to "
+                         + (acl_public ? std::string("true") :
+                                         std::string("false"))
+                         + " by uid " + std::to_string(GetUID(sender)));
+                return build_set_property_response(property_name, acl_public);
+            }
+        }
+        catch (DBusException& excp)
+        {
+            throw DBusPropertyException(G_IO_ERROR, G_IO_ERROR_FAILED,
+                                        obj_path, intf_name, property_name,
+                                        excp.what());
+        }
+        throw DBusPropertyException(G_IO_ERROR, G_IO_ERROR_FAILED,
+                                    obj_path, intf_name, property_name,
+                                    "Invalid property");
+    }
+
+
+    /**
+     *  Clean-up function triggered by the D-Bus library when an object
+     *  is removed from the D-Bus
+     */
+    void callback_destructor ()
+    {
+        // The signal objects may still be used by a method call running
+        // on a worker thread; they are released by the destructor
+    };
+
+
+private:
+    /**
+     *  Shared with pending StartClient calls, timers and bus name
+     *  watches, which may complete after this object has been removed.
+     *  The destructor clears the session pointer while holding the lock.
+     */
+    struct CallbackGuard
+    {
+        std::recursive_mutex lock;
+        SessionObject *session = nullptr;
+    };
+
+    unsigned int default_session_log_level = 4; // LogCategory::INFO messages
+    const guint shutdown_timeout = 10;     // Seconds to wait for Disconnect
+    const guint shutdown_kill_timeout = 5; // Seconds before killing the backend
+    const std::chrono::seconds statistics_max_age{5}; // Backend statistics interval
+    std::function<void()> remove_callback;
+    std::shared_ptr<DBusProxy> be_proxy;
+    std::mutex be_proxy_guard;
+    GVariant *last_statistics = nullptr;
+    std::chrono::steady_clock::time_point last_statistics_time;
+    bool statistics_refreshing = false;
+    std::mutex statistics_guard;
+    bool recv_log_events;
+    std::time_t session_created;
+    std::string config_path;
+    SessionStatusChange *sig_statuschg;
+    SessionLogEvent *sig_logevent;
+    std::shared_ptr<DBusSignalProducer> log_listeners;
+    std::string backend_token;
+    pid_t backend_pid;
+    GDBusConnection *be_conn;
+    bool be_p2p;
+    std::shared_ptr<DBusP2PServer> p2p_server;
+    guint be_p2p_subscr;
+    std::string be_busname;
+    std::string be_path;
+    DBusSignalRouter& sigrouter;
+    guint regreq_route;
+    guint attention_route;
+    guint statuschg_route;
+    guint log_route;
+    guint propchg_route;
+    guint procchg_route;
+    bool registered;
+    std::atomic<bool> backend_starting;
+    std::atomic<bool> backend_alive;
+    bool backend_host_counted = false;
+    guint be_name_watch = 0;
+    int be_pidfd = -1;
+    guint be_pidfd_source = 0;
+    std::shared_ptr<CallbackGuard> callback_guard;
+    std::mutex shutdown_guard;
+    bool shutdown_pending = false;
+    bool shutdown_forced = false;
+    bool shutdown_selfdestruct = false;
+    bool shutdown_escalated = false;
+    guint shutdown_timer = 0;
+    std::atomic<bool> selfdestruct_requested;
+
+
+    /**
+     *  Number of registered sessions per VPN client backend bus name.  A
+     *  backend process may host several sessions.
+     */
+    struct BackendHosts
+    {
+        std::mutex guard;
+        std::map<std::string, unsigned int> sessions;
+    };
+
+    static BackendHosts& backend_hosts()
+    {
+        static BackendHosts hosts;
+        return hosts;
+    }
+
+
+    /**
+     *  Counts this session on its backend process, once it has
+     *  registered, and releases it again.
+     *
+     * @param acquire  Set to true when the backend has registered, false
+     *                 when the session is destroyed
+     */
+    void backend_host_ref(bool acquire)
+    {
+        BackendHosts& hosts = backend_hosts();
+        std::lock_guard<std::mutex> lg(hosts.guard);
+        if (acquire && !backend_host_counted)
+        {
+            hosts.sessions[be_busname]++;
+            backend_host_counted = true;
+        }
+        else if (!acquire && backend_host_counted)
+        {
+            if (0 == --hosts.sessions[be_busname])
+            {
+                hosts.sessions.erase(be_busname);
+            }
+            backend_host_counted = false;
+        }
+    }
+
+
+    /**
+     *  Checks if the backend process of this session also runs other
+     *  sessions
+     *
+     * @return Returns true if other sessions are hosted by the same backend
+     */
+    bool backend_hosts_others()
+    {
+        BackendHosts& hosts = backend_hosts();
+        std::lock_guard<std::mutex> lg(hosts.guard);
+        auto it = hosts.sessions.find(be_busname);
+        return (hosts.sessions.end() != it && it->second > 1);
+    }
+
+
+    /**
+     *  Parses the introspection document shared by all SessionObjects.
+     *  This is only done once, the first time a SessionObject is created.
+     *
+     * @return Returns a GDBusNodeInfo pointer to the introspection document
+     */
+    static GDBusNodeInfo * introspection_data()
+    {
+        static GDBusNodeInfo *node = build_introspection();
+        return node;
+    }
+
+
+    typedef DBusMethodTable<SessionObject> MethodTable;
+
+
+    /**
+     *  The D-Bus methods of a SessionObject with their handlers and
+     *  introspection data.  The handlers are called by
+     *  callback_method_dispatch() once the backend process has been
+     *  found to be alive.
+     */
+    static const MethodTable& method_table()
+    {
+        static const MethodTable table = build_method_table();
+        return table;
+    }
+
+
+    static MethodTable build_method_table()
+    {
+        const std::string intf(OpenVPN3DBus_interf_sessions);
+        MethodTable table;
+        table.Add(intf, "Connect", "", &SessionObject::method_connect)
+             .Add(intf, "Pause",
+                  "            <arg type='s' name='reason' direction='in'/>",
+                  &SessionObject::method_pause)
+             .Add(intf, "Resume", "", &SessionObject::method_resume)
+             .Add(intf, "Restart", "", &SessionObject::method_restart)
+             .Add(intf, "Disconnect", "", &SessionObject::method_disconnect)
+             .Add(intf, "Ready", "", &SessionObject::method_ready)
+             .Add(intf, "AccessGrant",
+                  "            <arg direction='in' type='u' name='uid'/>",
+                  &SessionObject::method_access_grant)
+             .Add(intf, "AccessRevoke",
+                  "            <arg direction='in' type='u' name='uid'/>",
+                  &SessionObject::method_access_revoke);
+
+        // The introspection of these comes from RequiresQueue
+        for (const char *meth : {"UserInputQueueGetTypeGroup",
+                                 "UserInputQueueFetch",
+                                 "UserInputQueueCheck",
+                                 "UserInputProvide"})
+        {
+            table.Add(intf, meth, &SessionObject::method_user_input);
+        }
+        return table;
+    }
+
+
+    void method_connect(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender);
+        backend_proxy()->Call("Connect");
+        LogVerb2("Starting connection");
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_restart(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender, true);
+        backend_proxy()->Call("Restart");
+        LogVerb2("Restarting connection");
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_pause(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender, true);
+        // FIXME: Should check that params contains only the expected formatting
+        backend_proxy()->Call("Pause", call.params);
+        LogVerb2("Pausing connection");
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_resume(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender, true);
+        backend_proxy()->Call("Resume");
+        LogVerb2("Resuming connection");
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_disconnect(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender, true);
+        LogVerb2("Disconnecting connection");
+        shutdown(false, true);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_ready(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender);
+        backend_proxy()->Call("Ready");
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    /**
+     *  Proxies the user input queue methods to the backend process,
+     *  which has the same methods.
+     */
+    void method_user_input(const DBusMethodCall& call)
+    {
+        CheckACL(call.sender);
+        try
+        {
+            GVariant *res = backend_proxy()->Call(call.method_name, call.params);
+            g_dbus_method_invocation_return_value(call.invoc, res);
+            g_variant_unref(res);
+        }
+        catch (RequiresQueueException& excp)
+        {
+            // Convert this exception into an error sent back
+            // to the requester as a D-Bus error instead.
+            excp.GenerateDBusError(call.invoc);
+        }
+    }
+
+
+    void method_access_grant(const DBusMethodCall& call)
+    {
+        CheckOwnerAccess(call.sender);
+
+        uid_t uid = -1;
+        g_variant_get(call.params, "(u)", &uid);
+        GrantAccess(uid);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+
+        LogInfo("Access granted to UID " + std::to_string(uid));
+    }
+
+
+    void method_access_revoke(const DBusMethodCall& call)
+    {
+        CheckOwnerAccess(call.sender);
+
+        uid_t uid = -1;
+        g_variant_get(call.params, "(u)", &uid);
+        RevokeAccess(uid);
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+
+        LogInfo("Access revoked for UID " + std::to_string(uid));
+    }
+
+
+    static GDBusNodeInfo * build_introspection()
+    {
+        std::stringstream introspection_xml;
+        introspection_xml << "<node>"
+                          << "    <interface name='" << OpenVPN3DBus_interf_sessions << "'>"
+                          << method_table().GetIntrospection(OpenVPN3DBus_interf_sessions)
+                          << RequiresQueue::IntrospectionMethods("UserInputQueueGetTypeGroup",
+                                                                 "UserInputQueueFetch",
+                                                                 "UserInputQueueCheck",
+                                                                 "UserInputProvide")
+                          << "        <signal name='AttentionRequired'>"
+                          << "            <arg type='u' name='type' direction='out'/>"
+                          << "            <arg type='u' name='group' direction='out'/>"
+                          << "            <arg type='s' name='message' direction='out'/>"
+                          << "        </signal>"
+                          << LogSender::GetStatusChangeIntrospection()
+                          << LogSender::GetLogIntrospection()
+                          << "        <property type='u' name='owner' access='read'/>"
+                          << "        <property type='t' name='session_created' access='read'/>"
+                          << "        <property type='au' name='acl' access='read'/>"
+                          << "        <property type='b' name='public_access' access='readwrite'/>"
+                          << "        <property type='a{sv}' name='status' access='read'/>"
+                          << "        <property type='a{sv}' name='last_log' access='read'/>"
+                          << "        <property type='a{sx}' name='statistics' access='read'/>"
+                          << "        <property type='o' name='config_path' access='read'/>"
+                          << "        <property type='u' name='backend_pid' access='read'/>"
+                          << "        <property type='b' name='receive_log_events' access='readwrite'/>"
+                          << "        <property type='u' name='log_verbosity' access='readwrite'/>"
+                          << "    </interface>"
+                          << "</node>";
+        return ParseIntrospection(introspection_xml.str());
+    }
+
+
+    /**
+     *  Prepares a signal router handler passing signals on to
+     *  callback_signal_handler()
+     */
+    DBusSignalRouter::Handler signal_handler()
+    {
+        return [this](GDBusConnection *conn,
+                      const std::string& sender,
+                      const std::string& obj_path,
+                      const std::string& intf_name,
+                      const std::string& signal_name,
+                      GVariant *params)
+               {
+                   callback_signal_handler(conn, sender, obj_path,
+                                           intf_name, signal_name, params);
+               };
+    }
+
+
+    /**
+     *  Sends a signal from the backend process on to the log listeners
+     *  registered with the session manager.  The signal keeps the
+     *  backend interface and object path, as if the backend sent it.
+     *
+     * @param signal_name  Name of the backend signal
+     * @param params       GVariant Glib2 object with the signal arguments
+     */
+    void forward_to_log_listeners(const std::string& signal_name,
+                                  GVariant *params)
+    {
+        if (log_listeners && 0 < log_listeners->GetTargetCount())
+        {
+            log_listeners->Send("", OpenVPN3DBus_interf_backends, be_path,
+                                signal_name, params);
+        }
+    }
+
+
+    /**
+     *  Removes all the signal routes and subscriptions of this session
+     *  object
+     */
+    void unsubscribe_signals()
+    {
+        for (guint *route : {&regreq_route, &attention_route,
+                             &statuschg_route, &log_route,
+                             &propchg_route, &procchg_route})
+        {
+            if (0 != *route)
             {
-                CheckACL(sender);
-                try
-                {
-                    GVariant *res = be_proxy->Call("UserInputProvide", params);
-                    g_dbus_method_invocation_return_value(invoc, res);
-                    g_variant_unref(res);
-                }
-                catch (RequiresQueueException& excp)
-                {
-                    // Convert this exception into an error sent back
-                    // to the requester as a D-Bus error instead.
-                    excp.GenerateDBusError(invoc);
-                }
-                return;
+                sigrouter.Unsubscribe(*route);
+                *route = 0;
             }
-            else if ("AccessGrant" == method_name)
-            {
-                CheckOwnerAccess(sender);
+        }
+        if (p2p_server)
+        {
+            p2p_server->RemoveToken(backend_token);
+        }
+        if (0 != be_p2p_subscr)
+        {
+            g_dbus_connection_signal_unsubscribe(be_conn, be_p2p_subscr);
+            be_p2p_subscr = 0;
+        }
+    }
 
-                uid_t uid = -1;
-                g_variant_get(params, "(u)", &uid);
-                GrantAccess(uid);
-                g_dbus_method_invocation_return_value(invoc, NULL);
 
-                LogInfo("Access granted to UID " + std::to_string(uid));
-                return;
-            }
-            else if ("AccessRevoke" == method_name)
+    /**
+     *  Bus name used to subscribe to signals from the backend.  Signals
+     *  on a private connection carry no sender.
+     */
+    std::string be_sender() const
+    {
+        return (be_p2p ? "" : be_busname);
+    }
+
+
+    /**
+     *  Completes the StartClient call started by StartBackend().  Called
+     *  from the main loop.
+     *
+     * @param response  GVariant with the StartClient result, NULL on errors
+     * @param error     GError describing a failed call, NULL on success
+     */
+    void backend_started(GVariant *response, GError *error)
+    {
+        if (NULL != error)
+        {
+            backend_start_failed(error->message);
+            return;
+        }
+
+        // The PID value we get here is just a temporary.  This is the
+        // PID returned by openvpn3-service-backendstart.  This will again
+        // start the openvpn3-service-client process, which will fork() once
+        // to be completely independent.  The final PID is looked up when
+        // the backend registers, which may already have happened.
+        guint32 pid = 0;
+        g_variant_get(response, "(u)", &pid);
+        if (0 == backend_pid)
+        {
+            backend_pid = pid;
+        }
+        Debug("Backend process started, backend_pid=" + std::to_string(pid));
+    }
+
+
+    /**
+     *  Registers a backend claimed from the BackendPool with this session.
+     *  The backend has already sent its RegistrationRequest, using the
+     *  token it was started with by the pool.
+     *
+     * @param idle_be  BackendPool::IdleBackend with the claimed backend.
+     *                 The references it carries are taken over.
+     */
+    void adopt_backend(BackendPool::IdleBackend& idle_be)
+    {
+        sigrouter.Unsubscribe(regreq_route);
+        regreq_route = 0;
+        if (p2p_server)
+        {
+            p2p_server->RemoveToken(backend_token);
+        }
+        backend_token = idle_be.token;
+
+        Debug("Using pre-started backend, backend_path=" + idle_be.object_path);
+        registration_request(idle_be.conn, idle_be.sender,
+                             idle_be.object_path, idle_be.params,
+                             idle_be.p2p);
+        g_variant_unref(idle_be.params);
+    }
+
+
+    /**
+     *  Removes this session when the backend process could not be started
+     *
+     * @param errmsg  std::string with the reason for the failure
+     */
+    void backend_start_failed(const std::string& errmsg)
+    {
+        backend_starting = false;
+        LogError("Failed to start the VPN client backend process: " + errmsg);
+        StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED,
+                     "Failed to start backend process");
+        selfdestruct();
+    }
+
+
+    /**
+     *  Handles the RegistrationRequest signal from the VPN client backend
+     *  process, sent either over the bus or over a private connection
+     *  handed over by the DBusP2PServer.  In the latter case, this object
+     *  takes over the reference to the connection.
+     *
+     * @param conn         D-Bus connection the signal arrived on
+     * @param sender       Unique bus name of the backend, empty on a
+     *                     private connection
+     * @param object_path  D-Bus object path of the backend
+     * @param params       GVariant Glib2 object with the signal arguments
+     * @param p2p          Bool flag, true if conn is a private connection
+     */
+    void registration_request(GDBusConnection *conn,
+                              const std::string& sender,
+                              const std::string& object_path,
+                              GVariant *params,
+                              bool p2p)
+    {
+        gchar *busn = nullptr;
+        gchar *sesstoken = nullptr;
+        g_variant_get (params, "(ss)", &busn, &sesstoken);
+        std::string busname(busn);
+        std::string token(sesstoken);
+        g_free(busn);
+        g_free(sesstoken);
+
+        // Ignore requests not carrying our token.  Both the signal
+        // router and the DBusP2PServer only pass on requests carrying
+        // our token, so this should not happen.  Also ignore a request
+        // if the backend already registered over the other channel.
+        if (token != backend_token || nullptr != be_conn)
+        {
+            // Debug("Ignoring RegistrationRequest - name=" + busname + ", path=" + object_path);
+            if (p2p)
             {
-                CheckOwnerAccess(sender);
+                g_dbus_connection_close(conn, NULL, NULL, NULL);
+                g_object_unref(conn);
+            }
+            return;
+        }
 
-                uid_t uid = -1;
-                g_variant_get(params, "(u)", &uid);
-                RevokeAccess(uid);
-                g_dbus_method_invocation_return_value(invoc, NULL);
+        be_p2p = p2p;
+        be_conn = conn;
+        be_busname = busname;
+        be_path = object_path;
 
-                LogInfo("Access revoked for UID " + std::to_string(uid));
-                return;
+        try
+        {
+            if (be_p2p)
+            {
+                // Only the backend is on the other end of the connection,
+                // so a single subscription covers all its signals
+                be_p2p_subscr = g_dbus_connection_signal_subscribe(be_conn,
+                                                                   NULL,
+                                                                   NULL,
+                                                                   NULL,
+                                                                   be_path.c_str(),
+                                                                   NULL,
+                                                                   G_DBUS_SIGNAL_FLAGS_NONE,
+                                                                   p2p_signal_callback,
+                                                                   this,
+                                                                   NULL);
             }
             else
             {
-                std::string errmsg = "No method named" + method_name + " is available";
-                GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.sessions.error",
-                                                              errmsg.c_str());
-                g_dbus_method_invocation_return_gerror(invoc, err);
-                g_error_free(err);
-                return;
+                // The signal router matches the unique bus name of the
+                // sender; the bus name in the request is a well-known name
+                attention_route = sigrouter.Subscribe(OpenVPN3DBus_interf_backends,
+                                                      "AttentionRequired",
+                                                      sender, be_path,
+                                                      signal_handler());
+                statuschg_route = sigrouter.Subscribe(OpenVPN3DBus_interf_backends,
+                                                      "StatusChange",
+                                                      sender, be_path,
+                                                      signal_handler());
+                log_route = sigrouter.Subscribe(OpenVPN3DBus_interf_backends,
+                                                "Log",
+                                                sender, be_path,
+                                                signal_handler());
+                propchg_route = sigrouter.Subscribe("org.freedesktop.DBus.Properties",
+                                                    "PropertiesChanged",
+                                                    sender, be_path,
+                                                    signal_handler());
             }
-            g_dbus_method_invocation_return_value(invoc, NULL);
+            register_backend();
+            start_liveness_tracking(sender);
+            backend_host_ref(true);
+            backend_starting = false;
+            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_STARTED,
+                         "session_path=" + GetObjectPath()
+                         + ", backend_pid=" + std::to_string(backend_pid));
+            sigrouter.Unsubscribe(regreq_route);
+            regreq_route = 0;
+            if (p2p_server)
+            {
+                p2p_server->RemoveToken(backend_token);
+            }
+            SetLogLevel(default_session_log_level);
+            LogVerb2(std::string("Backend VPN client process registered")
+                     + (be_p2p ? " over a private connection" : ""));
         }
-        catch (DBusException& dberr)
+        catch (DBusException& err)
         {
-            bool do_selfdestruct = false;
-            std::string errmsg;
+            LogError("Could not register backend process, removing session object");
+            Debug(be_busname, be_path, backend_pid, std::string(err.what()));
+            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Backend process died");
+            selfdestruct();
+        }
+    }
+
 
-            if (!ping)
+    /**
+     *  Announces the connection statistics the backend periodically
+     *  reports via PropertiesChanged as a change of the statistics
+     *  property of this session.  The backend already rate-limits these
+     *  announcements.  The last statistics reported are kept, which is
+     *  what the statistics property returns.  See refresh_statistics()
+     *  for when they are fetched from the backend instead.
+     *
+     * @param params  GVariant with the PropertiesChanged signal arguments
+     */
+    void proxy_backend_properties(GVariant *params)
+    {
+        const gchar *intf = nullptr;
+        GVariant *changed = nullptr;
+        g_variant_get(params, "(&s@a{sv}as)", &intf, &changed, NULL);
+        if (OpenVPN3DBus_interf_backends == intf)
+        {
+            GVariant *stats = g_variant_lookup_value(changed, "statistics",
+                                                     G_VARIANT_TYPE("a{sx}"));
+            if (stats)
             {
-                try
-                {
-                    shutdown(true, true); // Ensure the backend client process have stopped
-                }
-                catch (DBusException& dberr)
-                {
-                    // Ignore any errors for now.
-                }
-                errmsg = "Backend VPN process have died.  Session is no longer valid.";
-                if (!selfdestruct_complete)
                 {
-                    StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Backend process died");
-                    do_selfdestruct = true;
+                    std::lock_guard<std::mutex> lg(statistics_guard);
+                    if (last_statistics)
+                    {
+                        g_variant_unref(last_statistics);
+                    }
+                    last_statistics = stats;
+                    last_statistics_time = std::chrono::steady_clock::now();
                 }
+                SendPropertyChanged(OpenVPN3DBus_interf_sessions,
+                                    "statistics", stats);
             }
-            else
+        }
+        g_variant_unref(changed);
+    }
+
+
+    /**
+     *  Fetches the connection statistics from the backend without
+     *  waiting for them.  The backend only reports the statistics when
+     *  they have changed, at most once every statistics_max_age.  This
+     *  is used when no report has arrived yet, or when the last one is
+     *  older than that.  Only one such request runs at a time.
+     */
+    void refresh_statistics()
+    {
+        {
+            std::lock_guard<std::mutex> lg(statistics_guard);
+            if (statistics_refreshing)
             {
-                errmsg = "Failed communicating with VPN backend: " + dberr.getRawError();
+                return;
             }
+            statistics_refreshing = true;
+        }
 
-            if (!disable_critical_log)
+        try
+        {
+            std::shared_ptr<DBusProxy> prx = backend_proxy();
+            if (!prx)
             {
-                LogCritical(errmsg);
+                THROW_DBUSEXCEPTION("SessionObject",
+                                    "Backend process not registered");
             }
+            std::shared_ptr<CallbackGuard> guard = callback_guard;
+            prx->GetPropertyAsync("statistics",
+                                  [guard](GVariant *value, GError *error)
+                                  {
+                                      std::lock_guard<std::recursive_mutex> lg(guard->lock);
+                                      if (nullptr != guard->session)
+                                      {
+                                          guard->session->statistics_refreshed(value);
+                                      }
+                                  });
+        }
+        catch (DBusException& excp)
+        {
+            std::lock_guard<std::mutex> lg(statistics_guard);
+            statistics_refreshing = false;
+        }
+    }
 
-            GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.sessions.error",
-                                                          errmsg.c_str());
-            g_dbus_method_invocation_return_gerror(invoc, err);
-            g_error_free(err);
 
-            if (do_selfdestruct)
+    /**
+     *  Stores the connection statistics fetched by refresh_statistics().
+     *  A change of the values is announced via PropertiesChanged.
+     *
+     * @param stats  GVariant a{sx} with the statistics, NULL on errors
+     */
+    void statistics_refreshed(GVariant *stats)
+    {
+        bool changed = false;
+        {
+            std::lock_guard<std::mutex> lg(statistics_guard);
+            statistics_refreshing = false;
+            if (NULL == stats
+                || !g_variant_is_of_type(stats, G_VARIANT_TYPE("a{sx}")))
+            {
+                return;
+            }
+            changed = (!last_statistics
+                       || !g_variant_equal(last_statistics, stats));
+            if (last_statistics)
             {
-                selfdestruct(conn);
+                g_variant_unref(last_statistics);
             }
+            last_statistics = g_variant_ref(stats);
+            last_statistics_time = std::chrono::steady_clock::now();
         }
-        catch (DBusCredentialsException& excp)
+        if (changed)
         {
-            LogWarn(excp.err());
-            excp.SetDBusError(invoc);
+            SendPropertyChanged(OpenVPN3DBus_interf_sessions,
+                                "statistics", stats);
         }
-    };
+    }
+
+
+    static void p2p_signal_callback(GDBusConnection *conn,
+                                    const gchar *sender,
+                                    const gchar *obj_path,
+                                    const gchar *intf_name,
+                                    const gchar *sign_name,
+                                    GVariant *params,
+                                    gpointer this_ptr)
+    {
+        SessionObject *obj = (SessionObject *) this_ptr;
+        obj->callback_signal_handler(conn, "", std::string(obj_path),
+                                     std::string(intf_name),
+                                     std::string(sign_name), params);
+    }
 
 
     /**
-     *   Callback which is used each time a SessionObject D-Bus property is
-     *   being read.
-     *
-     *   Only the 'owner' is accessible by anyone, otherwise it must either
-     *   be the session owner or UIDs granted access to this session.
+     *  Retrieves the value of a SessionObject property.  The caller is
+     *  responsible for the access control check.
      *
-     * @param conn           D-Bus connection this event occurred on
-     * @param sender         D-Bus bus name of the requester
-     * @param obj_path       D-Bus object path to the object being requested
-     * @param intf_name      D-Bus interface of the property being accessed
      * @param property_name  The property name being accessed
      * @param error          A GLib2 GError object if an error occurs
      *
      * @return  Returns a GVariant Glib2 object containing the value of the
-     *          requested D-Bus object property.  On errors, NULL must be
-     *          returned and the error must be returned via a GError
-     *          object.
+     *          requested property or NULL on errors.
      */
-    GVariant * callback_get_property(GDBusConnection *conn,
-                                     const std::string sender,
-                                     const std::string obj_path,
-                                     const std::string intf_name,
-                                     const std::string property_name,
-                                     GError **error)
+    GVariant * get_property_value(const std::string& property_name,
+                                  GError **error)
     {
+        GVariant *ret = NULL;
         if ("owner" == property_name)
         {
-            return GetOwner();
-        }
-
-        try
-        {
-            CheckACL(sender);
+            ret = GetOwner();
         }
-        catch (DBusCredentialsException& excp)
-        {
-            LogWarn(excp.err());
-            excp.SetDBusError(error, G_IO_ERROR, G_IO_ERROR_FAILED);
-            return NULL;
-        }
-
-
-        /*
-          std::cout << "[SessionObject] get_property(): "
-                  << "sender=" << sender
-                  << ", object_path=" << obj_path
-                  << ", interface=" << intf_name
-                  << ", property=" << property_name
-                  << std::endl;
-        */
-        GVariant *ret = NULL;
-        if ("receive_log_events" == property_name)
+        else if ("receive_log_events" == property_name)
         {
             ret = g_variant_new_boolean (recv_log_events);
         }
@@ -971,9 +2489,22 @@ public:
         else if ("status" == property_name)
         {
             ret = NULL;
-            if (nullptr != sig_statuschg)
+            if (backend_starting)
+            {
+                GVariantBuilder bld;
+                g_variant_builder_init(&bld, G_VARIANT_TYPE("a{sv}"));
+                g_variant_builder_add(&bld, "{sv}", "major",
+                                      g_variant_new_uint32((guint32) StatusMajor::SESSION));
+                g_variant_builder_add(&bld, "{sv}", "minor",
+                                      g_variant_new_uint32((guint32) StatusMinor::PROC_STARTING));
+                g_variant_builder_add(&bld, "{sv}", "status_message",
+                                      g_variant_new_string(""));
+                ret = g_variant_builder_end(&bld);
+            }
+            else if (nullptr != sig_statuschg)
             {
-                update_last_status();
+                // Kept up-to-date by the StatusChange signals from the
+                // backend; changes are announced via PropertiesChanged
                 ret = sig_statuschg->GetLastStatusChange();
             }
             if (NULL == ret)
@@ -984,384 +2515,752 @@ public:
         }
         else if ("statistics" == property_name)
         {
-            try
+            // Kept up-to-date by the PropertiesChanged signals from the
+            // backend, which avoids a blocking call to the backend.  If
+            // the last values may be outdated, fresh ones are requested
+            // and announced via PropertiesChanged once they arrive.
+            bool refresh = false;
+            {
+                std::lock_guard<std::mutex> lg(statistics_guard);
+                if (last_statistics)
+                {
+                    ret = g_variant_ref(last_statistics);
+                }
+                refresh = (!last_statistics
+                           || (std::chrono::steady_clock::now() - last_statistics_time
+                               > statistics_max_age));
+            }
+            if (refresh)
+            {
+                refresh_statistics();
+            }
+            if (NULL == ret)
+            {
+                g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_NO_REPLY,
+                            "No connection statistics available yet");
+            }
+        }
+        else if ("config_path" == property_name)
+        {
+            ret = g_variant_new_string (config_path.c_str());
+        }
+        else if ("backend_pid" == property_name)
+        {
+            ret = g_variant_new_uint32 (backend_pid);
+        }
+        else if ("log_verbosity" == property_name)
+        {
+            ret = g_variant_new_uint32 (GetLogLevel());
+        }
+        else if ("public_access" == property_name)
+        {
+            ret = GetPublicAccess();
+        }
+        else if ("acl" == property_name)
+        {
+            ret = GetAccessList();
+        }
+        else
+        {
+            g_set_error(error,
+                        G_IO_ERROR,
+                        G_IO_ERROR_FAILED,
+                        "Unknown property");
+        }
+
+        return ret;
+    }
+
+
+    /**
+     *  Ties the VPN client backend process to this SessionObject.  Once that
+     *  is done, it calls the RegistrationConfirmation method in the backend
+     *  process where it confirms the backend token and provides the
+     *  VPN configuration D-Bus object path to the backend.
+     */
+    void register_backend()
+    {
+        try
+        {
+            std::shared_ptr<DBusProxy> prx;
+            if (be_p2p)
+            {
+                prx.reset(new DBusProxy(be_conn, "",
+                                        OpenVPN3DBus_interf_backends,
+                                        be_path));
+            }
+            else
+            {
+                prx.reset(new DBusProxy(G_BUS_TYPE_SYSTEM,
+                                        be_busname,
+                                        OpenVPN3DBus_interf_backends,
+                                        be_path));
+            }
+            // Don't try to auto start backend services over D-Bus,
+            // The backend service should exists _before_ we try to
+            // communicate with it.
+            prx->SetGDBusCallFlags(G_DBUS_CALL_FLAGS_NO_AUTO_START);
             {
-                ret = be_proxy->GetProperty("statistics");
+                std::lock_guard<std::mutex> lg(be_proxy_guard);
+                be_proxy = prx;
+            }
+            ping_backend();
+
+            // Setup signal listeneres from the backend process
+            // FIXME: Verify how this is related to the subscrition in the caller function
+            sig_statuschg = new SessionStatusChange(sigrouter.GetConnection(),
+                                                    be_conn,
+                                                    be_sender(),
+                                                    OpenVPN3DBus_interf_backends,
+                                                    be_path,
+                                                    GetObjectPath());
+
+            GVariant *res_g = prx->Call("RegistrationConfirmation",
+                                             g_variant_new("(so)",
+                                                           backend_token.c_str(),
+                                                           config_path.c_str()));
+            if (NULL == res_g) {
+                THROW_DBUSEXCEPTION("SessionObject",
+                                    "Failed to extract the result of the "
+                                    "RegistrationConfirmation response");
             }
-            catch (DBusException& exp)
+            g_variant_get(res_g, "(b)", &registered);
+            if (!registered)
             {
-                g_set_error(error, G_DBUS_ERROR, G_IO_ERROR_FAILED,
-                            "Failed retrieving connection statistics");
-                ret = NULL;
+                // FIXME: Find a way to gracefully handle failed registration
+                return;
             }
+            Debug("New session registered: " + GetObjectPath());
+
+            // Status changes the backend sent before the subscription
+            // was in place would otherwise be missed
+            update_last_status();
+            refresh_statistics();
+            StatusChange(StatusMajor::SESSION, StatusMinor::SESS_NEW,
+                         "session_path=" + GetObjectPath()
+                         + " backend_busname=" + be_busname
+                         + " backend_path=" + be_path);
         }
-        else if ("config_path" == property_name)
-        {
-            ret = g_variant_new_string (config_path.c_str());
-        }
-        else if ("backend_pid" == property_name)
+        catch (DBusException& err)
         {
-            ret = g_variant_new_uint32 (backend_pid);
+            THROW_DBUSEXCEPTION("SessionObject", err.what());
         }
-        else if ("log_verbosity" == property_name)
+    }
+
+
+    /**
+     * Simple ping-pong game between this SessionObject and its VPN client
+     * backend, used when the backend registers.  Later on, the backend
+     * liveness is tracked passively.
+     *
+     * @return  Returns True if the backend process is alive, otherwise False.
+     */
+    bool ping_backend()
+    {
+        std::shared_ptr<DBusProxy> prx = backend_proxy();
+        if (!prx)
         {
-            ret = g_variant_new_uint32 (GetLogLevel());
+            THROW_DBUSEXCEPTION("SessionObject",
+                                "No backend proxy connection established, "
+                                "cannot ping backend");
         }
-        else if ("public_access" == property_name)
-        {
-            ret = GetPublicAccess();
+
+        GVariant *res_g = NULL;
+        try {
+            res_g = prx->Call("Ping");
         }
-        else if ("acl" == property_name)
+        catch (DBusException &dbserr)
         {
-            ret = GetAccessList();
+            res_g = NULL;
+            Debug(be_busname, be_path, backend_pid, std::string(dbserr.what()));
         }
-        else
+        if (NULL == res_g)
         {
-            g_set_error(error,
-                        G_IO_ERROR,
-                        G_IO_ERROR_FAILED,
-                        "Unknown property");
+            THROW_DBUSEXCEPTION("SessionObject",
+                                "VPN backend process unavailable, "
+                                "cannot register session");
         }
 
+        bool ret = false;
+        g_variant_get(res_g, "(b)", &ret);
+        g_variant_unref(res_g);
         return ret;
-    };
+    }
 
 
     /**
-     *  Callback method which is used each time a SessionObject property
-     *  is being modified over the D-Bus.
-     *
-     * @param conn           D-Bus connection this event occurred on
-     * @param sender         D-Bus bus name of the requester
-     * @param obj_path       D-Bus object path to the object being requested
-     * @param intf_name      D-Bus interface of the property being accessed
-     * @param property_name  The property name being accessed
-     * @param value          GVariant object containing the value to be stored
-     * @param error          A GLib2 GError object if an error occurs
-     *
-     * @return Returns a GVariantBuilder object which will be used by the
-     *         D-Bus library to issue the required PropertiesChanged signal.
-     *         If an error occurres, the DBusPropertyException is thrown.
+     * Fetches the last backend status and compares to what we have
+     * registered.  If there is a mismatch, we might have missed a signal -
+     * so register it and send it again.  This is only needed when the
+     * backend registers; later on the StatusChange signals keeps the
+     * status up-to-date.
      */
-    GVariantBuilder * callback_set_property(GDBusConnection *conn,
-                                            const std::string sender,
-                                            const std::string obj_path,
-                                            const std::string intf_name,
-                                            const std::string property_name,
-                                            GVariant *value,
-                                            GError **error)
+    void update_last_status()
     {
-        /*
-          std::cout << "[SessionObject] set_property(): "
-                  << "sender=" << sender
-                  << ", object_path=" << obj_path
-                  << ", interface=" << intf_name
-                  << ", property=" << property_name
-                  << std::endl;
-        */
+        std::shared_ptr<DBusProxy> prx = backend_proxy();
+        if (!sig_statuschg || !prx)
+        {
+            return;
+        }
+
         try
         {
-            CheckOwnerAccess(sender);
+            GVariant *be_status = nullptr;
+            be_status = prx->GetProperty("status");
+            if (!sig_statuschg->CompareStatus(be_status))
+            {
+                sig_statuschg->ProxyStatusDict(be_status);
+            }
         }
-        catch (DBusCredentialsException& excp)
+        catch (DBusException& excp)
         {
-            LogWarn(excp.err());
-            throw DBusPropertyException(G_IO_ERROR, G_IO_ERROR_FAILED,
-                                        obj_path, intf_name, property_name,
-                                        excp.getUserError());
+            // Ignore these failures for now.  It most commonly means
+            // the backend process has closed/shut-down - this is scenario
+            // is handled elsewhere in the call chain.
+
+            // TODO: Consider to set the local status to PROC_KILLED or
+            // something similar.
         }
+    }
 
-        try
+
+    /**
+     *  Initiate a shutdown of the VPN client backend process.  This does
+     *  not wait for the backend process to stop; the status change is
+     *  sent and the session object is removed from the main loop once it
+     *  has stopped.
+     *
+     * @param forced             If set to True, it will not do a normal
+     *                           disconnect but tell the backend process
+     *                           to stop more abruptly.
+     * @param selfdestruct_flag  If set to True, this D-Bus session object
+     *                           will be destroyed.  If not, it needs to
+     *                           be removed later on independently.  Used to
+     *                           allow front-ends to retrieve the last sent
+     *                           status message, which can be AUTH_FAILED.
+     */
+    void shutdown(bool forced, bool selfdestruct_flag)
+    {
         {
-            if (("receive_log_events" == property_name) && be_conn)
+            std::lock_guard<std::mutex> lg(shutdown_guard);
+            if (shutdown_pending)
             {
-                recv_log_events = g_variant_get_boolean(value);
-                if (recv_log_events && nullptr == sig_logevent)
-                {
-                    // Subscribe to log signals
-                    sig_logevent = new SessionLogEvent(
-                                    be_conn,
-                                    be_busname,
-                                    OpenVPN3DBus_interf_backends,
-                                    be_path,
-                                    GetObjectPath());
-                    sig_logevent->SetLogLevel(default_session_log_level);
-                }
-                else if (!recv_log_events && nullptr != sig_logevent)
-                {
-                    delete sig_logevent;
-                    sig_logevent = nullptr;
-                }
-                return build_set_property_response(property_name, recv_log_events);
+                return;
             }
-            else if (("log_verbosity" == property_name) && be_conn && sig_logevent)
-            {
-                unsigned int log_verb = g_variant_get_uint32(value);
-                sig_logevent->SetLogLevel(log_verb);
-                SetLogLevel(log_verb);
+            shutdown_pending = true;
+            shutdown_forced = forced;
+            shutdown_selfdestruct = selfdestruct_flag;
+            shutdown_escalated = false;
+        }
 
-                // FIXME: Proxy log level to the OpenVPN3 Core client
-                return build_set_property_response(property_name,
-                                                   (guint32) log_verb);
-            }
-            else if (("public_access" == property_name) && conn)
+        // The request is not waited for.  A hung backend could otherwise
+        // block this call until it times out; the escalation timer
+        // armed below handles a backend which does not stop.
+        try
+        {
+            std::shared_ptr<DBusProxy> prx = backend_proxy();
+            if (prx)
             {
-                bool acl_public = g_variant_get_boolean(value);
-                SetPublicAccess(acl_public);
-                LogInfo("Public access set to "
-                         + (acl_public ? std::string("true") :
-                                         std::string("false"))
-                         + " by uid " + std::to_string(GetUID(sender)));
-                return build_set_property_response(property_name, acl_public);
+                prx->CallAsync((!forced ? "Disconnect" : "ForceShutdown"),
+                               NULL, nullptr);
             }
         }
         catch (DBusException& excp)
         {
-            throw DBusPropertyException(G_IO_ERROR, G_IO_ERROR_FAILED,
-                                        obj_path, intf_name, property_name,
-                                        excp.what());
+            LogWarn("Failed requesting the backend process to stop: "
+                    + excp.getRawError());
         }
-        throw DBusPropertyException(G_IO_ERROR, G_IO_ERROR_FAILED,
-                                    obj_path, intf_name, property_name,
-                                    "Invalid property");
+
+        // The shutdown completes when the backend process is seen
+        // stopping, which is followed from the main loop
+        g_main_context_invoke_full(NULL, G_PRIORITY_DEFAULT,
+                                   shutdown_wait_start,
+                                   new std::shared_ptr<CallbackGuard>(callback_guard),
+                                   callback_guard_free);
     }
 
 
     /**
-     *  Clean-up function triggered by the D-Bus library when an object
-     *  is removed from the D-Bus
+     *  Starts waiting for the backend process to stop after a shutdown
+     *  request.  The wait completes when the backend liveness tracking
+     *  sees the backend process exiting.  If the backend does not stop
+     *  in time, a Disconnect is escalated to ForceShutdown and then to
+     *  killing the process.
+     *
+     *  This runs in the main loop with the callback guard held.
      */
-    void callback_destructor ()
+    void shutdown_wait()
     {
-        if( nullptr != sig_statuschg)
+        if (!backend_alive)
         {
-            delete sig_statuschg;
-            sig_statuschg = nullptr;
+            shutdown_completed(false);
+            return;
         }
 
-        if (nullptr != sig_logevent)
+        bool forced;
         {
-            delete sig_logevent;
-            sig_logevent = nullptr;
+            std::lock_guard<std::mutex> lg(shutdown_guard);
+            forced = shutdown_forced;
         }
-    };
+        shutdown_arm_timer(forced ? shutdown_kill_timeout : shutdown_timeout);
+    }
 
 
-private:
-    unsigned int default_session_log_level = 4; // LogCategory::INFO messages
-    std::function<void()> remove_callback;
-    DBusProxy *be_proxy;
-    bool recv_log_events;
-    std::time_t session_created;
-    std::string config_path;
-    SessionStatusChange *sig_statuschg;
-    SessionLogEvent *sig_logevent;
-    std::string backend_token;
-    pid_t backend_pid;
-    GDBusConnection *be_conn;
-    std::string be_busname;
-    std::string be_path;
-    bool registered;
-    bool selfdestruct_complete;
-    std::mutex selfdestruct_guard;
+    /**
+     *  Arms the timer escalating a shutdown request.  The caller must
+     *  hold the callback guard.
+     *
+     * @param timeout  Seconds to wait for the backend process to stop
+     */
+    void shutdown_arm_timer(guint timeout)
+    {
+        shutdown_timer = g_timeout_add_seconds_full(G_PRIORITY_DEFAULT,
+                                                    timeout,
+                                                    shutdown_timed_out,
+                                                    new std::shared_ptr<CallbackGuard>(callback_guard),
+                                                    callback_guard_free);
+    }
 
 
     /**
-     *  Ties the VPN client backend process to this SessionObject.  Once that
-     *  is done, it calls the RegistrationConfirmation method in the backend
-     *  process where it confirms the backend token and provides the
-     *  VPN configuration D-Bus object path to the backend.
+     *  Escalates a shutdown request the backend did not complete in time.
+     *  Runs in the main loop with the callback guard held.
      */
-    void register_backend()
+    void shutdown_escalate()
     {
+        bool escalate_force = false;
+        {
+            std::lock_guard<std::mutex> lg(shutdown_guard);
+            if (!shutdown_forced && !shutdown_escalated)
+            {
+                shutdown_escalated = true;
+                escalate_force = true;
+            }
+        }
+
+        if (escalate_force)
+        {
+            LogWarn("Backend process did not disconnect in time, "
+                    "forcing shutdown");
+            try
+            {
+                std::shared_ptr<DBusProxy> prx = backend_proxy();
+                if (prx)
+                {
+                    prx->CallAsync("ForceShutdown", NULL, nullptr);
+                }
+            }
+            catch (DBusException& excp)
+            {
+                // The kill timeout below catches this
+            }
+            shutdown_arm_timer(shutdown_kill_timeout);
+            return;
+        }
+
+        // Killing a backend process hosting other sessions would take
+        // those sessions down as well; this session is then considered
+        // lost instead
+        if (backend_hosts_others())
+        {
+            LogError("Backend process did not stop this session, "
+                     "which is hosted with other sessions; "
+                     "considering the session lost");
+            shutdown_completed(true, true);
+            return;
+        }
+
+        // The backend process runs with other privileges than the
+        // session manager, so openvpn3-service-backendstart kills it
+        LogError("Backend process did not stop, killing it");
         try
         {
-            be_proxy = new DBusProxy(G_BUS_TYPE_SYSTEM,
-                                     be_busname,
-                                     OpenVPN3DBus_interf_backends,
-                                     be_path);
-            // Don't try to auto start backend services over D-Bus,
-            // The backend service should exists _before_ we try to
-            // communicate with it.
-            be_proxy->SetGDBusCallFlags(G_DBUS_CALL_FLAGS_NO_AUTO_START);
-            ping_backend();
+            DBusProxy backend_start(G_BUS_TYPE_SYSTEM,
+                                    OpenVPN3DBus_name_backends,
+                                    OpenVPN3DBus_interf_backends,
+                                    OpenVPN3DBus_rootp_backends);
+            backend_start.CallAsync("KillClient",
+                                    g_variant_new("(s)", be_busname.c_str()),
+                                    nullptr);
+        }
+        catch (DBusException& excp)
+        {
+            LogError("Could not kill the backend process: "
+                     + excp.getRawError());
+        }
+        shutdown_completed(true);
+    }
 
-            // Setup signal listeneres from the backend process
-            // FIXME: Verify how this is related to the subscrition in the caller function
-            sig_statuschg = new SessionStatusChange(be_conn,
-                                                    be_busname,
-                                                    OpenVPN3DBus_interf_backends,
-                                                    be_path,
-                                                    GetObjectPath());
 
-            GVariant *res_g = be_proxy->Call("RegistrationConfirmation",
-                                             g_variant_new("(so)",
-                                                           backend_token.c_str(),
-                                                           config_path.c_str()));
-            if (NULL == res_g) {
-                THROW_DBUSEXCEPTION("SessionObject",
-                                    "Failed to extract the result of the "
-                                    "RegistrationConfirmation response");
-            }
-            g_variant_get(res_g, "(b)", &registered);
-            if (!registered)
+    /**
+     *  Completes a shutdown request, once the backend process has stopped
+     *  or was killed.  Runs in the main loop with the callback guard held.
+     *
+     * @param killed  Set to true if the backend process had to be killed
+     * @param lost    Set to true if the backend process did not stop the
+     *                session but could not be killed either, as it hosts
+     *                other sessions
+     */
+    void shutdown_completed(bool killed, bool lost = false)
+    {
+        shutdown_wait_cleanup();
+
+        bool forced;
+        bool do_selfdestruct;
+        {
+            std::lock_guard<std::mutex> lg(shutdown_guard);
+            if (!shutdown_pending)
             {
-                // FIXME: Find a way to gracefully handle failed registration
                 return;
             }
-            Debug("New session registered: " + GetObjectPath());
-            StatusChange(StatusMajor::SESSION, StatusMinor::SESS_NEW,
-                         "session_path=" + GetObjectPath()
-                         + " backend_busname=" + be_busname
-                         + " backend_path=" + be_path);
+            // A later shutdown request may retry, if this object is kept
+            shutdown_pending = false;
+            forced = shutdown_forced;
+            do_selfdestruct = shutdown_selfdestruct;
+        }
+
+        // Remove this session object
+        if (!forced && !killed)
+        {
+            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_STOPPED, "Session closed");
         }
-        catch (DBusException& err)
+        else if (lost)
         {
-            THROW_DBUSEXCEPTION("SessionObject", err.what());
+            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Session lost, backend client did not stop it");
+        }
+        else
+        {
+            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Session closed, killed backend client");
+        }
+
+        if (do_selfdestruct)
+        {
+            selfdestruct();
         }
     }
 
 
     /**
-     * Simple ping-pong game between this SessionObject and its VPN client
-     * backend.  If the backend does not respond, we treat it as dead and will
-     * start to clean-up this session.
-     *
-     * @return  Returns True if the backend process is alive, otherwise False.
+     *  Removes the timer escalating a shutdown request.  The caller must
+     *  hold the callback guard.
      */
-    bool ping_backend()
+    void shutdown_wait_cleanup()
     {
-        if (nullptr == be_proxy)
+        if (0 != shutdown_timer)
         {
-            THROW_DBUSEXCEPTION("SessionObject",
-                                "No backend proxy connection established, "
-                                "cannot ping backend");
+            g_source_remove(shutdown_timer);
+            shutdown_timer = 0;
         }
+    }
 
-        GVariant *res_g = NULL;
-        try {
-            res_g = be_proxy->Call("Ping");
+
+    /**
+     *  Starts following the backend process passively once it has
+     *  registered, instead of pinging it before each request.  The
+     *  backend is considered gone when its bus name vanishes, when a
+     *  pidfd reports the process has exited or when the backend
+     *  announces it is stopping via ProcessChange.
+     *
+     * @param sender  Unique bus name of the backend, empty if it
+     *                registered over a private connection
+     */
+    void start_liveness_tracking(const std::string& sender)
+    {
+        std::lock_guard<std::recursive_mutex> lg(callback_guard->lock);
+        backend_alive = true;
+
+        // A unique bus name is never taken over by another process.  A
+        // backend on a private connection still owns its well-known
+        // bus name, which is then used.
+        be_name_watch = g_bus_watch_name_on_connection(sigrouter.GetConnection(),
+                                                       (sender.empty() ? be_busname : sender).c_str(),
+                                                       G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                       backend_name_appeared,
+                                                       backend_name_vanished,
+                                                       new std::shared_ptr<CallbackGuard>(callback_guard),
+                                                       callback_guard_free);
+
+        // The PID from StartClient belongs to a process which has forked
+        // again, so the PID is looked up from the backend's connection
+        pid_t pid = -1;
+        if (be_p2p)
+        {
+            GCredentials *cred = g_dbus_connection_get_peer_credentials(be_conn);
+            if (cred)
+            {
+                pid = g_credentials_get_unix_pid(cred, NULL);
+            }
         }
-        catch (DBusException &dbserr)
+        else
         {
-            res_g = NULL;
-            Debug(be_busname, be_path, backend_pid, std::string(dbserr.what()));
+            try
+            {
+                DBusConnectionCreds creds(sigrouter.GetConnection());
+                pid = creds.GetPID(sender);
+            }
+            catch (DBusException& excp)
+            {
+                pid = -1;
+            }
         }
-        if (NULL == res_g)
+        if (pid <= 0)
         {
-            THROW_DBUSEXCEPTION("SessionObject",
-                                "VPN backend process unavailable, "
-                                "cannot register session");
+            return;
         }
+        backend_pid = pid;
 
-        bool ret = false;
-        g_variant_get(res_g, "(b)", &ret);
-        g_variant_unref(res_g);
-        return ret;
+        // pidfds are only available on Linux 5.3 and newer; the bus name
+        // watch is sufficient without it
+        be_pidfd = syscall(SYS_pidfd_open, pid, 0);
+        if (be_pidfd < 0)
+        {
+            Debug("Backend process is not watched via a pidfd: "
+                  + std::string(strerror(errno)));
+            return;
+        }
+        be_pidfd_source = g_unix_fd_add_full(G_PRIORITY_DEFAULT, be_pidfd,
+                                             G_IO_IN,
+                                             backend_pidfd_ready,
+                                             new std::shared_ptr<CallbackGuard>(callback_guard),
+                                             callback_guard_free);
     }
 
 
     /**
-     * Fetches the last backend status and compares to what we have
-     * registered.  If there is a mismatch, we might have missed a signal -
-     * so register it and send it again.
+     *  Removes the bus name watch, pidfd and signal route following the
+     *  backend process.  The caller must hold the callback guard.
      */
-    void update_last_status()
+    void stop_liveness_tracking()
     {
-        if (!sig_statuschg)
+        if (0 != be_name_watch)
         {
-            return;
+            g_bus_unwatch_name(be_name_watch);
+            be_name_watch = 0;
         }
-
-        try
+        if (0 != be_pidfd_source)
         {
-            GVariant *be_status = nullptr;
-            be_status = be_proxy->GetProperty("status");
-            if (!sig_statuschg->CompareStatus(be_status))
-            {
-                sig_statuschg->ProxyStatusDict(be_status);
-            }
+            g_source_remove(be_pidfd_source);
+            be_pidfd_source = 0;
         }
-        catch (DBusException& excp)
+        if (be_pidfd >= 0)
         {
-            // Ignore these failures for now.  It most commonly means
-            // the backend process has closed/shut-down - this is scenario
-            // is handled elsewhere in the call chain.
-
-            // TODO: Consider to set the local status to PROC_KILLED or
-            // something similar.
+            close(be_pidfd);
+            be_pidfd = -1;
+        }
+        if (0 != procchg_route)
+        {
+            sigrouter.Unsubscribe(procchg_route);
+            procchg_route = 0;
         }
     }
 
 
     /**
-     *  Initiate a shutdown of the VPN client backend process.
-     *
-     * @param forced             If set to True, it will not do a normal
-     *                           disconnect but tell the backend process
-     *                           to stop more abruptly.
-     * @param selfdestruct_flag  If set to True, this D-Bus session object
-     *                           will be destroyed.  If not, it needs to
-     *                           be removed later on independently.  Used to
-     *                           allow front-ends to retrieve the last sent
-     *                           status message, which can be AUTH_FAILED.
+     *  Called when the backend process is seen exiting.  Requests to this
+     *  session will fail from now on, and a pending shutdown completes.
+     *  Runs in the main loop with the callback guard held.
      */
-    void shutdown(bool forced, bool selfdestruct_flag)
+    void backend_exited()
     {
-        be_proxy->Call( (!forced ? "Disconnect" : "ForceShutdown"), true );
-        // Wait for child to exit
-        sleep(2); // FIXME: Catch the ProcessChange StatusMinor::PROC_STOPPED signal from backend
+        backend_alive = false;
+        stop_liveness_tracking();
 
-        // Remove this session object
-        if (!forced)
+        bool pending;
         {
-            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_STOPPED, "Session closed");
+            std::lock_guard<std::mutex> lg(shutdown_guard);
+            pending = shutdown_pending;
         }
-        else
+        if (pending)
         {
-            StatusChange(StatusMajor::SESSION, StatusMinor::PROC_KILLED, "Session closed, killed backend client");
+            shutdown_completed(false);
+        }
+    }
+
+
+    /*
+     *  C wrappers for the main loop sources and bus name watches following
+     *  the backend process.  Each carries a reference to the callback
+     *  guard as user data.
+     */
+    static void callback_guard_free(gpointer data)
+    {
+        delete (std::shared_ptr<CallbackGuard> *) data;
+    }
+
+
+    static gboolean shutdown_wait_start(gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        if (nullptr != guard->session)
+        {
+            guard->session->shutdown_wait();
         }
+        return G_SOURCE_REMOVE;
+    }
+
+
+    static void backend_name_appeared(GDBusConnection *conn,
+                                      const gchar *name,
+                                      const gchar *name_owner,
+                                      gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        SessionObject *self = guard->session;
+        if (nullptr != self && 0 == self->procchg_route)
+        {
+            // ProcessChange is sent over the bus, also by backends
+            // using a private connection
+            self->procchg_route = self->sigrouter.Subscribe(OpenVPN3DBus_interf_backends,
+                                                            "ProcessChange",
+                                                            name_owner,
+                                                            self->be_path,
+                                                            self->signal_handler());
+        }
+    }
+
+
+    static void backend_name_vanished(GDBusConnection *conn,
+                                      const gchar *name,
+                                      gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        if (nullptr != guard->session)
+        {
+            guard->session->backend_exited();
+        }
+    }
+
+
+    static gboolean backend_pidfd_ready(gint fd, GIOCondition cond,
+                                        gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        if (nullptr != guard->session)
+        {
+            // This source is removed when returning
+            guard->session->be_pidfd_source = 0;
+            guard->session->backend_exited();
+        }
+        return G_SOURCE_REMOVE;
+    }
+
 
-        if (selfdestruct_flag)
+    static gboolean shutdown_timed_out(gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        if (nullptr != guard->session)
         {
-            selfdestruct(DBusSignalSubscription::GetConnection());
+            // This timer source is removed when returning
+            guard->session->shutdown_timer = 0;
+            guard->session->shutdown_escalate();
         }
+        return G_SOURCE_REMOVE;
     }
 
 
     /**
-     *  This method is dangerous and should only be used by either the
-     *  SessionObject::shutdown() method or exception handlers in the
-     *  SessionObject.
+     *  Retrieve the proxy to the VPN client backend process.  Worker
+     *  threads running method calls must use this instead of accessing
+     *  be_proxy directly.
      *
-     *  This will initiate deleting this SessionObject from the D-Bus and then
-     *  destroy itself.
+     * @return Returns a std::shared_ptr<DBusProxy>, which is empty until
+     *         the backend process has registered
+     */
+    std::shared_ptr<DBusProxy> backend_proxy()
+    {
+        std::lock_guard<std::mutex> lg(be_proxy_guard);
+        return be_proxy;
+    }
+
+
+    /**
+     *  Removes this SessionObject from the D-Bus and destroys it.  This
+     *  should only be used by the shutdown handling or exception handlers
+     *  in the SessionObject.
      *
-     * @param conn  D-Bus connection to use when removing this object from
-     *              the D-Bus.
+     *  This may be called from any thread, also several times; only the
+     *  first call is handled.  The object is removed from the D-Bus in
+     *  the main loop, and is deleted from the main loop once no method
+     *  call is running on a worker thread any more.  The object is
+     *  accessible until then, so the caller may still use it after this
+     *  returns.
      */
-    void selfdestruct(GDBusConnection *conn)
+    void selfdestruct()
     {
-        // Object may still be available via other threads for a short
-        // while, which can cause havoc if not handled properly.  There
-        // are a few call-chains when the backend client process dies which
-        // may call selfdestruct() a couple of times at the almost the same
-        // time.  So we add a lock here, to ensure only the first
-        // selfdestruct() event is handled.  After this first call have
-        // completed, this object is to be considered dead.
-        //
-        // !! WARNING: ONLY EXCEPTION HANDLERS AND shutdown()  !!
-        // !! WARNING:       MAY CALL THIS FUNCTION!           !!
-        //
-        std::lock_guard<std::mutex> guard(selfdestruct_guard);
-        if (selfdestruct_complete)
+        if (selfdestruct_requested.exchange(true))
         {
             return;
         }
-        RemoveObject(conn);
-        selfdestruct_complete = true;
+        g_main_context_invoke_full(NULL, G_PRIORITY_DEFAULT,
+                                   selfdestruct_remove,
+                                   new std::shared_ptr<CallbackGuard>(callback_guard),
+                                   callback_guard_free);
+    }
+
+
+    /**
+     *  Removes this object from the D-Bus and schedules deleting it.  Runs
+     *  in the main loop with the callback guard held.
+     */
+    void selfdestruct_start()
+    {
+        unlist_session();
+
+        std::shared_ptr<CallbackGuard> guard = callback_guard;
+        RemoveObject(sigrouter.GetConnection(),
+                     [guard]()
+                     {
+                         // Always deferred, this may be called from
+                         // within RemoveObject()
+                         g_idle_add_full(G_PRIORITY_DEFAULT,
+                                         selfdestruct_delete,
+                                         new std::shared_ptr<CallbackGuard>(guard),
+                                         callback_guard_free);
+                     });
+    }
+
+
+    /**
+     *  Removes this session from the session manager's list of sessions.
+     *  Only the first call has any effect.
+     */
+    void unlist_session()
+    {
+        if (remove_callback)
+        {
+            std::function<void()> cb = std::move(remove_callback);
+            remove_callback = nullptr;
+            cb();
+        }
+    }
+
+
+    static gboolean selfdestruct_remove(gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        if (nullptr != guard->session)
+        {
+            guard->session->selfdestruct_start();
+        }
+        return G_SOURCE_REMOVE;
+    }
 
-        delete this;
+
+    static gboolean selfdestruct_delete(gpointer data)
+    {
+        std::shared_ptr<CallbackGuard> guard = *(std::shared_ptr<CallbackGuard> *) data;
+        std::lock_guard<std::recursive_mutex> lg(guard->lock);
+        if (nullptr != guard->session)
+        {
+            delete guard->session;
+        }
+        return G_SOURCE_REMOVE;
     }
 };
 
@@ -1390,23 +3289,47 @@ public:
         : DBusObject(objpath),
           SessionManagerSignals(dbuscon, objpath, manager_log_level),
           dbuscon(dbuscon),
-          creds(dbuscon)
+          creds(dbuscon),
+          objmgr(dbuscon, objpath),
+          async_pool(new DBusAsyncWorkerPool(async_workers)),
+          visibility(std::make_shared<DBusVisibilityIndex>()),
+          log_listeners(std::make_shared<DBusSignalProducer>(dbuscon, "",
+                                                             OpenVPN3DBus_interf_sessions,
+                                                             objpath))
     {
+        // Log listeners registered via AddLogListener are the only
+        // receivers of the signals sent through this
+        log_listeners->SetTargetedDelivery(true);
+
         std::stringstream introspection_xml;
         introspection_xml << "<node name='" << objpath << "'>"
                           << "    <interface name='" << OpenVPN3DBus_interf_sessions << "'>"
-                          << "        <method name='NewTunnel'>"
-                          << "          <arg type='o' name='config_path' direction='in'/>"
-                          << "          <arg type='o' name='session_path' direction='out'/>"
-                          << "        </method>"
-                          << "        <method name='FetchAvailableSessions'>"
-                          << "          <arg type='ao' name='paths' direction='out'/>"
-                          << "        </method>"
+                          << method_table().GetIntrospection(OpenVPN3DBus_interf_sessions)
                           << GetLogIntrospection()
                           << "    </interface>"
+                          << DBusObjectManager::GetIntrospection()
+                          << DBusMethodStats::GetIntrospection()
                           << "</node>";
         ParseIntrospectionXML(introspection_xml);
 
+        // VPN client backends registers over a private connection to
+        // this process when possible, which keeps the backend traffic
+        // away from the D-Bus daemon.  If this fails, the backends will
+        // communicate over the bus instead.
+        try
+        {
+            p2p_server.reset(new DBusP2PServer(OpenVPN3DBus_p2p_sessions,
+                                               OpenVPN3DBus_interf_backends,
+                                               "RegistrationRequest", 1));
+            p2p_server->Start();
+        }
+        catch (DBusException& excp)
+        {
+            p2p_server.reset();
+            LogWarn("Backend connections will go through the D-Bus daemon: "
+                    + std::string(excp.getRawError()));
+        }
+
         Debug("SessionManagerObject registered on '" + OpenVPN3DBus_interf_sessions + "': "
                       + objpath);
     }
@@ -1427,9 +3350,55 @@ public:
         SessionManagerSignals::OpenLogFile(filename);
     }
 
+
+    /**
+     *  Registers new session objects through a single D-Bus subtree
+     *  registration below the session manager object path, instead of
+     *  one registration per session object.  Session objects created
+     *  before this call are not affected.
+     */
+    void EnableSubtreeRegistration()
+    {
+        session_subtree.reset(new DBusObjectSubtree(dbuscon, GetObjectPath()));
+        session_subtree->Register();
+    }
+
+
+    /**
+     *  Keeps a pool of idle VPN client backends started in advance,
+     *  which new sessions take over instead of starting a new backend.
+     *
+     * @param size        Number of idle backends to keep
+     * @param min_memory  Megabytes of memory which must be available on
+     *                    the system to start another idle backend
+     */
+    void EnableBackendPool(unsigned int size, unsigned int min_memory)
+    {
+        backend_pool = std::make_shared<BackendPool>(dbuscon, GetObjectPath(),
+                                                     GetLogLevel(), p2p_server,
+                                                     size, min_memory);
+        backend_pool->Start();
+    }
+
     /**
      *  Callback method called each time a method in the SessionManagerObject
-     *  is called over the D-Bus.
+     *  is called over the D-Bus.  The method call is passed on to the
+     *  handler registered in the method table.
+     *
+     * @param call  DBusMethodCall with the method call arguments
+     *
+     * @return Returns false if the method is not found in the method table
+     */
+    bool callback_method_dispatch(const DBusMethodCall& call)
+    {
+        return method_table().Dispatch(this, call);
+    }
+
+
+    /**
+     *  Called for method calls not found in the method table.  GDBus
+     *  validates the method calls against the introspection data, so
+     *  this should normally not happen.
      *
      * @param conn       D-Bus connection where the method call occurred
      * @param sender     D-Bus bus name of the sender of the method call
@@ -1449,73 +3418,11 @@ public:
                               GVariant *params,
                               GDBusMethodInvocation *invoc)
     {
-        // std::cout << "SessionManagerObject::callback_method_call: " << method_name << std::endl;
-        if ("NewTunnel" == method_name)
-        {
-            IdleCheck_UpdateTimestamp();
-
-            // Retrieve the configuration path for the tunnel
-            // from the request
-            gchar *config_path_s;
-            g_variant_get (params, "(o)", &config_path_s);
-            auto config_path = std::string(config_path_s);
-            g_free(config_path_s);
-
-            // Create session object, which will proxy calls
-            // from the front-end to the backend
-            std::string sesspath = generate_path_uuid(OpenVPN3DBus_rootp_sessions, 's');
-
-            // Create the new object and register it in D-Bus
-            auto callback = [self=Ptr(this), sesspath](void)
-                            {
-                                self->remove_session_object(sesspath);
-                            };
-            SessionObject *session = new SessionObject(conn,
-                                                       callback,
-                                                       creds.GetUID(sender),
-                                                       sesspath,
-                                                       config_path,
-                                                       GetLogLevel());
-            IdleCheck_RefInc();
-            session->IdleCheck_Register(IdleCheck_Get());
-            session->RegisterObject(conn);
-            session_objects[sesspath] = session;
-
-            // Return the path to the new session object object to the caller
-            // The backend object will remind "hidden" for the end-user
-            g_dbus_method_invocation_return_value(invoc, g_variant_new("(o)", sesspath.c_str()));
-        }
-        else if ("FetchAvailableSessions" == method_name)
-        {
-            // Build up an array of object paths to available session objects
-            GVariantBuilder *bld = g_variant_builder_new(G_VARIANT_TYPE("ao"));
-            for (auto& item : session_objects)
-            {
-                try {
-                    // We check if the caller is allowed to access this
-                    // session object.  If not, an exception is thrown
-                    // and we will just ignore that exception and continue
-                    item.second->CheckACL(sender);
-                    g_variant_builder_add(bld, "o", item.first.c_str());
-                }
-                catch (DBusCredentialsException& excp)
-                {
-                    // Ignore credentials exceptions.  It means the
-                    // caller does not have access this session object
-                }
-            }
-
-            // Wrap up the result into a tuple, which GDBus expects and
-            // put it into the invocation response
-            GVariantBuilder *ret = g_variant_builder_new(G_VARIANT_TYPE_TUPLE);
-            g_variant_builder_add_value(ret, g_variant_builder_end(bld));
-            g_dbus_method_invocation_return_value(invoc,
-                                                  g_variant_builder_end(ret));
-
-            // Clean-up
-            g_variant_builder_unref(bld);
-            g_variant_builder_unref(ret);
-        }
+        std::string errmsg = "No method named" + method_name + " is available";
+        GError *err = g_dbus_error_new_for_dbus_error("net.openvpn.v3.sessions.error",
+                                                      errmsg.c_str());
+        g_dbus_method_invocation_return_gerror(invoc, err);
+        g_error_free(err);
     };
 
 
@@ -1590,13 +3497,185 @@ public:
 
 
 private:
+    const unsigned int async_workers = 4;
     GDBusConnection *dbuscon;
     DBusConnectionCreds creds;
+    DBusObjectManager objmgr;
+    DBusAsyncWorkerPool::Ptr async_pool;
     std::map<std::string, SessionObject *> session_objects;
+    std::mutex session_objects_guard;
+    std::unique_ptr<DBusObjectSubtree> session_subtree;
+    std::shared_ptr<DBusP2PServer> p2p_server;
+    DBusVisibilityIndex::Ptr visibility;
+    std::shared_ptr<DBusSignalProducer> log_listeners;
+    BackendPool::Ptr backend_pool;
+
+
+    typedef DBusMethodTable<SessionManagerObject> MethodTable;
+
+
+    /**
+     *  The D-Bus methods of the SessionManagerObject with their handlers
+     *  and introspection data
+     */
+    static const MethodTable& method_table()
+    {
+        static const MethodTable table = build_method_table();
+        return table;
+    }
+
+
+    static MethodTable build_method_table()
+    {
+        const std::string intf(OpenVPN3DBus_interf_sessions);
+        MethodTable table;
+        table.Add(intf, "NewTunnel",
+                  "          <arg type='o' name='config_path' direction='in'/>"
+                  "          <arg type='o' name='session_path' direction='out'/>",
+                  &SessionManagerObject::method_new_tunnel)
+             .Add(intf, "FetchAvailableSessions",
+                  "          <arg type='ao' name='paths' direction='out'/>",
+                  &SessionManagerObject::method_fetch_available_sessions)
+             .Add(intf, "AddLogListener", "",
+                  &SessionManagerObject::method_add_log_listener);
+
+        // The introspection of this comes from DBusObjectManager
+        table.Add(DBusObjectManager_interf, "GetManagedObjects",
+                  &SessionManagerObject::method_get_managed_objects);
+        return table;
+    }
+
+
+    void method_new_tunnel(const DBusMethodCall& call)
+    {
+        IdleCheck_UpdateTimestamp();
+
+        // Retrieve the configuration path for the tunnel
+        // from the request
+        gchar *config_path_s;
+        g_variant_get (call.params, "(o)", &config_path_s);
+        auto config_path = std::string(config_path_s);
+        g_free(config_path_s);
+
+        // Create session object, which will proxy calls
+        // from the front-end to the backend
+        std::string sesspath = generate_path_uuid(OpenVPN3DBus_rootp_sessions, 's');
+
+        // Create the new object and register it in D-Bus
+        auto callback = [self=Ptr(this), sesspath](void)
+                        {
+                            self->remove_session_object(sesspath);
+                        };
+        uid_t owner = creds.GetUID(call.sender);
+        SessionObject *session = new SessionObject(call.conn,
+                                                   callback,
+                                                   owner,
+                                                   sesspath,
+                                                   config_path,
+                                                   GetLogLevel(),
+                                                   p2p_server);
+        IdleCheck_RefInc();
+        session->IdleCheck_Register(IdleCheck_Get());
+        session->EnableAsyncDispatch(async_pool);
+        session->SetVisibilityIndex(visibility, sesspath);
+        session->SetLogListeners(log_listeners);
+        if (session_subtree)
+        {
+            session_subtree->Add(session);
+        }
+        else
+        {
+            session->RegisterObject(call.conn);
+        }
+        {
+            std::lock_guard<std::mutex> lg(session_objects_guard);
+            session_objects[sesspath] = session;
+        }
+
+        // Only the publicly readable properties are announced
+        GVariantBuilder pubprops;
+        g_variant_builder_init(&pubprops, G_VARIANT_TYPE("a{sv}"));
+        g_variant_builder_add(&pubprops, "{sv}", "owner",
+                              g_variant_new_uint32(owner));
+        objmgr.InterfacesAdded(sesspath, OpenVPN3DBus_interf_sessions,
+                               g_variant_builder_end(&pubprops));
+
+        // Return the path to the new session object object to the caller
+        // The backend object will remind "hidden" for the end-user
+        g_dbus_method_invocation_return_value(call.invoc, g_variant_new("(o)", sesspath.c_str()));
+
+        // The backend process is started in the background; the session
+        // reports its progress through StatusChange signals.  The session
+        // object may be removed by this call if the start fails.
+        session->StartBackend(backend_pool);
+    }
+
+
+    void method_fetch_available_sessions(const DBusMethodCall& call)
+    {
+        // Build up an array of object paths to available session objects.
+        // The visibility index already knows which session objects the
+        // caller has access to.
+        GVariantBuilder *bld = g_variant_builder_new(G_VARIANT_TYPE("ao"));
+        for (auto& path : visibility->Lookup(creds.GetUID(call.sender)))
+        {
+            g_variant_builder_add(bld, "o", path.c_str());
+        }
+
+        // Wrap up the result into a tuple, which GDBus expects and
+        // put it into the invocation response
+        GVariantBuilder *ret = g_variant_builder_new(G_VARIANT_TYPE_TUPLE);
+        g_variant_builder_add_value(ret, g_variant_builder_end(bld));
+        g_dbus_method_invocation_return_value(call.invoc,
+                                              g_variant_builder_end(ret));
+
+        // Clean-up
+        g_variant_builder_unref(bld);
+        g_variant_builder_unref(ret);
+    }
+
+
+    void method_add_log_listener(const DBusMethodCall& call)
+    {
+        // Log listeners receive the log events of all sessions, so only
+        // root and the user this service runs as may register one
+        uid_t uid = creds.GetUID(call.sender);
+        if (0 != uid && getuid() != uid)
+        {
+            DBusCredentialsException excp(uid, "net.openvpn.v3.error.acl.denied",
+                                          "Access denied");
+            LogWarn(excp.err());
+            excp.SetDBusError(call.invoc);
+            return;
+        }
+
+        // The listener is forgotten when it disconnects from the bus
+        log_listeners->AddTargetBusName(call.sender);
+        LogVerb2("Log listener registered: " + std::string(call.sender));
+        g_dbus_method_invocation_return_value(call.invoc, NULL);
+    }
+
+
+    void method_get_managed_objects(const DBusMethodCall& call)
+    {
+        // Returns all session objects the caller has access to,
+        // including all their properties
+        std::lock_guard<std::mutex> lg(session_objects_guard);
+        g_dbus_method_invocation_return_value(call.invoc,
+                                              objmgr.GetManagedObjects(call.conn, call.sender,
+                                                                       OpenVPN3DBus_interf_sessions,
+                                                                       session_objects));
+    }
+
 
     void remove_session_object(const std::string sesspath)
     {
-        session_objects.erase(sesspath);
+        // Session objects may be removed from a worker thread
+        {
+            std::lock_guard<std::mutex> lg(session_objects_guard);
+            session_objects.erase(sesspath);
+        }
+        objmgr.InterfacesRemoved(sesspath, OpenVPN3DBus_interf_sessions);
     }
 };
 
@@ -1661,6 +3740,33 @@ public:
     }
 
 
+    /**
+     *  Enables registering all session objects through a single D-Bus
+     *  subtree registration.  Must be called before Setup().
+     *
+     * @param enable  Bool flag enabling subtree registration
+     */
+    void SetSubtreeRegistration(bool enable)
+    {
+        subtree_registration = enable;
+    }
+
+
+    /**
+     *  Enables keeping a pool of idle VPN client backends started in
+     *  advance.  Must be called before Setup().
+     *
+     * @param size        Number of idle backends to keep, 0 disables it
+     * @param min_memory  Megabytes of memory which must be available on
+     *                    the system to start another idle backend
+     */
+    void SetBackendPool(unsigned int size, unsigned int min_memory)
+    {
+        backend_pool_size = size;
+        backend_pool_min_memory = min_memory;
+    }
+
+
     /**
      *  This callback is called when the service was successfully registered
      *  on the D-Bus.
@@ -1678,6 +3784,15 @@ public:
 
         // Register this object to on the D-Bus
         managobj->RegisterObject(GetConnection());
+        if (subtree_registration)
+        {
+            managobj->EnableSubtreeRegistration();
+        }
+        if (backend_pool_size > 0)
+        {
+            managobj->EnableBackendPool(backend_pool_size,
+                                        backend_pool_min_memory);
+        }
 
         procsig = new ProcessSignalProducer(GetConnection(),
                                             OpenVPN3DBus_interf_sessions,
@@ -1723,6 +3838,9 @@ public:
 
 private:
     unsigned int manager_log_level = 6; // LogCategory::DEBUG
+    bool subtree_registration = false;
+    unsigned int backend_pool_size = 0;
+    unsigned int backend_pool_min_memory = 0;
     SessionManagerObject::Ptr managobj;
     ProcessSignalProducer * procsig;
     std::string logfile;
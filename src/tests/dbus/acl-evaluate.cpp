@@ -0,0 +1,154 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   acl-evaluate.cpp
+ *
+ * @brief  Simple unit tests of the access decisions made by
+ *         DBusCredentials::EvaluateACL().  The caller is this test
+ *         program itself, identified by its unique bus name on the
+ *         system bus.
+ */
+
+#include <iostream>
+#include <unistd.h>
+
+#include "dbus/core.hpp"
+#include "dbus/connection-creds.hpp"
+
+using namespace openvpn;
+
+typedef DBusCredentials::ACLDecision ACLDecision;
+
+
+static std::string decision_str(ACLDecision d)
+{
+    switch (d)
+    {
+    case ACLDecision::DENY:
+        return "DENY";
+    case ACLDecision::ALLOW:
+        return "ALLOW";
+    case ACLDecision::OWNER:
+        return "OWNER";
+    case ACLDecision::ROOT:
+        return "ROOT";
+    }
+    return "(unknown)";
+}
+
+
+static unsigned int failures = 0;
+
+static void check(const std::string& descr, ACLDecision result,
+                  ACLDecision expect)
+{
+    bool ok = (result == expect);
+    std::cout << "   " << descr << ": " << decision_str(result)
+              << (ok ? "" : " **ERROR** expected " + decision_str(expect))
+              << std::endl;
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    DBus conn(G_BUS_TYPE_SYSTEM);
+    conn.Connect();
+    std::string sender(g_dbus_connection_get_unique_name(conn.GetConnection()));
+    uid_t me = getuid();
+    uid_t other = (0 == me ? 65534 : me + 1);
+    bool root = (0 == me);
+
+    std::cout << ">> Caller " << sender << " is uid " << me << std::endl;
+
+    std::cout << ">> Object owned by the caller" << std::endl;
+    DBusCredentials own(conn.GetConnection(), me);
+    check("ACL check", own.EvaluateACL(sender), ACLDecision::OWNER);
+    check("Owner-only check", own.EvaluateACL(sender, true),
+          ACLDecision::OWNER);
+    check("Owner-only check, root allowed", own.EvaluateACL(sender, true, true),
+          ACLDecision::OWNER);
+
+    std::cout << ">> Object owned by uid " << other << std::endl;
+    DBusCredentials obj(conn.GetConnection(), other);
+    check("ACL check, not granted", obj.EvaluateACL(sender),
+          ACLDecision::DENY);
+    check("ACL check, root allowed", obj.EvaluateACL(sender, false, true),
+          (root ? ACLDecision::ROOT : ACLDecision::DENY));
+
+    obj.GrantAccess(me);
+    check("ACL check, granted", obj.EvaluateACL(sender), ACLDecision::ALLOW);
+    check("Owner-only check, granted", obj.EvaluateACL(sender, true),
+          ACLDecision::DENY);
+    check("Owner-only check, granted, root allowed",
+          obj.EvaluateACL(sender, true, true),
+          (root ? ACLDecision::ROOT : ACLDecision::DENY));
+
+    bool duplicate = false;
+    try
+    {
+        obj.GrantAccess(me);
+    }
+    catch (DBusCredentialsException& excp)
+    {
+        duplicate = true;
+    }
+    std::cout << "   Duplicated grant rejected: "
+              << (duplicate ? "yes" : "**ERROR** no") << std::endl;
+    failures += (duplicate ? 0 : 1);
+
+    obj.RevokeAccess(me);
+    check("ACL check, revoked", obj.EvaluateACL(sender), ACLDecision::DENY);
+
+    bool nogrant = false;
+    try
+    {
+        obj.RevokeAccess(me);
+    }
+    catch (DBusCredentialsException& excp)
+    {
+        nogrant = true;
+    }
+    std::cout << "   Revoking a missing grant rejected: "
+              << (nogrant ? "yes" : "**ERROR** no") << std::endl;
+    failures += (nogrant ? 0 : 1);
+
+    obj.SetPublicAccess(true);
+    check("ACL check, public access", obj.EvaluateACL(sender),
+          ACLDecision::ALLOW);
+    check("Owner-only check, public access", obj.EvaluateACL(sender, true),
+          ACLDecision::DENY);
+
+    obj.SetPublicAccess(false);
+    check("ACL check, public access removed", obj.EvaluateACL(sender),
+          ACLDecision::DENY);
+
+    std::cout << std::endl;
+    if (0 == failures)
+    {
+        std::cout << "** Result: All tests passed" << std::endl;
+        return 0;
+    }
+    std::cout << "** Result: FAIL (" << failures << " failed)" << std::endl;
+    return 1;
+}
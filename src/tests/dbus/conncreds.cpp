@@ -55,5 +55,16 @@ int main(int argc, char **argv)
               << std::endl
               << "   Process ID: " << std::to_string(pid)
               << std::endl;
+
+    // Unique bus names are served from the credentials cache on
+    // the second lookup, which must give the same result
+    if (':' == busname[0])
+    {
+        bool cached = (creds.GetUID(busname) == uid
+                       && creds.GetPID(busname) == pid);
+        std::cout << "  Cached result matches: "
+                  << (cached ? "yes" : "**ERROR** no") << std::endl;
+        return (cached ? 0 : 1);
+    }
     return 0;
 }
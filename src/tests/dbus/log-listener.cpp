@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include "dbus/core.hpp"
+#include "log/dbus-log.hpp"
 #include "common/utils.hpp"
 
 using namespace openvpn;
@@ -78,6 +79,7 @@ int main(int argc, char **argv)
 
     LogSubscription be_subscription(dbus, "Backend", OpenVPN3DBus_interf_backends);
     LogSubscription session_subscr(dbus, "Session", OpenVPN3DBus_interf_sessions);
+    LogListenerRegistration listener(dbus.GetConnection());
 
     std::cout << "Subscribed" << std::endl;
 
@@ -68,6 +68,7 @@ int main(int argc, char **argv)
     Logger be_subscription(dbus.GetConnection(), "[B]", OpenVPN3DBus_interf_backends);
     Logger session_subscr(dbus.GetConnection(), "[S]", OpenVPN3DBus_interf_sessions);
     Logger config_subscr(dbus.GetConnection(), "[C]", OpenVPN3DBus_interf_configuration);
+    LogListenerRegistration listener(dbus.GetConnection());
 
     std::cout << "Subscribed" << std::endl;
 
@@ -58,7 +58,6 @@ sessmgr_interface = dbus.Interface(manager_object,
 # Prepare the tunnel (type casting string to D-Bus objet path variable)
 session_path = sessmgr_interface.NewTunnel(dbus.ObjectPath(sys.argv[1]))
 print("Session path: " + session_path)
-time.sleep(1) # Wait for things to settle down
 
 # Get access to the session object
 session_object = bus.get_object('net.openvpn.v3.sessions', session_path)
@@ -69,6 +68,19 @@ session_interface = dbus.Interface(session_object,
 session_properties = dbus.Interface(session_object,
                                     dbus_interface='org.freedesktop.DBus.Properties')
 
+# The backend process is started in the background.  Until it is ready,
+# the session reports SESSION/PROC_STARTING (3/30) as its status.  A
+# StatusChange signal with SESSION/PROC_STARTED (3/27) is sent once the
+# backend is ready; this example just polls the status property.
+while True:
+    status = session_properties.Get('net.openvpn.v3.sessions','status')
+    if status['major'] != 3 or status['minor'] != 30:
+        break
+    time.sleep(0.2)
+if status['major'] == 3 and status['minor'] == 29:  # StatusMinor::PROC_KILLED
+    print("Failed to start the VPN client backend process")
+    sys.exit(2)
+
 #
 # Start the tunnel
 #
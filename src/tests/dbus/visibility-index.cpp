@@ -0,0 +1,121 @@
+//  OpenVPN 3 Linux client -- Next generation OpenVPN client
+//
+//  Copyright (C) 2018         OpenVPN Inc. <sales@openvpn.net>
+//  Copyright (C) 2018         David Sommerseth <davids@openvpn.net>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU Affero General Public License as
+//  published by the Free Software Foundation, version 3 of the
+//  License.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU Affero General Public License for more details.
+//
+//  You should have received a copy of the GNU Affero General Public License
+//  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+//
+
+/**
+ * @file   visibility-index.cpp
+ *
+ * @brief  Simple unit tests of the DBusVisibilityIndex, checking which
+ *         object paths each user is given when objects are added,
+ *         updated and removed.
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "dbus/visibility-index.hpp"
+
+using namespace openvpn;
+
+
+static unsigned int failures = 0;
+
+static void check(const std::string& descr, DBusVisibilityIndex::Ptr index,
+                  uid_t uid, const std::vector<std::string>& expect)
+{
+    std::vector<std::string> result = index->Lookup(uid);
+    bool ok = (result == expect);
+
+    std::cout << "   " << descr << " [uid " << uid << "]: ";
+    for (const auto& p : result)
+    {
+        std::cout << p << " ";
+    }
+    if (result.empty())
+    {
+        std::cout << "(none) ";
+    }
+    std::cout << (ok ? "" : "**ERROR**") << std::endl;
+    if (!ok)
+    {
+        failures++;
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    const std::string obj_a = "/test/a";
+    const std::string obj_b = "/test/b";
+    const std::string obj_c = "/test/c";
+
+    DBusVisibilityIndex::Ptr index(new DBusVisibilityIndex());
+
+    std::cout << ">> Empty index" << std::endl;
+    check("Nothing visible", index, 1000, {});
+
+    std::cout << ">> Owners only" << std::endl;
+    index->Update(obj_a, 1000, {}, false);
+    index->Update(obj_b, 1001, {}, false);
+    check("Owner of a", index, 1000, {obj_a});
+    check("Owner of b", index, 1001, {obj_b});
+    check("Unrelated user", index, 1002, {});
+
+    std::cout << ">> Access granted" << std::endl;
+    index->Update(obj_b, 1001, {1000, 1002}, false);
+    check("Owner of a, granted b", index, 1000, {obj_a, obj_b});
+    check("Granted b", index, 1002, {obj_b});
+
+    std::cout << ">> Access revoked" << std::endl;
+    index->Update(obj_b, 1001, {1002}, false);
+    check("Owner of a, revoked b", index, 1000, {obj_a});
+    check("Still granted b", index, 1002, {obj_b});
+
+    std::cout << ">> Public access" << std::endl;
+    index->Update(obj_c, 1003, {}, true);
+    check("Owner of a, public c", index, 1000, {obj_a, obj_c});
+    check("Unrelated user, public c", index, 1004, {obj_c});
+    check("Owner of c", index, 1003, {obj_c});
+    index->Update(obj_c, 1003, {}, false);
+    check("Public access removed", index, 1004, {});
+
+    std::cout << ">> Owner changes" << std::endl;
+    index->Update(obj_a, 1005, {}, false);
+    check("Previous owner of a", index, 1000, {});
+    check("New owner of a", index, 1005, {obj_a});
+
+    std::cout << ">> Objects removed" << std::endl;
+    index->Remove(obj_b);
+    check("Owner of removed b", index, 1001, {});
+    check("Granted removed b", index, 1002, {});
+    index->Remove(obj_b);
+    check("Removed twice", index, 1001, {});
+    index->Remove(obj_a);
+    index->Remove(obj_c);
+    check("Index emptied", index, 1005, {});
+
+    std::cout << std::endl;
+    if (0 == failures)
+    {
+        std::cout << "** Result: All tests passed" << std::endl;
+        return 0;
+    }
+    std::cout << "** Result: FAIL (" << failures << " failed)" << std::endl;
+    return 1;
+}